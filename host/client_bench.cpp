@@ -0,0 +1,251 @@
+// smm2-client-bench — latency and CPU cost of following status.bin with
+// host/smm2_client.h, against the polling tools/smm2.py does.
+//
+//   build-host/smm2-client-bench --simulate              synthetic 60 fps writer
+//   build-host/smm2-client-bench --simulate --frames 600 --poll-ms 10
+//
+// --simulate writes a status.bin in a temp directory the way status.cpp
+// publishes it (seq odd, slot, latest + header) and follows it three ways:
+//   reopen    open / read / close every --poll-ms, as tools/smm2.py does
+//   mmap      Client with inotify off, woken every 1 ms
+//   inotify   Client defaults
+// reporting publish → seen latency per block and the reader's CPU time.
+//
+// The input → observation round trip against a running game is
+// smm2-input-bench (host/input_bench.cpp).
+//
+// Exit status: 0 ok, 1 a reader missed blocks, 2 bad usage.
+
+#include "smm2_client.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace smm2;
+
+namespace {
+
+constexpr uint32_t FRAME_US = frame::FRAME_BUDGET_US;
+
+uint64_t thread_cpu_us() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return uint64_t(ts.tv_sec) * 1000000 + uint64_t(ts.tv_nsec) / 1000;
+}
+
+struct Summary {
+    const char* name;
+    size_t seen;
+    size_t expected;
+    double mean_us, p50_us, p99_us, max_us;
+    double cpu_pct;      // reader CPU time / wall time
+};
+
+Summary summarize(const char* name, std::vector<uint64_t> lat, size_t expected,
+                  uint64_t cpu_us, uint64_t wall_us) {
+    Summary s = {name, lat.size(), expected, 0, 0, 0, 0, 0};
+    if (!lat.empty()) {
+        std::sort(lat.begin(), lat.end());
+        uint64_t sum = 0;
+        for (uint64_t v : lat) sum += v;
+        s.mean_us = double(sum) / lat.size();
+        s.p50_us = double(lat[lat.size() / 2]);
+        s.p99_us = double(lat[std::min(lat.size() - 1, lat.size() * 99 / 100)]);
+        s.max_us = double(lat.back());
+    }
+    s.cpu_pct = wall_us ? 100.0 * double(cpu_us) / double(wall_us) : 0;
+    return s;
+}
+
+void print_header() {
+    std::printf("%-10s %10s %10s %10s %10s %10s %8s\n",
+                "reader", "blocks", "mean_us", "p50_us", "p99_us", "max_us", "cpu%");
+}
+
+void print(const Summary& s) {
+    std::printf("%-10s %5zu/%-4zu %10.0f %10.0f %10.0f %10.0f %8.2f\n", s.name, s.seen,
+                s.expected, s.mean_us, s.p50_us, s.p99_us, s.max_us, s.cpu_pct);
+}
+
+// ---- simulated hook ----------------------------------------------------------
+
+// Publishes like status.cpp's publish(); stamps each block just before the
+// write that makes it visible
+struct Writer {
+    int fd = -1;
+    uint32_t frames = 0;
+    std::vector<std::atomic<uint64_t>> published;
+    std::atomic<bool> started{false};
+
+    explicit Writer(uint32_t n) : frames(n), published(n) {}
+
+    bool create(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        std::vector<uint8_t> zero(status::STATUS_FILE_SIZE);
+        status::StatusFileHead head = {};
+        std::memcpy(head.ring.magic, status::RING_MAGIC, sizeof(head.ring.magic));
+        head.ring.version = status::RING_VERSION;
+        head.ring.slot_count = status::RING_SLOTS;
+        head.ring.slot_size = sizeof(status::StatusSlot);
+        head.ring.block_size = sizeof(status::StatusBlock);
+        head.ring.slots_offset = status::RING_SLOTS_OFFSET;
+        head.ring.events_offset = status::EVENTS_OFFSET;
+        std::memcpy(zero.data(), &head, sizeof(head));
+        return pwrite(fd, zero.data(), zero.size(), 0) == ssize_t(zero.size());
+    }
+
+    void run() {
+        status::StatusFileHead head;
+        if (pread(fd, &head, sizeof(head), 0) != ssize_t(sizeof(head))) return;
+        started = true;
+        auto next = std::chrono::steady_clock::now();
+        for (uint32_t idx = 0; idx < frames; idx++) {
+            next += std::chrono::microseconds(FRAME_US);
+            std::this_thread::sleep_until(next);
+
+            head.ring.seq++;
+            pwrite(fd, &head.ring.seq, sizeof(head.ring.seq),
+                   status::RING_HEADER_OFFSET + offsetof(status::StatusRingHeader, seq));
+            status::StatusSlot slot = {};
+            slot.index = idx;
+            slot.blk.frame = idx;
+            pwrite(fd, &slot, sizeof(slot),
+                   status::RING_SLOTS_OFFSET + (idx % status::RING_SLOTS) * sizeof(slot));
+
+            head.latest = slot.blk;
+            head.ring.write_index = idx + 1;
+            head.ring.seq++;
+            published[idx].store(client::now_us(), std::memory_order_release);
+            pwrite(fd, &head, sizeof(head), 0);
+        }
+    }
+};
+
+// Latency of every newly seen block, from blocks' frame numbers
+void record(const Writer& w, const std::vector<status::StatusBlock>& blocks,
+            std::vector<uint64_t>& lat) {
+    uint64_t now = client::now_us();
+    for (const auto& b : blocks) {
+        uint64_t t = b.frame < w.frames ? w.published[b.frame].load(std::memory_order_acquire) : 0;
+        if (t) lat.push_back(now > t ? now - t : 0);
+    }
+}
+
+// tools/smm2.py Game.frames(): reopen and reread the whole file per poll
+Summary follow_reopen(const std::string& path, Writer& w, int poll_ms) {
+    std::vector<uint64_t> lat;
+    std::vector<uint8_t> buf(status::STATUS_FILE_SIZE);
+    std::vector<status::StatusBlock> blocks;
+    uint32_t since = 0;
+    uint64_t cpu0 = thread_cpu_us(), t0 = client::now_us();
+    uint64_t end = t0 + uint64_t(w.frames + 2) * FRAME_US;
+    while (client::now_us() < end && since < w.frames) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        ssize_t n = fd >= 0 ? ::read(fd, buf.data(), buf.size()) : -1;
+        if (fd >= 0) ::close(fd);
+        if (n == ssize_t(buf.size())) {
+            status::StatusRingHeader h;
+            std::memcpy(&h, buf.data() + status::RING_HEADER_OFFSET, sizeof(h));
+            blocks.clear();
+            uint32_t oldest = h.write_index > h.slot_count ? h.write_index - h.slot_count : 0;
+            for (uint32_t idx = std::max(since, oldest); !(h.seq & 1) && idx < h.write_index; idx++) {
+                status::StatusSlot slot;
+                std::memcpy(&slot, buf.data() + h.slots_offset + (idx % h.slot_count) * h.slot_size,
+                            sizeof(slot));
+                if (slot.index != idx) break;
+                blocks.push_back(slot.blk);
+                since = idx + 1;
+            }
+            record(w, blocks, lat);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(poll_ms));
+    }
+    return summarize("reopen", lat, w.frames, thread_cpu_us() - cpu0, client::now_us() - t0);
+}
+
+Summary follow_client(const char* name, const std::string& dir, Writer& w,
+                      const client::Options& opt) {
+    client::StatusReader r;
+    std::vector<uint64_t> lat;
+    std::vector<status::StatusBlock> blocks;
+    if (!r.open(dir, opt)) return summarize(name, lat, w.frames, 0, 0);
+    uint32_t since = 0;
+    uint64_t cpu0 = thread_cpu_us(), t0 = client::now_us();
+    uint64_t end = t0 + uint64_t(w.frames + 2) * FRAME_US;
+    while (since < w.frames) {
+        uint64_t now = client::now_us();
+        if (now >= end) break;
+        if (r.wait_frames(since, blocks, int((end - now) / 1000) + 1)) record(w, blocks, lat);
+    }
+    return summarize(name, lat, w.frames, thread_cpu_us() - cpu0, client::now_us() - t0);
+}
+
+int simulate(uint32_t frames, int poll_ms) {
+    char tmpl[] = "/tmp/smm2-client-bench.XXXXXX";
+    if (!mkdtemp(tmpl)) {
+        std::perror("mkdtemp");
+        return 2;
+    }
+    std::string dir = tmpl, path = dir + "/status.bin";
+
+    client::Options polled;
+    polled.use_inotify = false;
+    polled.backstop_ms = 1;
+
+    std::printf("simulated hook: %u blocks at %.1f fps in %s\n", frames, 1e6 / FRAME_US, dir.c_str());
+    print_header();
+    bool missed = false;
+    for (int mode = 0; mode < 3; mode++) {
+        Writer w(frames);
+        if (!w.create(path)) {
+            std::perror(path.c_str());
+            return 2;
+        }
+        std::thread writer(&Writer::run, &w);
+        while (!w.started) std::this_thread::yield();
+        Summary s = mode == 0 ? follow_reopen(path, w, poll_ms)
+                  : mode == 1 ? follow_client("mmap", dir, w, polled)
+                              : follow_client("inotify", dir, w, {});
+        writer.join();
+        ::close(w.fd);
+        print(s);
+        missed |= s.seen != s.expected;
+    }
+    unlink(path.c_str());
+    rmdir(dir.c_str());
+    return missed ? 1 : 0;
+}
+
+int usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s --simulate [--frames N] [--poll-ms N]\n", argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool sim = false;
+    uint32_t frames = 300;
+    int poll_ms = 10;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "--simulate")                    sim = true;
+        else if (a == "--frames" && i + 1 < argc)  frames = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+        else if (a == "--poll-ms" && i + 1 < argc) poll_ms = std::max(1, std::atoi(argv[++i]));
+        else return usage(argv[0]);
+    }
+    if (!sim || frames == 0) return usage(argv[0]);
+    return simulate(frames, poll_ms);
+}
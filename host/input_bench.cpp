@@ -0,0 +1,139 @@
+// smm2-input-bench — input → observation latency against a running game.
+//
+// Each round trip queues one empty InputCmd (so any held input is
+// released) and follows the status ring until a block echoes its seq:
+//
+//   push       frame of the newest block when the command was written
+//   injected   StatusBlock.input_cmd_frame — the frame the game saw it
+//   observed   frame of the first block carrying the echo
+//
+//   build-host/smm2-input-bench "$EDEN_SD_PATH"               2000 round trips
+//   build-host/smm2-input-bench "$EDEN_SD_PATH" -n 5000 --at 3
+//   build-host/smm2-input-bench "$EDEN_SD_PATH" --instance i2    one of several games
+//
+// --at K targets frame push + K instead of the next poll, and reports how
+// far the injection landed from the target. Lockstep must be off.
+//
+// Exit status: 0 ok, 1 any round trip timed out, 2 bad usage / no game.
+
+#include "smm2_client.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace smm2;
+
+namespace {
+
+constexpr uint32_t HIST_FRAMES = 16;       // last bucket = HIST_FRAMES or more
+constexpr int ROUND_TRIP_TIMEOUT_MS = 2000;
+
+void print_dist(const char* name, std::vector<int64_t> v, const char* unit) {
+    if (v.empty()) return;
+    std::sort(v.begin(), v.end());
+    int64_t sum = 0;
+    for (int64_t x : v) sum += x;
+    auto pct = [&](size_t p) { return v[std::min(v.size() - 1, v.size() * p / 100)]; };
+    std::printf("%-18s %8.2f %8lld %8lld %8lld %8lld %8lld  %s\n", name, double(sum) / v.size(),
+                (long long)v.front(), (long long)pct(50), (long long)pct(90), (long long)pct(99),
+                (long long)v.back(), unit);
+}
+
+void print_hist(const char* name, const std::vector<int64_t>& v) {
+    uint32_t hist[HIST_FRAMES + 1] = {};
+    for (int64_t x : v) hist[std::clamp<int64_t>(x, 0, HIST_FRAMES)]++;
+    std::printf("%s (frames):\n", name);
+    for (uint32_t f = 0; f <= HIST_FRAMES; f++) {
+        if (!hist[f]) continue;
+        std::printf("  %s%-3u %7u  %5.1f%%\n", f == HIST_FRAMES ? ">=" : "  ", f, hist[f],
+                    100.0 * hist[f] / v.size());
+    }
+}
+
+int usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s SD_DIR [-n round_trips] [--at frames] [--instance id]\n", argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* sd = nullptr;
+    std::string instance;
+    uint32_t n = 2000;
+    int at = -1;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "-n" && i + 1 < argc)          n = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+        else if (a == "--at" && i + 1 < argc)   at = std::max(0, std::atoi(argv[++i]));
+        else if (a == "--instance" && i + 1 < argc) instance = argv[++i];
+        else if (!sd && a[0] != '-')            sd = argv[i];
+        else return usage(argv[0]);
+    }
+    if (!sd || n == 0) return usage(argv[0]);
+
+    std::string dir = client::instance_dir(sd, instance);
+    client::Client c;
+    if (!c.open(dir)) {
+        std::fprintf(stderr, "%s: not a directory\n", dir.c_str());
+        return 2;
+    }
+    client::StatusReader& st = c.status();
+    status::StatusBlock b;
+    if (!st.wait_for([](const status::StatusBlock&) { return true; }, 5000, b)) {
+        std::fprintf(stderr, "%s: no status.bin blocks within 5 s — is the game running?\n", dir.c_str());
+        return 2;
+    }
+    std::printf("%u round trips from frame %u (scene_mode %u), %s\n", n, b.frame, b.scene_mode,
+                at < 0 ? "next poll" : "frame-targeted");
+
+    std::vector<int64_t> wall_us, to_inject, to_observe, total, slip;
+    std::vector<status::StatusBlock> blocks;
+    uint32_t timeouts = 0;
+    uint32_t since = st.write_index();
+    uint64_t t_start = client::now_us();
+    for (uint32_t i = 0; i < n; i++) {
+        if (since = st.frames(since, blocks); !blocks.empty()) b = blocks.back();
+        uint32_t push_frame = b.frame;
+        uint32_t target = at < 0 ? tas::CMD_FRAME_NEXT : push_frame + uint32_t(at);
+
+        uint64_t t0 = client::now_us();
+        uint32_t seq = c.push(0, 0, 0, target, ROUND_TRIP_TIMEOUT_MS);
+        const status::StatusBlock* seen = nullptr;
+        uint64_t deadline = t0 + ROUND_TRIP_TIMEOUT_MS * 1000ull;
+        while (seq && !seen) {
+            uint64_t now = client::now_us();
+            if (now >= deadline || !st.wait_frames(since, blocks, int((deadline - now) / 1000) + 1)) break;
+            for (const auto& blk : blocks) {
+                if (blk.input_cmd_seq >= seq) {
+                    seen = &blk;
+                    break;
+                }
+            }
+        }
+        if (!seen) {
+            timeouts++;
+            continue;
+        }
+        wall_us.push_back(int64_t(client::now_us() - t0));
+        to_inject.push_back(int64_t(seen->input_cmd_frame) - push_frame);
+        to_observe.push_back(int64_t(seen->frame) - seen->input_cmd_frame);
+        total.push_back(int64_t(seen->frame) - push_frame);
+        if (at >= 0) slip.push_back(int64_t(seen->input_cmd_frame) - target);
+        b = blocks.back();
+    }
+    double secs = (client::now_us() - t_start) / 1e6;
+
+    std::printf("%-18s %8s %8s %8s %8s %8s %8s\n", "", "mean", "min", "p50", "p90", "p99", "max");
+    print_dist("push→injected", to_inject, "frames");
+    print_dist("injected→observed", to_observe, "frames");
+    print_dist("push→observed", total, "frames");
+    print_dist("target slip", slip, "frames");
+    print_dist("round trip", wall_us, "us");
+    print_hist("push→observed", total);
+    std::printf("%zu of %u round trips in %.2f s, %u timeouts\n", total.size(), n, secs, timeouts);
+    return timeouts ? 1 : 0;
+}
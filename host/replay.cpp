@@ -0,0 +1,317 @@
+// smm2-replay — replay func_trace vectors against the reimplementations in
+// include/smm2/reimpl.h, on the host, across all cores.
+//
+// For every trace.bin record whose delegate has a REIMPL_VERIFY_HOOKS
+// entry: zero a fake PlayerObject, restore the recorded input snapshot
+// into it, call our delegate, then compare the return value and the
+// output snapshot (bit-exact) with what the game produced.
+//
+//   build-host/smm2-replay trace.bin                    summary per delegate
+//   build-host/smm2-replay trace.bin -j 8 --show 20     first 20 mismatches
+//   build-host/smm2-replay trace.bin --func delegate_Walk
+//   build-host/smm2-replay flight_000.bin              a flight recorder dump's trace window
+//
+// Exit status: 0 all vectors match, 1 mismatches, 2 bad input.
+//
+// Only fields in the snapshot are restored; everything else the delegate
+// reads is zero. A vector that depends on other fields shows up as a
+// mismatch — widen PlayerSnapshot rather than special-casing it here.
+
+#include "smm2/flight_recorder.h"
+#include "smm2/func_trace.h"
+#include "smm2/reimpl.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace smm2;
+using func_trace::PlayerSnapshot;
+using func_trace::TraceFuncDesc;
+using func_trace::TraceHeader;
+using func_trace::TraceRecord;
+
+namespace {
+
+// Big enough for every field in the table plus the raw offsets delegates touch
+constexpr size_t PLAYER_OBJECT_SIZE = 0x3000;
+
+constexpr bool fields_fit() {
+    for (const auto& fi : player::Fields::TABLE)
+        if (fi.src_offset + schema::type_size(fi.type) > PLAYER_OBJECT_SIZE) return false;
+    return true;
+}
+static_assert(fields_fit(), "PLAYER_OBJECT_SIZE too small for the field table");
+
+using delegate_t = int (*)(void*);
+
+struct Reimpl {
+    const char* name;
+    delegate_t fn;
+};
+
+const Reimpl REIMPLS[] = {
+#define REIMPL_ENTRY(name, fn) {#name, reimpl::fn},
+    REIMPL_VERIFY_HOOKS(REIMPL_ENTRY)
+#undef REIMPL_ENTRY
+};
+constexpr size_t REIMPL_COUNT = sizeof(REIMPLS) / sizeof(REIMPLS[0]);
+constexpr uint32_t MAX_FUNC_ID = 256;
+
+struct Stats {
+    uint64_t vectors;
+    uint64_t ret_mismatches;
+    uint64_t field_mismatches;   // vectors with at least one differing field
+};
+
+struct Mismatch {
+    uint64_t index;
+    uint32_t reimpl;
+    int32_t ours_ret;
+    PlayerSnapshot ours;
+};
+
+struct Job {
+    const TraceRecord* recs;
+    uint64_t begin, end;
+    const int16_t* func_map;     // func_id → REIMPLS index, -1 = none
+    size_t keep;                 // mismatches to keep for --show
+    Stats stats[REIMPL_COUNT];
+    std::vector<Mismatch> mismatches;
+};
+
+bool field_equal(const PlayerSnapshot& a, const PlayerSnapshot& b, size_t i) {
+    size_t off = PlayerSnapshot::LAYOUT.offset[i];
+    size_t sz = schema::type_size(player::Fields::info(PlayerSnapshot::IDS[i]).type);
+    return std::memcmp(a.data + off, b.data + off, sz) == 0;
+}
+
+void run(Job& job) {
+    std::vector<uint64_t> obj(PLAYER_OBJECT_SIZE / sizeof(uint64_t));
+    auto base = reinterpret_cast<uintptr_t>(obj.data());
+
+    for (uint64_t i = job.begin; i < job.end; i++) {
+        const TraceRecord& rec = job.recs[i];
+        int16_t r = rec.func_id < MAX_FUNC_ID ? job.func_map[rec.func_id] : -1;
+        if (r < 0) continue;
+
+        std::memset(obj.data(), 0, PLAYER_OBJECT_SIZE);
+        rec.in.restore(base);
+        int ret = REIMPLS[r].fn(obj.data());
+        PlayerSnapshot out;
+        out.capture(base);
+
+        Stats& s = job.stats[r];
+        s.vectors++;
+        bool ret_bad = ret != rec.ret;
+        bool fields_bad = std::memcmp(out.data, rec.out.data, PlayerSnapshot::SIZE) != 0;
+        if (fields_bad) {
+            // Padding bytes are zero on both sides, so memcmp is exact; confirm per field
+            fields_bad = false;
+            for (size_t f = 0; f < PlayerSnapshot::COUNT && !fields_bad; f++)
+                fields_bad = !field_equal(out, rec.out, f);
+        }
+        s.ret_mismatches += ret_bad;
+        s.field_mismatches += fields_bad;
+        if ((ret_bad || fields_bad) && job.mismatches.size() < job.keep)
+            job.mismatches.push_back({i, uint32_t(r), ret, out});
+    }
+}
+
+void print_field(const PlayerSnapshot& s, size_t i) {
+    const uint8_t* p = s.data + PlayerSnapshot::LAYOUT.offset[i];
+    switch (player::Fields::info(PlayerSnapshot::IDS[i]).type) {
+    case schema::FieldType::U8:  std::printf("%u", *p); break;
+    case schema::FieldType::U32: { uint32_t v; std::memcpy(&v, p, 4); std::printf("%u", v); break; }
+    case schema::FieldType::I32: { int32_t v; std::memcpy(&v, p, 4); std::printf("%d", v); break; }
+    case schema::FieldType::F32: { float v; std::memcpy(&v, p, 4); std::printf("%.6g", v); break; }
+    case schema::FieldType::U64: { uint64_t v; std::memcpy(&v, p, 8); std::printf("0x%llx", (unsigned long long)v); break; }
+    }
+}
+
+void show(const TraceRecord& rec, const Mismatch& m) {
+    std::printf("#%llu frame=%u %s: ret game=%d ours=%d\n", (unsigned long long)m.index,
+                rec.frame, REIMPLS[m.reimpl].name, rec.ret, m.ours_ret);
+    for (size_t f = 0; f < PlayerSnapshot::COUNT; f++) {
+        if (field_equal(m.ours, rec.out, f)) continue;
+        std::printf("    %-18s in=", player::Fields::info(PlayerSnapshot::IDS[f]).name);
+        print_field(rec.in, f);
+        std::printf(" game=");
+        print_field(rec.out, f);
+        std::printf(" ours=");
+        print_field(m.ours, f);
+        std::printf("\n");
+    }
+}
+
+int usage(const char* argv0) {
+    std::fprintf(stderr, "usage: %s trace.bin|flight_NNN.bin [-j threads] [--func name] [--show N]\n", argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    const char* only = nullptr;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t show_n = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "-j" && i + 1 < argc)          threads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--func" && i + 1 < argc) only = argv[++i];
+        else if (a == "--show" && i + 1 < argc) show_n = std::strtoul(argv[++i], nullptr, 10);
+        else if (!path && a[0] != '-')          path = argv[i];
+        else return usage(argv[0]);
+    }
+    if (!path) return usage(argv[0]);
+
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::perror(path);
+        return 2;
+    }
+    size_t size = size_t(st.st_size);
+    if (size < sizeof(TraceHeader)) {
+        std::fprintf(stderr, "%s: too short for TraceHeader\n", path);
+        return 2;
+    }
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        std::perror("mmap");
+        return 2;
+    }
+    auto bytes = static_cast<const uint8_t*>(map);
+
+    // func_id → reimpl, by delegate name
+    int16_t func_map[MAX_FUNC_ID];
+    std::fill(std::begin(func_map), std::end(func_map), int16_t(-1));
+    size_t matched = 0;
+    auto link = [&](uint32_t id, const char* name) {
+        if (id >= MAX_FUNC_ID || (only && std::strcmp(name, only) != 0)) return;
+        for (size_t r = 0; r < REIMPL_COUNT; r++) {
+            if (std::strcmp(name, REIMPLS[r].name) == 0) {
+                func_map[id] = int16_t(r);
+                matched++;
+            }
+        }
+    };
+
+    const TraceRecord* recs;
+    uint64_t count;
+    if (std::memcmp(bytes, flight_recorder::DUMP_MAGIC, sizeof(flight_recorder::DUMP_MAGIC)) == 0) {
+        // flight_NNN.bin: the trace window follows the StatusBlocks
+        flight_recorder::DumpHeader dh;
+        if (size < sizeof(dh)) {
+            std::fprintf(stderr, "%s: too short for DumpHeader\n", path);
+            return 2;
+        }
+        std::memcpy(&dh, bytes, sizeof(dh));
+        size_t off = dh.header_size + size_t(dh.status_count) * dh.block_size;
+        if (dh.record_size != sizeof(TraceRecord) || off % alignof(TraceRecord) != 0 ||
+            off + uint64_t(dh.trace_count) * sizeof(TraceRecord) > size) {
+            std::fprintf(stderr, "%s: dump layout (v%u, %u B records) differs from this build (%zu B)\n",
+                         path, dh.version, dh.record_size, sizeof(TraceRecord));
+            return 2;
+        }
+        // Dumps carry no descriptor table: ids are this build's delegate slots
+#define LINK_FUNC(name, slot) link(slot, #name);
+        FUNC_TRACE_DELEGATES(LINK_FUNC)
+#undef LINK_FUNC
+        recs = reinterpret_cast<const TraceRecord*>(bytes + off);
+        count = dh.trace_count;
+    } else {
+        TraceHeader hdr;
+        std::memcpy(&hdr, bytes, sizeof(hdr));
+        if (std::memcmp(hdr.magic, func_trace::TRACE_MAGIC, sizeof(hdr.magic)) != 0) {
+            std::fprintf(stderr, "%s: not a trace.bin or flight dump\n", path);
+            return 2;
+        }
+        if (hdr.record_size != sizeof(TraceRecord) || hdr.snapshot_size != sizeof(PlayerSnapshot) ||
+            hdr.in_offset != offsetof(TraceRecord, in) || hdr.out_offset != offsetof(TraceRecord, out)) {
+            std::fprintf(stderr, "%s: record layout (v%u, %u B) differs from this build (%zu B)\n",
+                         path, hdr.version, hdr.record_size, sizeof(TraceRecord));
+            return 2;
+        }
+        if (hdr.header_size > size || hdr.header_size % alignof(TraceRecord) != 0) {
+            std::fprintf(stderr, "%s: bad header_size %u\n", path, hdr.header_size);
+            return 2;
+        }
+        size_t funcs_off = sizeof(TraceHeader) + hdr.field_count * sizeof(func_trace::TraceFieldDesc);
+        for (uint32_t i = 0; i < hdr.func_count; i++) {
+            TraceFuncDesc fd_;
+            std::memcpy(&fd_, bytes + funcs_off + i * sizeof(TraceFuncDesc), sizeof(fd_));
+            fd_.name[sizeof(fd_.name) - 1] = '\0';
+            link(fd_.id, fd_.name);
+        }
+        recs = reinterpret_cast<const TraceRecord*>(bytes + hdr.header_size);
+        count = (size - hdr.header_size) / sizeof(TraceRecord);
+    }
+    if (matched == 0) {
+        std::printf("%llu vectors, none for a reimplemented delegate (%zu in REIMPL_VERIFY_HOOKS)\n",
+                    (unsigned long long)count, REIMPL_COUNT);
+        munmap(map, size);
+        return 0;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    threads = unsigned(std::min<uint64_t>(threads, std::max<uint64_t>(count, 1)));
+    std::vector<Job> jobs(threads);
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) {
+        Job& j = jobs[t];
+        j = {};
+        j.recs = recs;
+        j.begin = count * t / threads;
+        j.end = count * (t + 1) / threads;
+        j.func_map = func_map;
+        j.keep = show_n;
+        pool.emplace_back(run, std::ref(j));
+    }
+    for (auto& th : pool) th.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    Stats total[REIMPL_COUNT] = {};
+    std::vector<Mismatch> mismatches;
+    for (const Job& j : jobs) {
+        for (size_t r = 0; r < REIMPL_COUNT; r++) {
+            total[r].vectors += j.stats[r].vectors;
+            total[r].ret_mismatches += j.stats[r].ret_mismatches;
+            total[r].field_mismatches += j.stats[r].field_mismatches;
+        }
+        mismatches.insert(mismatches.end(), j.mismatches.begin(), j.mismatches.end());
+    }
+    if (mismatches.size() > show_n) mismatches.resize(show_n);   // jobs are in index order
+
+    uint64_t replayed = 0, bad = 0;
+    std::printf("%-36s %12s %12s %12s\n", "delegate", "vectors", "ret_diff", "field_diff");
+    for (size_t r = 0; r < REIMPL_COUNT; r++) {
+        if (total[r].vectors == 0) continue;
+        std::printf("%-36s %12llu %12llu %12llu\n", REIMPLS[r].name,
+                    (unsigned long long)total[r].vectors,
+                    (unsigned long long)total[r].ret_mismatches,
+                    (unsigned long long)total[r].field_mismatches);
+        replayed += total[r].vectors;
+        bad += total[r].ret_mismatches + total[r].field_mismatches;
+    }
+    std::printf("%llu of %llu vectors replayed on %u threads in %.3f s (%.1f M/s)\n",
+                (unsigned long long)replayed, (unsigned long long)count, threads, secs,
+                secs > 0 ? replayed / secs / 1e6 : 0.0);
+
+    for (const Mismatch& m : mismatches) show(recs[m.index], m);
+
+    munmap(map, size);
+    return bad ? 1 : 0;
+}
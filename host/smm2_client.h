@@ -0,0 +1,444 @@
+#pragma once
+
+// smm2_client.h — header-only host client for the status.bin / input_cmd.bin
+// channels, for planners written in C++ (tools/smm2.py is the Python side).
+//
+// The on-disk structs come straight from include/smm2/status.h, events.h
+// and tas.h, so a layout change on the hook side is a compile error or a
+// header mismatch here, never a silent misparse.
+//
+//   smm2::client::Client c;
+//   if (!c.open(sd_dir)) ...
+//   smm2::status::StatusBlock s;
+//   c.status().wait_for([](const auto& b) { return b.scene_mode == 5; }, 10000, s);
+//   uint32_t seq = c.push(smm2::tas::btn::A);
+//   c.wait_applied(seq);
+//
+// status.bin is opened once and mmapped; reads follow the ring's seqlock
+// protocol (status.h), so nothing is reopened or reparsed per poll. Waits
+// block in poll() on an inotify watch of the SD directory and re-check
+// after each write to status.bin. Until inotify has delivered a write for
+// status.bin they also wake every backstop_ms, for filesystems that don't
+// report writes made by another kernel (WSL's /mnt/c, network shares) —
+// there, set use_mmap = false as well so reads go through pread() instead
+// of a mapping that may not see them.
+//
+// status.bin is recreated at boot; waits notice (inotify, or a stat every
+// restat_ms) and remap it. POSIX only. Not thread-safe: one Client per thread.
+//
+// With parallel instances (include/smm2/paths.h) each game's channels are
+// in <sd>/<id>/: c.open(client::instance_dir(sd, "i2")).
+
+#include "smm2/events.h"
+#include "smm2/status.h"
+#include "smm2/tas.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace smm2 {
+namespace client {
+
+struct Options {
+    bool use_mmap = true;        // false: pread() every read
+    bool use_inotify = true;
+    int backstop_ms = 2;         // wake period until inotify has proven itself
+    int live_backstop_ms = 100;  // wake period once it has
+    int restat_ms = 250;         // how often a wait checks status.bin was recreated
+};
+
+// Channel directory of an instance; sd itself for "" (no instance.cfg)
+inline std::string instance_dir(const std::string& sd, const std::string& id) {
+    return id.empty() ? sd : sd + "/" + id;
+}
+
+inline uint64_t now_us() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+class StatusReader {
+public:
+    StatusReader() = default;
+    StatusReader(const StatusReader&) = delete;
+    StatusReader& operator=(const StatusReader&) = delete;
+    ~StatusReader() { close(); }
+
+    // False only if sd_dir can't be watched or read. status.bin itself may
+    // not exist yet (game still booting); waits map it once it appears.
+    bool open(const std::string& sd_dir, const Options& opt = {}) {
+        close();
+        m_opt = opt;
+        m_path = sd_dir + "/status.bin";
+        if (m_opt.use_inotify) {
+            m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            uint32_t mask = IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_DELETE;
+            if (m_inotify >= 0 && inotify_add_watch(m_inotify, sd_dir.c_str(), mask) < 0) {
+                ::close(m_inotify);
+                m_inotify = -1;
+            }
+        }
+        struct stat st;
+        if (stat(sd_dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) return false;
+        map_file();
+        return true;
+    }
+
+    void close() {
+        unmap();
+        if (m_inotify >= 0) ::close(m_inotify);
+        m_inotify = -1;
+        m_inotify_live = false;
+    }
+
+    bool mapped() const { return m_fd >= 0; }
+
+    // Ring header, if status.bin has one with this build's slot layout
+    bool ring(status::StatusRingHeader& h) const {
+        return read(status::RING_HEADER_OFFSET, &h, sizeof(h)) &&
+               std::memcmp(h.magic, status::RING_MAGIC, sizeof(h.magic)) == 0 &&
+               h.slot_size == sizeof(status::StatusSlot) &&
+               h.block_size == sizeof(status::StatusBlock) && h.slot_count != 0;
+    }
+
+    // Newest complete block (from the ring; offset 0 for a legacy file)
+    bool latest(status::StatusBlock& out) const {
+        status::StatusRingHeader h;
+        for (int attempt = 0; attempt < 3; attempt++) {
+            if (!ring(h)) return attempt == 0 && !has_magic() && read(0, &out, sizeof(out));
+            if (h.seq & 1 || h.write_index == 0) continue;
+            status::StatusSlot slot;
+            uint32_t idx = h.write_index - 1;
+            if (read(slot_offset(h, idx), &slot, sizeof(slot)) && slot.index == idx &&
+                seq_unchanged(h.seq)) {
+                out = slot.blk;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Every block published in [since, write_index) that is still in the
+    // ring, oldest first. Returns the index to pass as `since` next time.
+    // since = 0 gives everything still in the ring; a `since` past
+    // write_index (status.bin recreated) starts over from the oldest.
+    uint32_t frames(uint32_t since, std::vector<status::StatusBlock>& out) const {
+        status::StatusRingHeader h;
+        for (int attempt = 0; attempt < 3; attempt++) {
+            out.clear();
+            if (!ring(h)) return since;
+            if (h.seq & 1) continue;
+            uint32_t widx = h.write_index;
+            uint32_t oldest = widx > h.slot_count ? widx - h.slot_count : 0;
+            uint32_t idx = since > widx ? oldest : std::max(since, oldest);
+            status::StatusSlot slot;
+            for (; idx < widx; idx++) {
+                if (!read(slot_offset(h, idx), &slot, sizeof(slot)) || slot.index != idx) break;
+                out.push_back(slot.blk);
+            }
+            if (idx == widx && seq_unchanged(h.seq)) return widx;
+        }
+        out.clear();
+        return since;
+    }
+
+    // Events published in [since, event_index), oldest first; same rules as frames()
+    uint32_t events(uint32_t since, std::vector<events::Event>& out) const {
+        status::StatusRingHeader h;
+        for (int attempt = 0; attempt < 3; attempt++) {
+            out.clear();
+            if (!ring(h) || h.version < 2 || h.events_offset == 0) return since;
+            if (h.seq & 1) continue;
+            uint32_t eidx = h.event_index;
+            uint32_t oldest = eidx > events::EVENT_SLOTS ? eidx - events::EVENT_SLOTS : 0;
+            uint32_t idx = since > eidx ? oldest : std::max(since, oldest);
+            events::Event e;
+            for (; idx < eidx; idx++) {
+                uint32_t off = h.events_offset + (idx % events::EVENT_SLOTS) * sizeof(e);
+                if (!read(off, &e, sizeof(e)) || e.index != idx) break;
+                out.push_back(e);
+            }
+            if (idx == eidx && seq_unchanged(h.seq)) return eidx;
+        }
+        out.clear();
+        return since;
+    }
+
+    // Current write_index / event_index — "from now on" starting points
+    uint32_t write_index() const {
+        status::StatusRingHeader h;
+        return ring(h) ? h.write_index : 0;
+    }
+    uint32_t event_index() const {
+        status::StatusRingHeader h;
+        return ring(h) && h.version >= 2 ? h.event_index : 0;
+    }
+
+    // Block until stop() returns true or timeout_ms passes. stop() is
+    // re-checked after every write to status.bin (and every backstop).
+    template <class Pred>
+    bool wait_until(Pred&& stop, int timeout_ms) {
+        uint64_t now = now_us();
+        uint64_t deadline = now + uint64_t(std::max(timeout_ms, 0)) * 1000;
+        uint64_t next_stat = now + uint64_t(m_opt.restat_ms) * 1000;
+        for (;;) {
+            if (stop()) return true;
+            now = now_us();
+            if (now >= deadline) return false;
+            if (!mapped() || now >= next_stat) {
+                check_replaced();
+                next_stat = now + uint64_t(m_opt.restat_ms) * 1000;
+            }
+            int period = m_inotify_live ? m_opt.live_backstop_ms : m_opt.backstop_ms;
+            int ms = int(std::min<uint64_t>((deadline - now + 999) / 1000, uint64_t(period)));
+            sleep_for_write(std::max(ms, 1));
+        }
+    }
+
+    // Until the newest block satisfies pred. Only the newest block is
+    // tested — use wait_frames() / wait_event() not to miss a transient.
+    template <class Pred>
+    bool wait_for(Pred&& pred, int timeout_ms, status::StatusBlock& out) {
+        return wait_until([&] { return latest(out) && pred(out); }, timeout_ms);
+    }
+
+    // Until at least one block after `since` is published; since advances
+    bool wait_frames(uint32_t& since, std::vector<status::StatusBlock>& out, int timeout_ms) {
+        return wait_until([&] {
+            since = frames(since, out);
+            return !out.empty();
+        }, timeout_ms);
+    }
+
+    // Until an event whose kind is in mask (a set of events::bit()) is
+    // published after `since`; since moves past it (or past all seen)
+    bool wait_event(uint32_t mask, uint32_t& since, events::Event& out, int timeout_ms) {
+        return wait_until([&] {
+            uint32_t next = events(since, m_events);
+            for (const events::Event& e : m_events) {
+                if (mask & events::bit(events::Kind(e.kind))) {
+                    out = e;
+                    since = e.index + 1;
+                    return true;
+                }
+            }
+            since = next;
+            return false;
+        }, timeout_ms);
+    }
+
+private:
+    bool read(uint32_t off, void* dst, size_t len) const {
+        if (m_fd < 0 || off + len > m_size) return false;
+        if (m_map) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::memcpy(dst, m_map + off, len);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+        return pread(m_fd, dst, len, off_t(off)) == ssize_t(len);
+    }
+
+    bool has_magic() const {
+        char magic[4];
+        return read(status::RING_HEADER_OFFSET, magic, sizeof(magic)) &&
+               std::memcmp(magic, status::RING_MAGIC, sizeof(magic)) == 0;
+    }
+
+    bool seq_unchanged(uint32_t seq) const {
+        uint32_t now;
+        return read(status::RING_HEADER_OFFSET + offsetof(status::StatusRingHeader, seq),
+                    &now, sizeof(now)) && now == seq;
+    }
+
+    static uint32_t slot_offset(const status::StatusRingHeader& h, uint32_t idx) {
+        return h.slots_offset + (idx % h.slot_count) * h.slot_size;
+    }
+
+    bool map_file() {
+        unmap();
+        int fd = ::open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(status::StatusBlock)) {
+            ::close(fd);
+            return false;
+        }
+        m_fd = fd;
+        m_ino = st.st_ino;
+        m_size = size_t(st.st_size);
+        if (m_opt.use_mmap) {
+            void* p = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) m_map = static_cast<const uint8_t*>(p);
+        }
+        return true;
+    }
+
+    void unmap() {
+        if (m_map) munmap(const_cast<uint8_t*>(m_map), m_size);
+        if (m_fd >= 0) ::close(m_fd);
+        m_map = nullptr;
+        m_fd = -1;
+        m_size = 0;
+    }
+
+    // status.bin deleted or recreated since it was mapped
+    void check_replaced() {
+        struct stat st;
+        if (stat(m_path.c_str(), &st) != 0) unmap();
+        else if (!mapped() || st.st_ino != m_ino || size_t(st.st_size) != m_size) map_file();
+    }
+
+    void sleep_for_write(int ms) {
+        if (m_inotify < 0) {
+            poll(nullptr, 0, ms);
+            return;
+        }
+        pollfd pfd = {m_inotify, POLLIN, 0};
+        if (poll(&pfd, 1, ms) <= 0) return;
+
+        alignas(inotify_event) char buf[4096];
+        bool replaced = false;
+        ssize_t n;
+        while ((n = ::read(m_inotify, buf, sizeof(buf))) > 0) {
+            for (ssize_t off = 0; off < n;) {
+                auto* ev = reinterpret_cast<const inotify_event*>(buf + off);
+                off += ssize_t(sizeof(inotify_event) + ev->len);
+                if (ev->len == 0 || std::strcmp(ev->name, "status.bin") != 0) continue;
+                if (ev->mask & IN_MODIFY) m_inotify_live = true;
+                else replaced = true;
+            }
+        }
+        if (replaced) check_replaced();
+    }
+
+    Options m_opt;
+    std::string m_path;
+    int m_fd = -1;
+    int m_inotify = -1;
+    bool m_inotify_live = false;
+    ino_t m_ino = 0;
+    size_t m_size = 0;
+    const uint8_t* m_map = nullptr;
+    std::vector<events::Event> m_events;
+};
+
+// status.bin reader plus the input_cmd.bin writer (protocol in tas.h,
+// same as tools/input_cmd.py InputQueue)
+class Client {
+public:
+    Client() = default;
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+    ~Client() { close(); }
+
+    bool open(const std::string& sd_dir, const Options& opt = {}) {
+        close();
+        if (!m_status.open(sd_dir, opt)) return false;
+        m_input_path = sd_dir + "/input_cmd.bin";
+        return open_input();
+    }
+
+    void close() {
+        m_status.close();
+        if (m_input >= 0) ::close(m_input);
+        m_input = -1;
+    }
+
+    StatusReader& status() { return m_status; }
+
+    // Last seq the hook applied (StatusBlock.input_cmd_seq), false if unknown
+    bool applied(uint32_t& seq) const {
+        status::StatusBlock b;
+        if (!m_status.latest(b)) return false;
+        seq = b.input_cmd_seq;
+        return true;
+    }
+
+    // Queue one command — on the next poll, or from `frame` on. Blocks
+    // while CMD_SLOTS commands are unapplied. Returns its seq, 0 on timeout
+    // or a write error.
+    uint32_t push(uint64_t buttons, int32_t lx = 0, int32_t ly = 0,
+                  uint32_t frame = tas::CMD_FRAME_NEXT, int timeout_ms = 2000) {
+        struct stat st;
+        if (m_input < 0 || fstat(m_input, &st) != 0 || st.st_nlink == 0) {
+            if (!open_input()) return 0;   // removed (fresh session)
+        }
+        uint32_t seq = m_write_seq + 1;
+        auto room = [&] {
+            uint32_t done;
+            // No ack available, or the hook resynced — don't block
+            return !applied(done) || done > m_write_seq || seq - done <= tas::CMD_SLOTS;
+        };
+        if (!m_status.wait_until(room, timeout_ms)) return 0;
+
+        tas::InputCmd cmd = {seq, frame, buttons, lx, ly};
+        tas::InputCmdHeader hdr = {};
+        std::memcpy(hdr.magic, tas::CMD_MAGIC, sizeof(hdr.magic));
+        hdr.write_seq = seq;
+        hdr.slot_count = tas::CMD_SLOTS;
+        off_t slot = off_t(sizeof(hdr) + ((seq - 1) % tas::CMD_SLOTS) * sizeof(cmd));
+        if (pwrite(m_input, &cmd, sizeof(cmd), slot) != ssize_t(sizeof(cmd)) ||
+            pwrite(m_input, &hdr, sizeof(hdr), 0) != ssize_t(sizeof(hdr)))
+            return 0;
+        m_write_seq = seq;
+        return seq;
+    }
+
+    // Hold for exactly `frames` polls, then release. Returns the release seq.
+    uint32_t press_frames(uint64_t buttons, uint32_t frames = 1, int32_t lx = 0, int32_t ly = 0) {
+        for (uint32_t i = 0; i < frames; i++)
+            if (!push(buttons, lx, ly)) return 0;
+        return push(0);
+    }
+
+    // Until the hook has applied seq
+    bool wait_applied(uint32_t seq, int timeout_ms = 2000) {
+        return m_status.wait_until([&] {
+            uint32_t done;
+            return applied(done) && done >= seq;
+        }, timeout_ms);
+    }
+
+private:
+    bool open_input() {
+        if (m_input >= 0) ::close(m_input);
+        m_input = ::open(m_input_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (m_input < 0) return false;
+
+        tas::InputCmdHeader hdr;
+        if (pread(m_input, &hdr, sizeof(hdr), 0) == ssize_t(sizeof(hdr)) &&
+            std::memcmp(hdr.magic, tas::CMD_MAGIC, sizeof(hdr.magic)) == 0) {
+            m_write_seq = hdr.write_seq;
+            return true;
+        }
+        std::vector<uint8_t> init(sizeof(hdr) + tas::CMD_SLOTS * sizeof(tas::InputCmd));
+        hdr = {};
+        std::memcpy(hdr.magic, tas::CMD_MAGIC, sizeof(hdr.magic));
+        hdr.slot_count = tas::CMD_SLOTS;
+        std::memcpy(init.data(), &hdr, sizeof(hdr));
+        m_write_seq = 0;
+        return pwrite(m_input, init.data(), init.size(), 0) == ssize_t(init.size());
+    }
+
+    StatusReader m_status;
+    std::string m_input_path;
+    int m_input = -1;
+    uint32_t m_write_seq = 0;
+};
+
+} // namespace client
+} // namespace smm2
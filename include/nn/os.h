@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace nn {
+    struct TimeSpan {
+        int64_t ns;
+
+        static constexpr TimeSpan FromNanoSeconds(int64_t v) { return {v}; }
+        static constexpr TimeSpan FromMicroSeconds(int64_t v) { return {v * 1000}; }
+        static constexpr TimeSpan FromMilliSeconds(int64_t v) { return {v * 1000 * 1000}; }
+    };
+
+    namespace os {
+        // Opaque SDK objects. Sizes are >= the real SDK layouts; we never
+        // touch the fields, only hand pointers back to the SDK.
+        struct MutexType {
+            alignas(8) uint8_t _storage[0x20];
+        };
+
+        struct ConditionVariableType {
+            alignas(8) uint8_t _storage[0x10];
+        };
+
+        struct ThreadType {
+            alignas(16) uint8_t _storage[0x200];
+        };
+
+        using ThreadFunction = void (*)(void* arg);
+
+        // Thread stacks must be page aligned and a multiple of the page size
+        constexpr size_t THREAD_STACK_ALIGN = 0x1000;
+        constexpr int DEFAULT_THREAD_PRIORITY = 16;  // 0 = highest, 31 = lowest
+
+        void InitializeMutex(MutexType* mutex, bool recursive, int lock_level);
+        void LockMutex(MutexType* mutex);
+        void UnlockMutex(MutexType* mutex);
+
+        void InitializeConditionVariable(ConditionVariableType* cv);
+        void SignalConditionVariable(ConditionVariableType* cv);
+        void WaitConditionVariable(ConditionVariableType* cv, MutexType* mutex);
+
+        enum class ConditionVariableStatus {
+            Timeout,
+            NoTimeout,
+        };
+
+        ConditionVariableStatus TimedWaitConditionVariable(ConditionVariableType* cv, MutexType* mutex,
+                                                           TimeSpan timeout);
+
+        uint32_t CreateThread(ThreadType* thread, ThreadFunction fn, void* arg,
+                              void* stack, size_t stack_size, int priority);
+        void StartThread(ThreadType* thread);
+        ThreadType* GetCurrentThread();
+        void SetThreadName(ThreadType* thread, const char* name);
+        void SleepThread(TimeSpan time);
+    }
+}
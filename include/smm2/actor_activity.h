@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+
+namespace smm2 {
+namespace actor_activity {
+
+// Per-frame actor activation profile.
+//
+// Hooks Actor::execute (ActorExecute, the ActorMgr per-actor entry) and
+// times each call. After orig() the actor's flags1324 and collision
+// component say what ActorBaseCalc decided this frame (placeholder_debug.cpp
+// has the full derivation):
+//   active       0x40000 set — inside the camera activation bounds
+//   placeholder  0x20000 set — offscreen, collision registration skipped
+//   collision    not placeholder and actor+1768 (collision component) != 0
+//
+// Actors are grouped by class — the main-relative vtable, since there is
+// no known actor → profile field (actor_registry links StateMachines, not
+// actors). tools/actor_activity.py maps vtables to names with an optional
+// CSV.
+//
+// sd:/smm2-hooks/actor_activity.bin:
+//   ActivityHeader
+//   ActivityRecord...   one Frame record per frame, and every CLASS_INTERVAL
+//                       frames one Class record per class seen in the window
+//
+// bounds_override is set once camera_debug's clamp has actually rewritten
+// the activation bounds (camera_debug::clamping()), so runs with and
+// without it can be compared directly.
+
+constexpr uint32_t MAX_CLASSES = 512;
+constexpr uint32_t CLASS_INTERVAL = 60;
+constexpr uint32_t COLLISION_OFFSET = 1768;    // actor[221]
+constexpr uint32_t FLAGS1324_OFFSET = 1324;
+constexpr uint32_t FLAG_IN_BOUNDS = 0x40000;
+constexpr uint32_t FLAG_PLACEHOLDER = 0x20000;
+
+constexpr char ACTIVITY_MAGIC[4] = {'S', 'M', 'A', 'A'};
+constexpr uint16_t ACTIVITY_VERSION = 1;
+
+enum class RecordKind : uint8_t {
+    Frame,        // totals for one frame; key = distinct classes
+    Class,        // totals for one class over CLASS_INTERVAL frames; key = vtable
+};
+
+struct ActivityHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t tick_hz;
+    uint32_t class_interval;
+};
+
+struct ActivityRecord {
+    uint8_t kind;              // RecordKind
+    uint8_t bounds_override;   // camera_debug::clamping()
+    uint16_t _pad;
+    uint32_t frame;            // Class: last frame of the window
+    uint32_t key;
+    uint32_t calls;
+    uint32_t active;
+    uint32_t placeholder;
+    uint32_t collision;
+    uint32_t calc_us;
+};
+
+static_assert(sizeof(ActivityHeader) == 16, "ActivityHeader size mismatch");
+static_assert(sizeof(ActivityRecord) == 32, "ActivityRecord size mismatch");
+
+void init();                      // hooks ActorExecute
+void per_frame(uint32_t frame);   // emits the frame's record (and class records on interval)
+void flush();
+
+} // namespace actor_activity
+} // namespace smm2
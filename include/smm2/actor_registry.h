@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+
+namespace smm2 {
+namespace actor_registry {
+
+// Live table of every actor StateMachine, and a binary stream of their
+// state changes.
+//
+// SMRegisterState creates (or renews) the entry for its StateMachine. The
+// profile is found by walking the frame-pointer chain for a return address
+// inside a registered profile callback (boot_tables' profile table, so
+// callbacks are known with or without the capture hooks). Actors created
+// outside any callback stay unlinked (profile = NO_PROFILE).
+//
+// StateMachine_changeState appends one 16-byte ActorRecord per change to
+// sd:/smm2-hooks/actor_states.bin through a Shared logger — per-thread
+// rings drained by the writer, no formatting in the hook.
+//
+// Filters: sd:/smm2-hooks/actors.cfg (optional), key=value per line.
+//   include=Kuribo,Nokonoko   only these profiles are streamed (default: all)
+//   exclude=Coin,Block        never these
+//   unlinked=0                drop actors with no profile (default 1)
+// The filter is resolved once per actor when it is linked, so a filtered
+// change costs one table lookup.
+//
+// Host decoder: tools/actor_states.py (names from boot_tables.bin)
+
+constexpr uint32_t MAX_ACTORS = 2048;          // tracked StateMachines
+constexpr uint32_t EVICT_BATCH = MAX_ACTORS / 16;  // least recently active, dropped when full
+constexpr uint32_t MAX_FILTER = 32;            // names per include / exclude list
+constexpr uint32_t MAX_STACK_WALK = 12;        // frames searched for a profile callback
+constexpr uint32_t CALLBACK_SPAN = 0x400;      // return address within this of a callback start
+constexpr uint16_t NO_PROFILE = 0xFFFF;
+
+// ============================================================
+// actor_states.bin
+//
+//   ActorStreamHeader
+//   ActorRecord...   one per spawn / state change, in per-thread order
+// ============================================================
+
+constexpr char ACTOR_MAGIC[4] = {'S', 'M', 'A', 'S'};
+constexpr uint16_t ACTOR_VERSION = 2;     // v2: Evict instead of Reset
+
+enum class RecordKind : uint8_t {
+    Spawn,        // actor linked; old_state = new_state = 0
+    Change,
+    Reset,        // v1 only: table was full and has been cleared
+    Evict,        // table was full; actor = entries dropped, least recently active
+                  // first. A dropped actor that changes state again is re-linked
+                  // unlinked, under a new id
+};
+
+struct ActorStreamHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t game_version;     // boot_tables::GAME_VERSION, for its string ids
+    uint32_t _pad;
+};
+
+struct ActorRecord {
+    uint32_t frame;
+    uint32_t actor;            // instance id, unique per run
+    uint16_t profile;          // boot_tables string id, NO_PROFILE if unlinked
+    uint16_t old_state;
+    uint16_t new_state;
+    uint8_t kind;              // RecordKind
+    uint8_t _pad;
+};
+
+static_assert(sizeof(ActorStreamHeader) == 16, "ActorStreamHeader size mismatch");
+static_assert(sizeof(ActorRecord) == 16, "ActorRecord size mismatch");
+
+void init();                      // reads actors.cfg, hooks registerState / changeState
+void per_frame(uint32_t frame);   // relinks the callback table when profiles change
+void flush();
+
+// Live actors in the table (for status / debugging)
+uint32_t live_count();
+
+} // namespace actor_registry
+} // namespace smm2
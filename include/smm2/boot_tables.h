@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+
+namespace smm2 {
+namespace boot_tables {
+
+// Deduplicated capture of the registration calls the game makes at boot:
+// actor profiles, StateMachine state names and xlink2 enum values.
+//
+// The hooks only intern the name and insert a (table, name, key) entry —
+// every StateMachine instance registers the same states, so most calls
+// are repeats and stop at the hash lookup. Nothing touches the SD card
+// from the hooks.
+//
+// Once no new entry has arrived for SETTLE_MS, the whole table is written
+// to sd:/smm2-hooks/boot_tables.bin (rewritten if new entries turn up
+// later) through an Async logger, a few KB per poll(). poll() runs from
+// the npad poll path (tas's hook — every scene, boot menus included) and
+// from procFrame_, so the capture settles without entering gameplay. If a complete file for GAME_VERSION is already
+// on SD at init, it is read back into the same tables, cached() is true
+// and the plugins don't install their hooks at all; delete the file to
+// capture again. Either way the tables can be queried with count() /
+// copy() / string() (actor_registry links actors to profile names).
+//
+// Host decoder: tools/boot_tables.py (also regenerates the old CSVs)
+
+constexpr uint32_t GAME_VERSION = 303;        // syms/main.sym @game:303
+constexpr uint32_t MAX_STRINGS = 8192;
+constexpr uint32_t POOL_BYTES = 128 * 1024;
+constexpr uint32_t MAX_ENTRIES = 16384;
+constexpr uint32_t SETTLE_MS = 2000;          // ~120 frames
+
+enum class Table : uint8_t {
+    Profiles,     // name = actor, key = behavior index, value = callback (main-relative)
+    States,       // name = state, key = state id, value = 0
+    XlinkEnums,   // name = enum, key = value index, value = string id of the value name
+    COUNT,
+};
+
+constexpr uint32_t NO_STRING = 0xFFFF;
+
+// ============================================================
+// boot_tables.bin
+//
+//   BootHeader
+//   BootTableDesc[table_count]
+//   uint32_t string_offset[string_count]   into the pool
+//   char pool[pool_bytes]                  NUL-terminated, padded to 4
+//   BootEntry[entry_count]                 insertion order, tables interleaved
+// ============================================================
+
+constexpr char BOOT_MAGIC[4] = {'S', 'M', 'B', 'T'};
+constexpr uint16_t BOOT_VERSION = 1;
+
+struct BootHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t table_count;
+    uint32_t game_version;
+    uint32_t string_count;
+    uint32_t pool_bytes;
+    uint32_t entry_count;
+    uint32_t dropped;          // entries or strings that did not fit
+    uint32_t generation;       // dumps this boot
+};
+
+struct BootTableDesc {
+    char name[16];
+    uint32_t count;            // unique entries
+    uint32_t calls;            // registration calls seen (repeats included)
+    uint32_t _pad[2];
+};
+
+struct BootEntry {
+    uint8_t table;             // Table
+    uint8_t _pad;
+    uint16_t name;             // string id
+    uint32_t key;
+    uint32_t value;
+};
+
+static_assert(sizeof(BootHeader) == 32, "BootHeader size mismatch");
+static_assert(sizeof(BootTableDesc) == 32, "BootTableDesc size mismatch");
+static_assert(sizeof(BootEntry) == 12, "BootEntry size mismatch");
+
+void init();      // loads a cached boot_tables.bin; call before the capturing plugins
+bool cached();    // complete boot_tables.bin for GAME_VERSION was loaded
+
+// Returns a stable string id, NO_STRING if the pool is full. Thread-safe.
+uint16_t intern(const char* s);
+
+// First (table, name, key) wins; repeats only bump the call count. Thread-safe.
+void add(Table t, uint16_t name, uint32_t key, uint32_t value);
+
+uint32_t count(Table t);   // unique entries so far
+
+// Copy up to max entries of table t into out; returns the number copied
+uint32_t copy(Table t, BootEntry* out, uint32_t max);
+
+// Interned string by id; "" for NO_STRING or an unknown id
+const char* string(uint16_t id);
+
+// Called from procFrame_ and every input poll — dumps once the tables have
+// settled. Thread-safe: a call that overlaps another returns at once.
+void poll();
+
+} // namespace boot_tables
+} // namespace smm2
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+namespace smm2 {
+namespace camera_debug {
+
+// Camera pointer log (camera_debug.csv) and, from per_frame, a clamp that
+// rewrites the activation / margin bounds of the camera's view
+// sub-objects. per_frame is not registered by default (plugin.cpp), so
+// only the log runs.
+
+void init();
+void per_frame(uint32_t frame);
+
+uintptr_t get_camera();
+
+// True once per_frame has rewritten the bounds of at least one view —
+// i.e. actor activation is running against the clamped bounds
+bool clamping();
+
+} // namespace camera_debug
+} // namespace smm2
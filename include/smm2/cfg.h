@@ -0,0 +1,60 @@
+#pragma once
+
+#include "smm2/paths.h"
+#include "nn/fs.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace smm2 {
+namespace cfg {
+
+// Plugin config files: sd:/smm2-hooks/<name>.cfg (paths::open_read), one
+// key=value per line. Only the first MAX_FILE - 1 bytes are read. Lines
+// are '\n'-terminated with the '\n' cut off; a trailing '\r' stays, and
+// the value parsers (strtoul, for_each_token) stop at it.
+
+constexpr size_t MAX_FILE = 1024;
+
+// Call fn(line) for each line of f, then close it
+template<typename Fn>
+void read(nn::fs::FileHandle f, Fn fn) {
+    char buf[MAX_FILE];
+    size_t bytes_read = 0;
+    nn::fs::ReadFile(&bytes_read, f, 0, buf, sizeof(buf) - 1);
+    nn::fs::CloseFile(f);
+    buf[bytes_read] = '\0';
+
+    char* line = buf;
+    while (*line) {
+        char* eol = std::strchr(line, '\n');
+        if (eol) *eol = '\0';
+        fn(line);
+        if (!eol) break;
+        line = eol + 1;
+    }
+}
+
+// Same for <name> in paths::dir(). False if it doesn't exist.
+template<typename Fn>
+bool read(const char* name, Fn fn) {
+    nn::fs::FileHandle f;
+    if (!paths::open_read(&f, name)) return false;
+    read(f, fn);
+    return true;
+}
+
+// Call fn(token, len) for each comma-separated token in list
+template<typename Fn>
+void for_each_token(const char* list, Fn fn) {
+    while (*list) {
+        const char* end = list;
+        while (*end && *end != ',' && *end != '\r' && *end != ' ') end++;
+        if (end > list) fn(list, size_t(end - list));
+        if (*end != ',') break;
+        list = end + 1;
+    }
+}
+
+} // namespace cfg
+} // namespace smm2
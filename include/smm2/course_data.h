@@ -8,6 +8,7 @@ namespace course_data {
 // Hooks nn::fs::WriteFile to intercept BCD course data saves.
 // When a write to a course_data_XXX.bcd path is detected, captures
 // the buffer pointer and parses BCD header fields (theme, gamestyle, etc.)
+// Decrypted course buffers also rebuild the tile index (smm2/course_map.h).
 void init();
 
 // Returns the last-seen course theme (0-9), or 0xFF if not yet captured.
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace smm2 {
+namespace course_map {
+
+// Tile-level spatial index of the current course, built once per save
+// from the decrypted BCD buffer seen by course_data's WriteFile hook.
+//
+// Per area (0 = main, 1 = sub):
+//   - cells: one CellFlag byte per tile (ground, object footprint, track,
+//     clear pipe), row-major, y = 0 at the bottom
+//   - objects grouped by BLOCK_TILES × BLOCK_TILES block; block_start[b]
+//     indexes the first object of block b, block_start[b + 1] the end
+//
+// cell() is one load; near() walks only the blocks covering the query
+// square, so its cost depends on the radius, not the object count.
+// status publishes both for the player's tile every frame
+// (StatusBlock.near_objects / player_cell).
+//
+// The index is exported to sd:/smm2-hooks/course_map.bin whenever it is
+// rebuilt. Host decoder: tools/course_map.py
+//
+// BCD area tables are taken from tools/gen_level.py (objects at +0x48,
+// ground at +0x247A4); clear pipes and tracks sit at the published table
+// sizes from there and are not yet confirmed on hardware.
+
+constexpr uint32_t AREA_COUNT = 2;
+constexpr uint32_t MAX_W = 256;
+constexpr uint32_t MAX_H = 256;
+constexpr uint32_t MAX_CELLS = 16384;          // w * h cap per area
+constexpr uint32_t BLOCK_TILES = 4;
+constexpr uint32_t MAX_BLOCKS = 1152;          // ceil(w/4) * ceil(h/4) under the caps above
+constexpr uint32_t MAX_OBJECTS = 2600;
+
+constexpr uint32_t TILE_UNITS = 16;            // PlayerObject pos_x/pos_y units per tile
+constexpr uint32_t BCD_TILE = 160;             // BCD object position units per tile
+
+enum CellFlag : uint8_t {
+    CELL_GROUND = 1 << 0,
+    CELL_OBJECT = 1 << 1,   // inside some object's w × h footprint
+    CELL_TRACK  = 1 << 2,
+    CELL_PIPE   = 1 << 3,   // clear pipe node
+};
+
+struct MapObject {
+    uint16_t type;          // BCD object id (tools/parse_course.py ACTOR_NAMES)
+    uint8_t x, y;           // footprint origin tile (bottom-left)
+    uint8_t w, h;           // tiles
+    uint16_t slot;          // index in the BCD object table
+};
+
+static_assert(sizeof(MapObject) == 8, "MapObject size mismatch");
+
+// ============================================================
+// course_map.bin
+//
+//   MapHeader
+//   MapAreaHeader[area_count]
+//   per area, at the offsets in its header:
+//     uint8_t  cells[width * height]        (padded to 4)
+//     uint16_t block_start[blocks + 1]      (padded to 4)
+//     MapObject objects[object_count]       (block order)
+// ============================================================
+
+constexpr char MAP_MAGIC[4] = {'S', 'M', 'C', 'M'};
+constexpr uint16_t MAP_VERSION = 1;
+
+struct MapHeader {
+    char magic[4];            // "SMCM"
+    uint16_t version;
+    uint16_t area_count;
+    uint32_t generation;      // increments with every rebuild
+    uint16_t block_tiles;
+    uint16_t _pad;
+};
+
+struct MapAreaHeader {
+    uint16_t width;           // tiles
+    uint16_t height;
+    uint16_t block_cols;
+    uint16_t block_rows;
+    uint16_t object_count;
+    uint16_t ground_count;
+    uint16_t track_count;
+    uint16_t pipe_node_count;
+    uint8_t theme;
+    uint8_t orientation;      // 0 = horizontal, 1 = vertical
+    uint16_t dropped;         // entries outside the grid caps
+    uint32_t cells_offset;    // file offsets
+    uint32_t blocks_offset;
+    uint32_t objects_offset;
+};
+
+static_assert(sizeof(MapHeader) == 16, "MapHeader size mismatch");
+static_assert(sizeof(MapAreaHeader) == 32, "MapAreaHeader size mismatch");
+
+// Rebuild from a decrypted BCD (header at 0, areas at 0x200) and export.
+// Called from course_data's WriteFile hook.
+void build(const uint8_t* bcd, size_t size);
+
+// 0 until a course has been captured
+uint32_t generation();
+
+// CellFlag bits at tile (tx, ty); 0 outside the grid
+uint8_t cell(uint32_t area, int tx, int ty);
+
+// Objects whose footprint origin lies within radius tiles (square) of
+// (tx, ty). Writes up to max, returns the number written; 0 as well if
+// the map was rebuilt mid-query.
+uint32_t near(uint32_t area, int tx, int ty, uint32_t radius, MapObject* out, uint32_t max);
+
+// PlayerObject position → tile coordinate
+inline int to_tile(float v) {
+    int t = int(v / TILE_UNITS);
+    return v < 0 && float(t) * TILE_UNITS != v ? t - 1 : t;
+}
+
+} // namespace course_map
+} // namespace smm2
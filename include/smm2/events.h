@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+
+namespace smm2 {
+namespace events {
+
+// Scene / phase event bus.
+//
+// status computes every frame's scene_mode, phase and player validity
+// (from procFrame_, or the npad poll fallback while procFrame_ is stalled)
+// and hands them to update(), the one place transitions are detected.
+// Each event is:
+//   - passed to the handlers subscribed to its kind, synchronously
+//   - kept in an EVENT_SLOTS ring that status mirrors into status.bin
+//     (tools/smm2.py Game.events() / wait_event())
+//
+// Handlers run on whichever thread drove status that frame, never two at
+// once. They should be short — they run inside status's frame.
+//
+//   PhaseChange    GamePhaseManager phase     from → to
+//   SceneChange    scene_mode                 from → to
+//   LoadBegin      scene_mode → 0             from = previous scene
+//   LoadEnd        scene_mode 0 → n           to = new scene
+//   PlayerSpawn    player valid in play       to = player state
+//   PlayerDespawn  player gone / stale        from = last player state
+//   Goal           player entered a goal state    from → to state
+//   Death          player entered a death state   from → to state
+
+enum class Kind : uint8_t {
+    PhaseChange,
+    SceneChange,
+    LoadBegin,
+    LoadEnd,
+    PlayerSpawn,
+    PlayerDespawn,
+    Goal,
+    Death,
+    COUNT,
+};
+
+constexpr uint32_t EVENT_SLOTS = 64;
+constexpr uint32_t MAX_SUBSCRIBERS = 16;
+constexpr uint32_t SCENE_LOADING = 0;
+
+struct Event {
+    uint32_t index;            // events published before this one
+    uint32_t frame;
+    uint8_t kind;              // Kind
+    uint8_t _pad[3];
+    int32_t from;
+    int32_t to;
+};
+
+static_assert(sizeof(Event) == 20, "Event size mismatch");
+
+constexpr uint32_t bit(Kind k) { return 1u << uint32_t(k); }
+constexpr uint32_t ALL = (1u << uint32_t(Kind::COUNT)) - 1;
+
+using handler_t = void (*)(const Event& e);
+
+// From a plugin's init(); mask is a set of bit(Kind)
+void subscribe(uint32_t mask, handler_t fn);
+
+struct Inputs {
+    uint32_t frame;
+    int32_t phase;             // -1 if the GamePhaseManager chain is invalid
+    uint32_t scene_mode;
+    uintptr_t player;          // 0 unless a live player is in a play scene
+    uint32_t player_state;
+};
+
+// Called by status once per update
+void update(const Inputs& in);
+
+uint32_t written();                        // events published so far
+bool get(uint32_t index, Event& out);      // false once the slot has been reused
+uint32_t scene_changes();                  // SceneChange events so far
+
+} // namespace events
+} // namespace smm2
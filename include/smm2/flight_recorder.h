@@ -0,0 +1,86 @@
+#pragma once
+
+#include "smm2/status.h"
+#include "smm2/func_trace.h"
+#include <cstdint>
+
+namespace smm2 {
+namespace flight_recorder {
+
+// Flight recorder: keeps the last few seconds of StatusBlocks and
+// func_trace records in fixed in-memory rings (no SD I/O), and dumps
+// the window around a trigger to sd:/smm2-hooks/flight_NNN.bin.
+//
+//   pre_frames before the trigger + post_frames after it are written.
+//   While a dump is being written (a few frames, ~16 KB per frame through
+//   the async writer) recording is paused and new triggers are ignored.
+//
+// Off unless flight.cfg exists (an empty file takes the defaults); the
+// rings are static, so they cost their size either way but are never
+// written to. With the recorder on, func_trace records go only to the
+// trace ring unless stream=1 — smm2-replay reads a dump's trace window.
+//
+// Config: flight.cfg, one key=value per line:
+//   triggers=death,goal,manual
+//   pre=180
+//   post=60
+//   stream=1     also stream trace.bin / trace.csv (default 0)
+//
+// Host decoder: tools/flight_bin.py
+
+constexpr uint32_t TRIGGER_DEATH  = 1 << 0;  // is_dead 0→1 (states 9/10/113/114)
+constexpr uint32_t TRIGGER_GOAL   = 1 << 1;  // is_goal 0→1 (states 122/124)
+constexpr uint32_t TRIGGER_MANUAL = 1 << 2;  // trigger() from code
+
+constexpr uint32_t HISTORY_FRAMES = 512;     // ring capacity — pre + post must fit
+constexpr uint32_t HISTORY_TRACES = 2048;    // ~390 KB of TraceRecords
+
+struct Config {
+    uint32_t triggers;
+    uint32_t pre_frames;
+    uint32_t post_frames;
+    bool stream;              // keep func_trace's trace.bin / trace.csv
+};
+
+constexpr Config DEFAULT_CONFIG = {TRIGGER_DEATH | TRIGGER_GOAL, 240, 60, false};
+
+constexpr char DUMP_MAGIC[4] = {'S', 'M', 'F', 'R'};
+constexpr uint16_t DUMP_VERSION = 1;
+
+// flight_NNN.bin: DumpHeader, StatusBlock[status_count], TraceRecord[trace_count]
+struct DumpHeader {
+    char magic[4];            // "SMFR"
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t reason;          // TRIGGER_* bit that fired
+    uint32_t trigger_frame;   // StatusBlock.frame at the trigger
+    uint32_t status_count;
+    uint32_t trace_count;
+    uint16_t block_size;      // sizeof(StatusBlock)
+    uint16_t record_size;     // sizeof(TraceRecord)
+    uint32_t pre_frames;
+    uint32_t post_frames;
+    uint32_t trace_truncated; // 1 if the trace ring wrapped inside the window
+};
+
+static_assert(sizeof(DumpHeader) == 40, "DumpHeader size mismatch");
+
+void init(const Config& cfg = DEFAULT_CONFIG);
+bool enabled();
+
+// Whether func_trace writes its own log: true when the recorder is off,
+// else flight.cfg's stream=. Fixed after init().
+bool stream_traces();
+
+// Called from status::update() with the block it just built — also drives
+// trigger detection and the incremental dump.
+void record_status(const status::StatusBlock& blk);
+
+// Called from func_trace's delegate hooks
+void record_trace(const func_trace::TraceRecord& rec);
+
+// Fire TRIGGER_MANUAL (if enabled in the config)
+void trigger();
+
+} // namespace flight_recorder
+} // namespace smm2
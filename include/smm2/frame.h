@@ -16,5 +16,73 @@ void init(callback_t cb);
 // Current frame counter
 uint32_t current();
 
+// ============================================================
+// Frame timing, measured by the procFrame_ hook with ticks::now()
+//
+// interval is procFrame_ entry to entry, minus any time the previous
+// frame spent blocked in the lockstep gate. The callback runs inside the
+// frame being measured, so callback_us is the previous frame's.
+//
+// Copied into every StatusBlock (0xA0). The interval/orig/callback
+// histograms (TIMING_BUCKETS × 1 ms, last bucket = overflow) go to
+// sd:/smm2-hooks/frame_time.csv on flush().
+// ============================================================
+
+constexpr uint32_t TIMING_WINDOW = 60;       // frames per peak_interval_us window
+constexpr uint32_t TIMING_BUCKETS = 64;
+constexpr uint32_t FRAME_BUDGET_US = 16667;  // one frame at 60 fps
+
+struct FrameTiming {
+    uint32_t interval_us;       // this frame's inter-frame interval
+    uint32_t orig_us;           // this frame's procFrame_ orig()
+    uint32_t callback_us;       // previous frame's callback (plugins)
+    uint32_t peak_interval_us;  // worst interval in the last full TIMING_WINDOW
+    uint32_t over_1_frame;      // intervals > 16.7 ms since boot
+    uint32_t over_2_frames;     // intervals > 33.3 ms since boot
+    uint32_t last_hitch_frame;  // most recent frame with interval > 33.3 ms
+    uint32_t _pad;
+};
+
+static_assert(sizeof(FrameTiming) == 32, "FrameTiming size mismatch");
+
+const FrameTiming& timing();
+
+// Append the cumulative timing histograms to frame_time.csv
+void flush();
+
+// ============================================================
+// Lockstep frame advance: sd:/smm2-hooks/step.bin (host-written)
+//
+// With enabled != 0, the procFrame_ hook blocks after frame F (after the
+// callback has published F's StatusBlock) for as long as F >= run_until.
+// To advance N frames from a blocked frame F the host writes
+// run_until = F + N and waits for StatusBlock.frame == F + N.
+//
+// While disabled the file is re-checked every STEP_POLL_FRAMES frames;
+// while enabled it is read every frame and every STEP_POLL_US while
+// blocked. timeout_ms != 0 lets a frame through if the host goes quiet
+// for that long, so a crashed planner can't hang the game for good.
+//
+// Host side: tools/lockstep.py
+// ============================================================
+
+constexpr char STEP_MAGIC[4] = {'S', 'M', 'S', 'T'};
+constexpr uint32_t STEP_POLL_FRAMES = 30;
+constexpr uint32_t STEP_POLL_US = 500;
+
+struct StepControl {
+    char magic[4];            // "SMST"
+    uint32_t enabled;
+    uint32_t run_until;       // last frame allowed to complete before blocking
+    uint32_t timeout_ms;      // 0 = block until the host answers
+};
+
+static_assert(sizeof(StepControl) == 16, "StepControl size mismatch");
+
+// True while procFrame_ is blocked in the lockstep gate. Safe from any
+// thread; the npad fallback (status.h) uses it to tell a held frame from
+// a stalled one.
+bool gated();
+
 } // namespace frame
 } // namespace smm2
@@ -16,81 +16,158 @@ namespace func_trace {
 // Host-side test harness reads these vectors and compares against
 // our C++ reimplementation.
 
-// Snapshot of PlayerObject fields relevant to state delegates
-struct PlayerSnapshot {
-    float pos_x, pos_y, pos_z;
-    float vel_x, vel_y;
-    uint32_t cur_state;
-    uint32_t state_frames;
-    uint32_t powerup_id;
-    uint32_t facing;        // 0x26C
-    float target_speed;     // 0x278
-    float gravity;          // 0x27C
-    float friction;         // 0x280
-    float accel;            // 0x284
-    uint8_t in_water;       // 0x4C0
-    uint8_t style_features; // 0x2308
-    uint8_t game_style_flags; // 0x230C
-    uint8_t field_490;      // 0x490
-    uint32_t field_484;     // 0x484
-    uint32_t field_488;     // 0x488
-    int32_t buffered_action; // 0x4BC
-    uint64_t carried_object; // 0x2718
-    uint32_t frame_counter;  // 0x288C
-
-    void capture(uintptr_t p) {
-        pos_x       = player::read<float>(p, player::off::pos_x);
-        pos_y       = player::read<float>(p, player::off::pos_y);
-        pos_z       = player::read<float>(p, 0x238);
-        vel_x       = player::read<float>(p, player::off::vel_x);
-        vel_y       = player::read<float>(p, player::off::vel_y);
-        cur_state   = player::read<uint32_t>(p, player::off::cur_state);
-        state_frames = player::read<uint32_t>(p, player::off::state_frames);
-        powerup_id  = player::read<uint32_t>(p, player::off::powerup_id);
-        facing      = player::read<uint32_t>(p, 0x26C);
-        target_speed = player::read<float>(p, 0x278);
-        gravity     = player::read<float>(p, 0x27C);
-        friction    = player::read<float>(p, 0x280);
-        accel       = player::read<float>(p, 0x284);
-        in_water    = player::read<uint8_t>(p, player::off::in_water);
-        style_features = player::read<uint8_t>(p, 0x2308);
-        game_style_flags = player::read<uint8_t>(p, 0x230C);
-        field_490   = player::read<uint8_t>(p, 0x490);
-        field_484   = player::read<uint32_t>(p, 0x484);
-        field_488   = player::read<uint32_t>(p, 0x488);
-        buffered_action = player::read<int32_t>(p, 0x4BC);
-        carried_object = player::read<uint64_t>(p, 0x2718);
-        frame_counter = player::read<uint32_t>(p, 0x288C);
-    }
-
-    // Write as binary (fixed size, easy to parse on host)
-    void write_bin(uint8_t* out) const {
-        std::memcpy(out, this, sizeof(PlayerSnapshot));
-    }
-
-    // Write as CSV header
-    static void write_csv_header(log::Logger& log) {
-        log.write("pos_x,pos_y,pos_z,vel_x,vel_y,cur_state,state_frames,"
-                  "powerup_id,facing,target_speed,gravity,friction,accel,"
-                  "in_water,style_features,game_style_flags,field_490,"
-                  "field_484,field_488,buffered_action,carried_object,frame_counter",
-                  222);
-    }
-
-    void write_csv(log::Logger& log) const {
-        log.writef("%.4f,%.4f,%.4f,%.4f,%.4f,%u,%u,%u,%u,%.4f,%.4f,%.4f,%.4f,"
-                   "%u,%u,%u,%u,%u,%u,%d,%llu,%u",
-                   pos_x, pos_y, pos_z, vel_x, vel_y, cur_state, state_frames,
-                   powerup_id, facing, target_speed, gravity, friction, accel,
-                   in_water, style_features, game_style_flags, field_490,
-                   field_484, field_488, buffered_action,
-                   (unsigned long long)carried_object, frame_counter);
-    }
-};
+// Snapshot of PlayerObject fields relevant to state delegates.
+// Order = trace.bin v1 layout (0x58 bytes) — append only.
+using PlayerSnapshot = player::Snapshot<
+    player::Field::pos_x, player::Field::pos_y, player::Field::pos_z,
+    player::Field::vel_x, player::Field::vel_y,
+    player::Field::cur_state, player::Field::state_frames, player::Field::powerup_id,
+    player::Field::facing, player::Field::target_speed, player::Field::gravity,
+    player::Field::friction, player::Field::accel,
+    player::Field::in_water, player::Field::style_features,
+    player::Field::game_style_flags, player::Field::field_490,
+    player::Field::field_484, player::Field::field_488, player::Field::buffered_action,
+    player::Field::carried_object, player::Field::frame_counter>;
+
+static_assert(sizeof(PlayerSnapshot) == 0x58, "PlayerSnapshot v1 layout changed");
+static_assert(PlayerSnapshot::LAYOUT.offset[20] == 0x48, "carried_object must stay 8-aligned");
+
+// ============================================================
+// Filtering: sd:/smm2-hooks/func_trace.cfg (optional), key=value per line.
+// Delegate names may drop the "delegate_" prefix; lists are comma-separated.
+//
+//   enable=all | Walk,Turn,...     only these delegates are captured (default: all)
+//   disable=Walk,Landing,...       pass straight through to the original
+//   sample=N                       keep 1 in N captured calls (all delegates)
+//   sample.Walk=N                  per-delegate override
+//   on_change=all | Walk,...       only when ret differs from that delegate's last call
+//   states=1,3,24                  only when in.cur_state is one of these (0-255)
+//   powerups=0,1                   only when in.powerup_id is one of these (0-31)
+//   reload=1                       re-read the file on every flush()
+//
+// A disabled or filtered-out call costs one table lookup — no snapshots.
+// Without reload=1, delegates disabled at init aren't hooked at all.
+// ============================================================
 
 // A single test vector: input snapshot + function args + return value + output snapshot
 // Written as one CSV row: func_id, frame, args..., input_fields..., return_val, output_fields...
 
+// ============================================================
+// Binary trace format (sd:/smm2-hooks/trace.bin)
+//
+//   TraceHeader
+//   TraceFieldDesc[field_count]   — PlayerSnapshot layout
+//   TraceFuncDesc[func_count]     — func_id → delegate name
+//   TraceRecord...                — fixed record_size each
+//
+// Host decoder: tools/trace_bin.py
+// ============================================================
+
+enum class Format : uint8_t {
+    Csv,     // trace.csv, one printf row per call
+    Binary,  // trace.bin, fixed-size TraceRecord per call
+};
+
+constexpr Format FORMAT = Format::Binary;
+
+constexpr char TRACE_MAGIC[4] = {'S', 'M', 'T', 'R'};
+constexpr uint16_t TRACE_VERSION = 1;
+
+using FieldType = schema::FieldType;
+
+struct TraceHeader {
+    char magic[4];           // "SMTR"
+    uint16_t version;
+    uint16_t header_size;    // bytes before the first record (header + tables)
+    uint16_t record_size;    // sizeof(TraceRecord)
+    uint16_t snapshot_size;  // sizeof(PlayerSnapshot)
+    uint16_t in_offset;      // offsetof(TraceRecord, in)
+    uint16_t out_offset;     // offsetof(TraceRecord, out)
+    uint16_t field_count;
+    uint16_t func_count;
+    uint32_t _pad;
+};
+
+using TraceFieldDesc = schema::FieldDesc;   // offset is within PlayerSnapshot
+
+struct TraceFuncDesc {
+    uint16_t id;             // delegate slot number (see syms/main.sym)
+    char name[38];
+};
+
+struct TraceRecord {
+    uint32_t frame;
+    uint16_t func_id;
+    uint16_t _pad;
+    int32_t ret;
+    uint32_t _pad2;
+    PlayerSnapshot in;
+    PlayerSnapshot out;
+};
+
+static_assert(sizeof(TraceHeader) == 24, "TraceHeader size mismatch");
+static_assert(sizeof(TraceFieldDesc) == 28, "TraceFieldDesc size mismatch");
+static_assert(sizeof(TraceFuncDesc) == 40, "TraceFuncDesc size mismatch");
+static_assert(sizeof(TraceRecord) == 16 + 2 * sizeof(PlayerSnapshot), "TraceRecord size mismatch");
+
+// All delegate hooks EXCEPT ≤16B functions (trampoline can't fit)
+// Skipped (≤16B): None, Jump, BroadJump, WallClimb, ClimbRollingAttack, WallHitLand, ObjJumpDai
+// 49 hooks total, pool size 0x80 (128)
+//
+// X(name, slot) — slot is the delegate index from sub_71015E4130 and is
+// used as func_id in trace.bin and flight dumps (which carry no
+// TraceFuncDesc table, so smm2-replay maps them through this list).
+#define FUNC_TRACE_DELEGATES(X)          \
+    X(delegate_Walk, 1)                  \
+    X(delegate_Landing, 4)               \
+    X(delegate_Crouch, 5)                \
+    X(delegate_CrouchEnd, 6)             \
+    X(delegate_CrouchJump, 7)            \
+    X(delegate_CrouchJumpEnd, 8)         \
+    X(delegate_CrouchSwim, 9)            \
+    X(delegate_CrouchSwimEnd, 10)        \
+    X(delegate_CrouchSwimWalk, 12)       \
+    X(delegate_Rolling, 13)              \
+    X(delegate_BroadJumpLand, 15)        \
+    X(delegate_StartFall, 16)            \
+    X(delegate_WorldShortTurn, 17)       \
+    X(delegate_Turn, 18)                 \
+    X(delegate_HipAttack, 19)            \
+    X(delegate_HipAttackEnd, 20)         \
+    X(delegate_Slip, 21)                 \
+    X(delegate_RollSlip, 22)             \
+    X(delegate_WallSlide, 23)            \
+    X(delegate_WallJump, 24)             \
+    X(delegate_WallClimbSlide, 26)       \
+    X(delegate_WallClimbFall, 27)        \
+    X(delegate_WallClimbTopJump, 28)     \
+    X(delegate_WallClimbTopCrouchJump, 29) \
+    X(delegate_ClimbAttack, 30)          \
+    X(delegate_ClimbAttackSwim, 31)      \
+    X(delegate_ClimbJumpAttack, 32)      \
+    X(delegate_ClimbSlidingAttack, 33)   \
+    X(delegate_ClimbBodyAttack, 35)      \
+    X(delegate_ClimbBodyAttackLand, 36)  \
+    X(delegate_WallHit, 37)              \
+    X(delegate_Drag, 39)                 \
+    X(delegate_SideJumpDai, 41)          \
+    X(delegate_PlayerJumpDai, 42)        \
+    X(delegate_Swim, 43)                 \
+    X(delegate_CrouchSwimJump, 44)       \
+    X(delegate_Fire, 45)                 \
+    X(delegate_FireSwim, 46)             \
+    X(delegate_Throw, 47)                \
+    X(delegate_FrogWalk, 48)             \
+    X(delegate_FrogSwim, 49)             \
+    X(delegate_Flying, 51)               \
+    X(delegate_FlyingSlowFall, 52)       \
+    X(delegate_FlyingWallStick, 53)      \
+    X(delegate_LiftUp, 54)               \
+    X(delegate_LiftUpSnowBall, 55)       \
+    X(delegate_LiftUpCloud, 56)          \
+    X(delegate_LiftUpBomb, 57)           \
+    X(delegate_CarryPlayer, 58)
+
 void init();
 void flush();
 
@@ -14,14 +14,15 @@ namespace game_phase {
 // 4 = playing (in-game, physics active)
 // Others TBD — need to capture at title screen, editor, menus, goal animation
 
-// Read the current game phase by following the pointer chain
-// Returns -1 if pointer is null
+// Current game phase from this frame's world::WorldSnapshot
+// Returns -1 if the pointer chain is invalid
 int read_phase();
 
 // Phase constants (confirmed via decomp)
 constexpr int PHASE_PLAYING = 4;
 
-void init();
+void init();   // logs PhaseChange events to game_phase.csv
+void flush();
 
 } // namespace game_phase
 } // namespace smm2
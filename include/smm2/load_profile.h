@@ -0,0 +1,40 @@
+#pragma once
+
+#include "nn/fs.h"
+#include <cstdint>
+
+namespace smm2 {
+namespace load_profile {
+
+// File-access / load-time profiler.
+//
+// OpenFile (forwarded from course_data's hook), ReadFile and CloseFile
+// record per-open stats into memory: path, reads, bytes, and time spent
+// in open / read / close. Nothing touches the SD card from the hooks.
+//
+// File activity after a quiet period opens a load window tagged with the
+// scene_mode it started in. Once there has been no activity for
+// SETTLE_FRAMES, the window is closed with the scene_mode it settled in
+// and dumped DUMP_ROWS_PER_FRAME rows per frame:
+//   sd:/smm2-hooks/loads.csv       one row per window (totals)
+//   sd:/smm2-hooks/load_files.csv  one row per open in that window
+//
+// Our own sd:/smm2-hooks/ files are not tracked.
+// Host summary: tools/load_profile.py
+
+constexpr uint32_t MAX_OPEN = 64;             // files open at once
+constexpr uint32_t MAX_FILES = 1024;          // opens per window
+constexpr uint32_t SETTLE_FRAMES = 60;
+constexpr uint32_t DUMP_ROWS_PER_FRAME = 32;
+constexpr uint32_t PATH_LEN = 80;             // longer paths keep their tail
+
+void init();   // hooks ReadFile / CloseFile
+
+// Called by course_data's OpenFile hook after orig(); ticks = orig() duration
+void on_open(const nn::fs::FileHandle* handle, const char* path, uint32_t rc, uint64_t ticks);
+
+// Called every status update (all scenes) — window tracking and dumping
+void per_frame(uint32_t frame, uint32_t scene_mode);
+
+} // namespace load_profile
+} // namespace smm2
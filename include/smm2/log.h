@@ -1,6 +1,9 @@
 #pragma once
 
+#include "smm2/lz.h"
+#include "smm2/paths.h"
 #include "nn/fs.h"
+#include <atomic>
 #include <cstdint>
 #include <cstdarg>
 #include <cstdio>
@@ -9,30 +12,168 @@
 namespace smm2 {
 namespace log {
 
-// Simple SD card logger. Writes to sd:/smm2-hooks/<filename>
-// Ring buffer in memory, flushes periodically or on demand.
+// Simple SD card logger. Writes to <paths::dir()>/<filename> (sd:/smm2-hooks/,
+// or its instance directory — paths.h)
+// Ring buffer in memory, flushes periodically or on demand. The file is
+// opened once at init and every flush is one WriteFile at a known offset.
+//
+// Three modes:
+//   Sync:  flush() does the WriteFile on the caller's thread.
+//   Async: flush() copies the buffer into the background writer's queue
+//          (src/log.cpp) and returns. The writer thread does the SD I/O.
+//          Falls back to Sync if the writer was never started.
+//   Shared: for loggers written from more than one thread (loader threads,
+//          the npad poll thread). write() pushes the record into the calling
+//          thread's lock-free SPSC ring; the writer thread is the single
+//          consumer that merges all rings into the file. The Logger's own
+//          buffer belongs to the writer thread in this mode.
+//
+// Any logger named in sd:/smm2-hooks/log.cfg is compressed — each buffer
+// becomes one LZ4 block of <name>.lz as it is written out (lz.h):
+//   compress=trace.csv,fields.csv,states.csv     (compress=* for all)
+// Async and Shared loggers compress on the writer thread; Sync ones on the
+// flushing thread, one at a time.
+//
+// Loggers named in segment= write fixed-size segment files instead of one
+// growing file, for bounded SD use on long runs:
+//   segment=trace.csv,fields.csv     (segment=* for all)
+//   segment_kb=4096                  per segment (min 64)
+//   segments=8                       kept on disk (max MAX_SEGMENTS)
+// Segment i is <name>.<i % segments>, preallocated with CreateFile and
+// reused in place once the ring wraps, so steady state does no metadata
+// work at all. Each write() is one record however it is chunked on the way
+// out: if it doesn't fit, the next segment starts before any of it, so
+// records never straddle two. A record that can't fit an empty segment
+// (segment_size less the preamble) is dropped and counted in
+// dropped_records(). Everything written between begin_preamble() and
+// end_preamble() — the CSV header row, or a binary header with its
+// descriptor tables — is replayed at the start of every later segment.
+// Call them around the whole header right after init(). A segmented
+// logger holds one of PREAMBLE_SLOTS PREAMBLE_MAX buffers (no slot left:
+// it writes one growing file). A header too big for it is never
+// truncated: end_preamble() returns false, the manifest says
+// PREAMBLE_OVERFLOW and logz.py refuses to join past segment 0.
+// <name>.seg (SegmentManifest) says which segments are valid and how
+// much of each; it is updated in place after every write. Host side:
+// tools/logz.py open_log() / --join.
+
+constexpr char SEG_MAGIC[4] = {'S', 'M', 'S', 'G'};
+constexpr uint16_t SEG_VERSION = 1;
+constexpr uint32_t MAX_SEGMENTS = 64;
+constexpr uint32_t MIN_SEGMENT_KB = 64;
+constexpr uint32_t DEFAULT_SEGMENT_KB = 4096;
+constexpr uint32_t DEFAULT_SEGMENTS = 8;
+constexpr size_t PREAMBLE_MAX = 4096;        // trace.bin's header + descriptor tables fit
+constexpr uint32_t PREAMBLE_SLOTS = 8;       // segmented loggers at once
+constexpr uint32_t PREAMBLE_OVERFLOW = 0xFFFFFFFF;
+
+struct SegmentManifest {
+    char magic[4];             // "SMSG"
+    uint16_t version;
+    uint16_t segments;         // files in the ring
+    uint32_t segment_size;     // bytes each file is preallocated to
+    uint32_t first;            // oldest segment still on disk
+    uint32_t current;          // segment being written
+    uint32_t current_len;      // valid bytes in current (live)
+    uint32_t preamble_len;     // raw bytes replayed at the start of each segment
+    uint32_t _pad;
+    uint32_t len[MAX_SEGMENTS];  // valid bytes of finished segment i at [i % segments]
+};
+
+static_assert(sizeof(SegmentManifest) == 32 + MAX_SEGMENTS * 4, "SegmentManifest size mismatch");
 
 constexpr size_t BUFFER_SIZE = 8192;
 
+enum class Mode : uint8_t {
+    Sync,
+    Async,
+    Shared,
+};
+
+struct Logger;
+
+// Background writer thread. Call once from hkMain() before plugin init.
+void start_writer();
+bool writer_running();
+
+// Hand a filled buffer to the writer thread. Blocks only if the queue is full.
+// Returns false if the writer is not running (caller must write synchronously).
+// record_len is the size of the record this buffer starts, for the segment
+// rotation decision: len for a flush, the whole write for the first chunk of
+// a split one and 0 for the chunks after it.
+bool submit(Logger* owner, const char* data, size_t len, size_t record_len);
+
+// Shared mode: register a logger with the writer's merge list, push one
+// record into the calling thread's ring, and ask the writer to flush the
+// merged buffer. push_shared never waits on the writer — a full ring drops
+// the record and counts it (dropped_records(), StatusBlock.log_dropped —
+// which also counts records too big for a segment).
+// Threads beyond the per-thread rings share one behind a spinlock.
+// Returns false only if the writer is not running.
+void register_shared(Logger* owner);
+bool push_shared(Logger* owner, const char* data, size_t len);
+void request_flush(Logger* owner);
+uint32_t dropped_records();
+uint32_t preamble_overflows();   // end_preamble() calls that returned false
+
+// Write data at file_pos and advance it — compressed into blocks and/or
+// rotated into the next segment if the logger is configured that way.
+// Sync flush path; the writer thread has its own.
+void append_block(Logger* log, const char* data, size_t len);
+
+// Whether a write() of len fits an empty segment of a segmented logger;
+// counts a dropped record if not
+bool fits_segment(const Logger* log, size_t len);
+
 struct Logger {
-    char path[64];
+    char path[paths::MAX_PATH];  // <name>, or <name>.lz; segments append .<i>
     char buffer[BUFFER_SIZE];
     size_t pos = 0;
-    int64_t file_pos = 0;
+    int64_t file_pos = 0;   // offset in the open file; owned by the writer thread in Async mode
+    nn::fs::FileHandle file = {};
+    nn::fs::FileHandle manifest = {};
+    bool file_open = false;
     bool initialized = false;
+    bool compressed = false;
+    Mode mode = Mode::Sync;
+    std::atomic<bool> flush_requested{false};  // Shared mode only
 
-    void init(const char* filename) {
-        std::snprintf(path, sizeof(path), "sd:/smm2-hooks/%s", filename);
-        // Try delete + recreate for clean start; ignore errors (file may not exist)
-        nn::fs::DeleteFile(path);
-        nn::fs::CreateFile(path, 0);
-        pos = 0;
-        file_pos = 0;
-        initialized = true;
+    // Segmented mode (segment_size != 0)
+    uint32_t segment_size = 0;
+    uint16_t segments = 0;
+    uint32_t seg_first = 0;
+    uint32_t seg_current = 0;
+    char* preamble = nullptr;       // PREAMBLE_MAX bytes from the slot pool
+    bool preamble_capture = false;
+    bool preamble_overflow = false;
+    uint32_t preamble_len = 0;
+
+    // Opens (creates) the file or first segment; see log.cfg above
+    void init(const char* filename, Mode m = Mode::Sync);
+
+    // Capture the header written between these for later segments (no-op
+    // unless segmented). False if it did not fit in PREAMBLE_MAX.
+    void begin_preamble() {
+        preamble_len = 0;
+        preamble_overflow = false;
+        preamble_capture = segment_size != 0;
     }
+    bool end_preamble();
 
     void write(const char* data, size_t len) {
         if (!initialized) return;
+        // Anything below BUFFER_SIZE fits a segment (static_assert in log.cpp)
+        if (len >= BUFFER_SIZE && segment_size && !fits_segment(this, len)) return;
+        if (preamble_capture) {
+            if (preamble_len + len <= PREAMBLE_MAX) {
+                std::memcpy(preamble + preamble_len, data, len);
+                preamble_len += uint32_t(len);
+            } else {
+                preamble_overflow = true;
+                preamble_capture = false;
+            }
+        }
+        if (mode == Mode::Shared && push_shared(this, data, len)) return;
 
         // Flush if buffer would overflow
         if (pos + len >= BUFFER_SIZE) {
@@ -41,14 +182,19 @@ struct Logger {
 
         // If single write exceeds buffer, write directly
         if (len >= BUFFER_SIZE) {
-            nn::fs::FileHandle f;
-            if (nn::fs::OpenFile(&f, path, nn::fs::MODE_WRITE | nn::fs::MODE_APPEND) == 0) {
-                nn::fs::WriteOption opt = {0};
-                nn::fs::WriteFile(f, file_pos, data, len, opt);
-                file_pos += len;
-                nn::fs::FlushFile(f);
-                nn::fs::CloseFile(f);
+            if (mode == Mode::Async && writer_running()) {
+                // Queue slots are BUFFER_SIZE each — split
+                size_t record_len = len;
+                while (len > 0) {
+                    size_t n = len < BUFFER_SIZE ? len : BUFFER_SIZE;
+                    submit(this, data, n, record_len);
+                    record_len = 0;
+                    data += n;
+                    len -= n;
+                }
+                return;
             }
+            append_block(this, data, len);
             return;
         }
 
@@ -62,20 +208,25 @@ struct Logger {
         va_start(args, fmt);
         int n = std::vsnprintf(tmp, sizeof(tmp), fmt, args);
         va_end(args);
+        // vsnprintf returns the untruncated length — never read past tmp
+        if (n >= (int)sizeof(tmp)) n = sizeof(tmp) - 1;
         if (n > 0) write(tmp, n);
     }
 
     void flush() {
-        if (!initialized || pos == 0) return;
-
-        nn::fs::FileHandle f;
-        if (nn::fs::OpenFile(&f, path, nn::fs::MODE_WRITE | nn::fs::MODE_APPEND) == 0) {
-            nn::fs::WriteOption opt = {.flags = nn::fs::WRITE_OPTION_FLUSH};
-            nn::fs::WriteFile(f, file_pos, buffer, pos, opt);
-            file_pos += pos;
-            nn::fs::FlushFile(f);
-            nn::fs::CloseFile(f);
+        if (!initialized) return;
+        if (mode == Mode::Shared && writer_running()) {
+            request_flush(this);
+            return;
         }
+        if (pos == 0) return;
+
+        if (mode == Mode::Async && submit(this, buffer, pos, pos)) {
+            pos = 0;
+            return;
+        }
+
+        append_block(this, buffer, pos);
         pos = 0;
     }
 };
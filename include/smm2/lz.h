@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace smm2 {
+namespace lz {
+
+// LZ4 block codec (compressor only) and the SMLZ container the Logger
+// writes compressed logs in. Greedy single-probe matching over a
+// HASH_SIZE-entry position table — no heap, the caller owns the scratch.
+//
+// <name>.lz, for any Logger enabled in sd:/smm2-hooks/log.cfg:
+//   FileHeader
+//   { BlockHeader, payload }...   one block per Logger buffer flush
+//
+// A block's payload is an LZ4 block (https://github.com/lz4/lz4,
+// doc/lz4_Block_format.md) decoding to raw_len bytes, or — with
+// STORED_RAW set in stored_len — the raw bytes themselves, when the
+// buffer did not compress. Host side: tools/logz.py.
+
+constexpr char LZ_MAGIC[4] = {'S', 'M', 'L', 'Z'};
+constexpr uint16_t LZ_VERSION = 1;
+constexpr uint32_t STORED_RAW = 0x80000000;
+constexpr uint32_t HASH_BITS = 12;
+constexpr uint32_t HASH_SIZE = 1u << HASH_BITS;   // 8 KB of uint16_t positions
+constexpr size_t MAX_BLOCK = 0x10000;             // positions are 16-bit
+
+struct FileHeader {
+    char magic[4];            // "SMLZ"
+    uint16_t version;
+    uint16_t block_max;       // largest raw_len the writer produces
+};
+
+struct BlockHeader {
+    uint32_t raw_len;
+    uint32_t stored_len;      // payload bytes; STORED_RAW set = not compressed
+};
+
+static_assert(sizeof(FileHeader) == 8, "FileHeader size mismatch");
+static_assert(sizeof(BlockHeader) == 8, "BlockHeader size mismatch");
+
+// Worst-case LZ4 output for n input bytes
+constexpr size_t bound(size_t n) { return n + n / 255 + 16; }
+
+// Compress src[0, n) (n <= MAX_BLOCK) into dst. Returns the compressed
+// size, or 0 if it would not be smaller than n or exceed cap — store the
+// block raw then. table must hold HASH_SIZE entries; it is reset here.
+size_t compress(const uint8_t* src, size_t n, uint8_t* dst, size_t cap, uint16_t* table);
+
+} // namespace lz
+} // namespace smm2
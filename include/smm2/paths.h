@@ -0,0 +1,50 @@
+#pragma once
+
+#include "nn/fs.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace smm2 {
+namespace paths {
+
+// Every file the hooks read or write lives under dir(). By default that is
+// ROOT itself; an instance ID moves it to ROOT/<id>/, so several emulators
+// sharing one SD tree never touch each other's channels.
+//
+// sd:/smm2-hooks/instance.cfg (optional, root only), key=value per line:
+//   id=worker3        fixed ID: letters, digits, '-', '_'
+//   id=auto           claim the first free slot i0, i1, ... via ROOT/iN/instance.lock
+//   slots=16          auto: slots to try (default 16, max MAX_SLOTS)
+//
+// An auto claim is CreateFile on instance.lock, which fails if the file
+// exists, so concurrent boots never share a slot. The lock outlives the
+// session — the host releases it (tools/smm2.py release_instance) before
+// relaunching; a boot that finds every slot taken falls back to ROOT.
+//
+// Configs and scripts are read from dir() first, then ROOT, so a farm can
+// share one plugins.cfg / log.cfg and override it per instance.
+
+constexpr const char* ROOT = "sd:/smm2-hooks";
+constexpr size_t MAX_ID = 24;
+constexpr size_t MAX_PATH = 96;     // ROOT, /<id>, /<name>, with room for suffixes
+constexpr uint32_t DEFAULT_SLOTS = 16;
+constexpr uint32_t MAX_SLOTS = 64;
+
+// Mount-time; picks the instance and creates its directory
+void init();
+
+const char* dir();          // ROOT or ROOT/<id>
+const char* id();           // "" without an instance
+
+// out = dir()/name, truncated to cap
+void make(char* out, size_t cap, const char* name);
+
+// Existing name in dir(), else ROOT. False (out = dir()/name) if neither.
+bool find(char* out, size_t cap, const char* name);
+
+// OpenFile(MODE_READ) on find(name)
+bool open_read(nn::fs::FileHandle* f, const char* name);
+
+} // namespace paths
+} // namespace smm2
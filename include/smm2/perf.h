@@ -0,0 +1,165 @@
+#pragma once
+
+#include "smm2/ticks.h"
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace smm2 {
+namespace perf {
+
+// Per-hook overhead profiler. Every trampoline lambda (and the per-frame
+// plugin entry points) opens a PERF_SCOPE; the time between the scope
+// opening and the lambda returning, minus the time spent inside
+// PERF_ORIG(...), is charged to that probe. Totals are inclusive: the
+// frame_proc probe covers all of on_frame, including the plugin probes.
+//
+//   PERF_SCOPE(course_data_open);
+//   return PERF_ORIG(open_hook.orig(handle, path, mode));
+//
+// Hooks that must call orig() before doing anything (status's
+// changeState — see status.cpp) open the scope after it instead.
+//
+// Every PERF_INTERVAL frames perf::per_frame() appends one sample of
+// per-probe deltas to perf.bin. Host decoder: tools/perf_bin.py
+//
+// Adding a probe: one X() line below.
+
+constexpr bool ENABLED = true;
+constexpr uint32_t PERF_INTERVAL = 60;   // frames per sample (~1 s)
+
+// X(name, plugin)
+#define PERF_PROBES(X)                               \
+    X(frame_proc,             frame)                 \
+    X(world_resolve,          world)                 \
+    X(status_update,          status)                \
+    X(status_change_state,    status)                \
+    X(sim_trace_frame,        sim_trace)             \
+    X(func_trace_delegate,    func_trace)            \
+    X(reimpl_verify,          reimpl)                \
+    X(course_data_open,       course_data)           \
+    X(course_data_write,      course_data)           \
+    X(load_profile_read,      load_profile)          \
+    X(load_profile_close,     load_profile)          \
+    X(tas_npad,               tas)                   \
+    X(placeholder_ironball,   placeholder_debug)     \
+    X(actor_profile_register, actor_profile)         \
+    X(actor_profile_state,    actor_profile)         \
+    X(xlink2_ctor,            xlink2_enum)           \
+    X(xlink2_entry,           xlink2_enum)           \
+    X(state_logger_player,    state_logger)          \
+    X(actor_registry_register, actor_registry)       \
+    X(actor_registry_change,  actor_registry)        \
+    X(actor_activity_execute, actor_activity)
+
+enum class Probe : uint16_t {
+#define PERF_PROBE_ID(name, plugin) name,
+    PERF_PROBES(PERF_PROBE_ID)
+#undef PERF_PROBE_ID
+    COUNT,
+};
+
+constexpr uint32_t PROBE_COUNT = uint32_t(Probe::COUNT);
+
+struct Counter {
+    std::atomic<uint32_t> calls;
+    std::atomic<uint64_t> ticks;
+};
+
+extern Counter g_counters[PROBE_COUNT];
+
+class Scope {
+public:
+    explicit Scope(Probe p) : m_probe(p), m_start(ENABLED ? ticks::now() : 0) {}
+
+    ~Scope() {
+        if constexpr (ENABLED) {
+            uint64_t spent = ticks::now() - m_start - m_orig;
+            Counter& c = g_counters[uint32_t(m_probe)];
+            c.calls.fetch_add(1, std::memory_order_relaxed);
+            c.ticks.fetch_add(spent, std::memory_order_relaxed);
+        }
+    }
+
+    // Run f (the original function) off the probe's clock
+    template<typename F>
+    decltype(auto) orig(F&& f) {
+        if constexpr (!ENABLED) {
+            return f();
+        } else if constexpr (std::is_void_v<decltype(f())>) {
+            uint64_t t = ticks::now();
+            f();
+            m_orig += ticks::now() - t;
+        } else {
+            uint64_t t = ticks::now();
+            decltype(auto) r = f();
+            m_orig += ticks::now() - t;
+            return r;
+        }
+    }
+
+    // Take an orig() call the caller timed itself off the probe's clock
+    // (reimpl's verify hooks, whose timed window can't hold the orig wrapper)
+    void exclude(uint64_t ticks) {
+        if constexpr (ENABLED) m_orig += ticks;
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    Probe m_probe;
+    uint64_t m_start;
+    uint64_t m_orig = 0;
+};
+
+#define PERF_SCOPE(probe) ::smm2::perf::Scope _perf_scope(::smm2::perf::Probe::probe)
+#define PERF_ORIG(expr) _perf_scope.orig([&]() -> decltype(auto) { return expr; })
+
+// ============================================================
+// perf.bin
+//
+//   PerfHeader
+//   PerfProbeDesc[probe_count]
+//   samples...: PerfSampleHeader, PerfCounterSample[probe_count]
+//
+// Counter samples are deltas since the previous sample.
+// ============================================================
+
+constexpr char PERF_MAGIC[4] = {'S', 'M', 'P', 'F'};
+constexpr uint16_t PERF_VERSION = 1;
+
+struct PerfHeader {
+    char magic[4];            // "SMPF"
+    uint16_t version;
+    uint16_t probe_count;
+    uint32_t tick_hz;         // cntfrq_el0
+    uint32_t sample_size;     // PerfSampleHeader + probe_count counters
+};
+
+struct PerfProbeDesc {
+    char name[24];
+    char plugin[24];
+};
+
+struct PerfSampleHeader {
+    uint32_t frame;
+    uint32_t frames;          // frames covered by this sample
+};
+
+struct PerfCounterSample {
+    uint32_t calls;
+    uint32_t _pad;
+    uint64_t ticks;           // spent outside orig()
+};
+
+static_assert(sizeof(PerfHeader) == 16, "PerfHeader size mismatch");
+static_assert(sizeof(PerfProbeDesc) == 48, "PerfProbeDesc size mismatch");
+static_assert(sizeof(PerfSampleHeader) == 8, "PerfSampleHeader size mismatch");
+static_assert(sizeof(PerfCounterSample) == 16, "PerfCounterSample size mismatch");
+
+void init();
+void per_frame(uint32_t frame);
+
+} // namespace perf
+} // namespace smm2
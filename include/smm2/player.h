@@ -1,26 +1,76 @@
 #pragma once
 
+#include "smm2/schema.h"
 #include <cstdint>
 
 namespace smm2 {
 namespace player {
 
-// Known PlayerObject field offsets (v3.0.3)
-// All relative to PlayerObject base (this)
+// ============================================================
+// PlayerObject field table (v3.0.3) — the single source of field names,
+// offsets and types. Offsets are relative to PlayerObject base (this).
+// Generates player::off, player::Field, player::get<>() and every
+// schema::Snapshot over PlayerObject (func_trace, sim_trace, status).
+//
+// X(name, FieldType, offset)
+// ============================================================
+#define PLAYER_FIELDS(X)                                                        \
+    X(pos_x,            F32, 0x230)  /* GDB-confirmed: 1220.25 in-level */      \
+    X(pos_y,            F32, 0x234)  /* GDB-confirmed: 64 in-level */           \
+    X(pos_z,            F32, 0x238)                                             \
+    X(vel_x,            F32, 0x274)                                             \
+    X(vel_y,            F32, 0x240)                                             \
+    X(cur_state,        U32, 0x3F8)  /* StateMachine+0x08 */                    \
+    X(state_frames,     U32, 0x3FC)  /* StateMachine+0x0C, frames in state */   \
+    X(powerup_id,       U32, 0x4A8)  /* 0=Small..15=SMB2Mushroom, 8=unused */   \
+    X(facing,           U32, 0x26C)                                             \
+    X(target_speed,     F32, 0x278)                                             \
+    X(gravity,          F32, 0x27C)                                             \
+    X(friction,         F32, 0x280)                                             \
+    X(accel,            F32, 0x284)                                             \
+    X(in_water,         U8,  0x4C0)                                             \
+    X(style_features,   U8,  0x2308)                                            \
+    X(game_style_flags, U8,  0x230C)                                            \
+    X(field_490,        U8,  0x490)                                             \
+    X(field_484,        U32, 0x484)                                             \
+    X(field_488,        U32, 0x488)                                             \
+    X(buffered_action,  I32, 0x4BC)                                             \
+    X(carried_object,   U64, 0x2718)                                            \
+    X(frame_counter,    U32, 0x288C)
+
 namespace off {
-    constexpr uint32_t pos_x       = 0x230;  // float (GDB-confirmed: 1220.25 in-level)
-    constexpr uint32_t pos_y       = 0x234;  // float (GDB-confirmed: 64 in-level)
-    constexpr uint32_t pos_z       = 0x238;  // float
-    constexpr uint32_t vel_y       = 0x240;  // float
-    constexpr uint32_t vel_x       = 0x274;  // float
-    constexpr uint32_t state_machine = 0x3F0; // StateMachine*
-    constexpr uint32_t cur_state   = 0x3F8;  // u32 (StateMachine+0x08)
-    constexpr uint32_t state_frames = 0x3FC; // u32 (StateMachine+0x0C) — frames in current state
-    constexpr uint32_t powerup_id = 0x4A8;     // u32 — powerup/suit enum (0=Small..15=SMB2Mushroom, 8=unused)
-    constexpr uint32_t in_water    = 0x4C0;  // bool
-    constexpr uint32_t style_features = 0x2308; // u32
+#define PLAYER_FIELD_OFFSET(name, type, offset) constexpr uint32_t name = offset;
+    PLAYER_FIELDS(PLAYER_FIELD_OFFSET)
+#undef PLAYER_FIELD_OFFSET
+    constexpr uint32_t state_machine = 0x3F0; // StateMachine* (not a snapshot field)
 }
 
+enum class Field : uint8_t {
+#define PLAYER_FIELD_ID(name, type, offset) name,
+    PLAYER_FIELDS(PLAYER_FIELD_ID)
+#undef PLAYER_FIELD_ID
+    COUNT,
+};
+
+struct Fields {
+    using Id = Field;
+    static constexpr schema::FieldInfo TABLE[] = {
+#define PLAYER_FIELD_INFO(name, type, offset) {#name, offset, schema::FieldType::type},
+        PLAYER_FIELDS(PLAYER_FIELD_INFO)
+#undef PLAYER_FIELD_INFO
+    };
+    static constexpr schema::FieldInfo info(Field f) { return TABLE[size_t(f)]; }
+};
+
+static_assert(sizeof(Fields::TABLE) / sizeof(Fields::TABLE[0]) == size_t(Field::COUNT));
+
+// Snapshot of a subset of PlayerObject fields: Snapshot<Field::pos_x, Field::vel_x>
+template<Field... Fs>
+using Snapshot = schema::Snapshot<Fields, Fs...>;
+
+template<Field F>
+using field_t = typename schema::CType<Fields::info(F).type>::type;
+
 // Game style IDs (from GamePhaseManager inner+0x1C)
 namespace style {
     constexpr uint32_t SMB1  = 0;  // Super Mario Bros.
@@ -62,5 +112,11 @@ inline T read(uintptr_t player_base, uint32_t offset) {
     return *reinterpret_cast<T*>(player_base + offset);
 }
 
+// Typed read of a table field: get<Field::vel_x>(p) → float
+template<Field F>
+inline field_t<F> get(uintptr_t player_base) {
+    return read<field_t<F>>(player_base, Fields::info(F).src_offset);
+}
+
 } // namespace player
 } // namespace smm2
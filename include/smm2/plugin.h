@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+namespace smm2 {
+namespace plugin {
+
+// Plugin registry. hkMain() brings up the framework (log writer, perf,
+// world, frame, flight recorder) and then calls plugin::init(), which
+// initializes only the plugins selected by sd:/smm2-hooks/plugins.cfg —
+// a plugin that isn't selected installs no trampolines at all.
+//
+//   plugins=status,tas             replace the default set
+//   enable=func_trace,reimpl       add to it
+//   disable=camera_debug           remove from it
+//   hooks.course_data=write        install only these hook groups
+//
+// Without the file the default set is the one hkMain() used to hard-code.
+// Tokens are comma-separated; unknown names are ignored. Hook groups are
+// per plugin (see hooks_enabled() calls in each init()); a plugin with no
+// hooks.<name> line installs all of its groups.
+//
+// per_frame and flush run in registry order for active plugins only;
+// flush is called every FLUSH_INTERVAL frames. Active plugins are listed
+// in sd:/smm2-hooks/plugins.csv at init.
+
+constexpr uint32_t FLUSH_INTERVAL = 300;
+constexpr uint32_t MAX_HOOK_RULES = 16;
+
+struct Plugin {
+    const char* name;
+    bool default_on;
+    void (*init)();
+    void (*per_frame)(uint32_t frame);   // nullptr = none
+    void (*flush)();                     // nullptr = none
+};
+
+void init();                      // reads plugins.cfg, inits the selected plugins
+void per_frame(uint32_t frame);   // per_frame of every active plugin, flush on interval
+
+bool active(const char* name);
+
+// For a plugin's init(): whether hook group `group` of plugin `name` is selected
+bool hooks_enabled(const char* name, const char* group);
+
+} // namespace plugin
+} // namespace smm2
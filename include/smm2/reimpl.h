@@ -5,7 +5,8 @@
 // If the game plays correctly → decomp is verified.
 //
 // Two modes:
-//   REIMPL_VERIFY: run both original + ours, log mismatches (safe)
+//   REIMPL_VERIFY: run both original + ours, count mismatches and time
+//                  both paths; summary rows in verify.csv (safe)
 //   REIMPL_REPLACE: fully replace original (live test)
 
 #include "smm2/player.h"
@@ -34,7 +35,20 @@ inline int delegate_None(void* player) {
 // Add more as we decompile them from PlayerObjectStates.cpp
 // Each function here should be a direct C++ translation of the asm
 
+// ============================================================
+// Reimplemented functions
+//
+// X(name, reimpl_func) — name is the delegate symbol. Each entry gets a
+// verify hook and a row in verify.csv (src/reimpl.cpp), and is replayed
+// against trace.bin vectors by the host target (host/replay.cpp).
+// ============================================================
+
+#define REIMPL_VERIFY_HOOKS(X)          \
+    X(delegate_None, delegate_None)     \
+    /* X(delegate_Walk, delegate_Walk) */
+
 void init();
+void flush();   // append one verify.csv summary row per delegate
 
 } // namespace reimpl
 } // namespace smm2
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace smm2 {
+
+// Lock-free single-producer / single-consumer byte ring.
+// SIZE must be a power of two. head/tail are free-running counters;
+// the producer only stores head, the consumer only stores tail.
+//
+// Records are variable-length blobs; callers frame them themselves
+// (e.g. a fixed header carrying the payload length).
+template<size_t SIZE>
+struct ByteRing {
+    static_assert((SIZE & (SIZE - 1)) == 0, "ByteRing size must be a power of two");
+
+    std::atomic<uint32_t> head{0};  // written by producer
+    std::atomic<uint32_t> tail{0};  // written by consumer
+    uint8_t data[SIZE];
+
+    size_t used() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    // Producer: append a+b as one contiguous record. Returns false (and
+    // writes nothing) if there is not enough room — never blocks.
+    bool push(const void* a, size_t a_len, const void* b = nullptr, size_t b_len = 0) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        if (SIZE - (h - t) < a_len + b_len) return false;
+        copy_in(h, a, a_len);
+        if (b_len) copy_in(h + a_len, b, b_len);
+        head.store(h + a_len + b_len, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: copy len bytes starting at the current tail without consuming.
+    // Caller must have checked used() >= len.
+    void peek(void* out, size_t len, size_t skip = 0) const {
+        uint32_t t = tail.load(std::memory_order_relaxed) + skip;
+        size_t off = t & (SIZE - 1);
+        size_t first = SIZE - off < len ? SIZE - off : len;
+        std::memcpy(out, data + off, first);
+        std::memcpy(static_cast<uint8_t*>(out) + first, data, len - first);
+    }
+
+    // Consumer: release len bytes back to the producer.
+    void consume(size_t len) {
+        tail.store(tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+    }
+
+private:
+    void copy_in(uint32_t at, const void* src, size_t len) {
+        size_t off = at & (SIZE - 1);
+        size_t first = SIZE - off < len ? SIZE - off : len;
+        std::memcpy(data + off, src, first);
+        std::memcpy(data, static_cast<const uint8_t*>(src) + first, len - first);
+    }
+};
+
+} // namespace smm2
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace smm2 {
+namespace schema {
+
+// Compile-time field schema shared by every stream that snapshots game
+// objects. A field table (see PLAYER_FIELDS in player.h) gives each field
+// a name, a source offset and a FieldType; Snapshot<Fs...> picks a subset
+// and derives from it, at compile time:
+//   - the packed binary layout (natural alignment, in pack order)
+//   - capture(): one read per selected field, nothing else
+//   - restore(): the inverse, for rebuilding an object on the host
+//   - the CSV header and row
+//   - FieldDesc tables for self-describing binary files
+//
+// Adding a field to a stream is one token in its Snapshot<...> list.
+
+enum class FieldType : uint8_t {
+    U8  = 0,
+    U32 = 1,
+    I32 = 2,
+    F32 = 3,
+    U64 = 4,
+};
+
+template<FieldType T> struct CType;
+template<> struct CType<FieldType::U8>  { using type = uint8_t; };
+template<> struct CType<FieldType::U32> { using type = uint32_t; };
+template<> struct CType<FieldType::I32> { using type = int32_t; };
+template<> struct CType<FieldType::F32> { using type = float; };
+template<> struct CType<FieldType::U64> { using type = uint64_t; };
+
+constexpr uint8_t type_size(FieldType t) {
+    return t == FieldType::U8 ? 1 : t == FieldType::U64 ? 8 : 4;
+}
+
+struct FieldInfo {
+    const char* name;
+    uint32_t src_offset;     // within the source object
+    FieldType type;
+};
+
+// On-disk field descriptor (trace.bin and friends)
+struct FieldDesc {
+    char name[24];
+    uint16_t offset;         // within the snapshot
+    uint8_t type;            // FieldType
+    uint8_t size;
+};
+
+static_assert(sizeof(FieldDesc) == 28, "FieldDesc size mismatch");
+
+// Table: a type with `using Id = <enum>` and `static constexpr FieldInfo info(Id)`
+template<typename Table, typename Table::Id... Fs>
+struct Snapshot {
+    using Id = typename Table::Id;
+
+    static constexpr size_t COUNT = sizeof...(Fs);
+    static constexpr Id IDS[COUNT] = {Fs...};
+
+    struct Layout {
+        uint16_t offset[COUNT];
+        uint16_t size;
+    };
+
+    static constexpr Layout layout() {
+        Layout l = {};
+        size_t off = 0;
+        size_t max_align = 1;
+        for (size_t i = 0; i < COUNT; i++) {
+            size_t sz = type_size(Table::info(IDS[i]).type);
+            off = (off + sz - 1) / sz * sz;
+            l.offset[i] = uint16_t(off);
+            off += sz;
+            if (sz > max_align) max_align = sz;
+        }
+        l.size = uint16_t((off + max_align - 1) / max_align * max_align);
+        return l;
+    }
+
+    static constexpr Layout LAYOUT = layout();
+    static constexpr size_t SIZE = LAYOUT.size;
+
+    template<Id F>
+    static constexpr size_t index_of() {
+        for (size_t i = 0; i < COUNT; i++)
+            if (IDS[i] == F) return i;
+        return COUNT;
+    }
+
+    template<Id F>
+    using field_t = typename CType<Table::info(F).type>::type;
+
+    alignas(8) uint8_t data[SIZE];
+
+    void capture(uintptr_t src) {
+        (copy_in<Fs>(src), ...);
+    }
+
+    void restore(uintptr_t dst) const {
+        (copy_out<Fs>(dst), ...);
+    }
+
+    template<Id F>
+    field_t<F> get() const {
+        static_assert(index_of<F>() < COUNT, "field not in this snapshot");
+        field_t<F> v;
+        std::memcpy(&v, data + LAYOUT.offset[index_of<F>()], sizeof(v));
+        return v;
+    }
+
+    static void describe(FieldDesc* out) {
+        for (size_t i = 0; i < COUNT; i++) {
+            FieldInfo fi = Table::info(IDS[i]);
+            std::memset(out[i].name, 0, sizeof(out[i].name));
+            std::strncpy(out[i].name, fi.name, sizeof(out[i].name) - 1);
+            out[i].offset = LAYOUT.offset[i];
+            out[i].type = uint8_t(fi.type);
+            out[i].size = type_size(fi.type);
+        }
+    }
+
+    // "<prefix>name,<prefix>name,..." without a trailing comma
+    template<typename Log>
+    static void write_csv_header(Log& log, const char* prefix = "") {
+        for (size_t i = 0; i < COUNT; i++) {
+            if (i) log.write(",", 1);
+            log.writef("%s%s", prefix, Table::info(IDS[i]).name);
+        }
+    }
+
+    template<typename Log>
+    void write_csv(Log& log) const {
+        for (size_t i = 0; i < COUNT; i++) {
+            if (i) log.write(",", 1);
+            const uint8_t* p = data + LAYOUT.offset[i];
+            switch (Table::info(IDS[i]).type) {
+            case FieldType::U8:  log.writef("%u", *p); break;
+            case FieldType::U32: log.writef("%u", load<uint32_t>(p)); break;
+            case FieldType::I32: log.writef("%d", load<int32_t>(p)); break;
+            case FieldType::F32: log.writef("%.4f", load<float>(p)); break;
+            case FieldType::U64: log.writef("%llu", (unsigned long long)load<uint64_t>(p)); break;
+            }
+        }
+    }
+
+private:
+    template<typename T>
+    static T load(const uint8_t* p) {
+        T v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    template<Id F>
+    void copy_in(uintptr_t src) {
+        constexpr FieldInfo fi = Table::info(F);
+        std::memcpy(data + LAYOUT.offset[index_of<F>()],
+                    reinterpret_cast<const void*>(src + fi.src_offset), type_size(fi.type));
+    }
+
+    template<Id F>
+    void copy_out(uintptr_t dst) const {
+        constexpr FieldInfo fi = Table::info(F);
+        std::memcpy(reinterpret_cast<void*>(dst + fi.src_offset),
+                    data + LAYOUT.offset[index_of<F>()], type_size(fi.type));
+    }
+};
+
+} // namespace schema
+} // namespace smm2
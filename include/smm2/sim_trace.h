@@ -5,6 +5,56 @@
 namespace smm2 {
 namespace sim_trace {
 
+// Full-rate player physics stream for fitting tools/physics.py.
+// Writes sd:/smm2-hooks/sim.bin — every frame the player is live,
+// stored as columns, each column delta + zigzag + varint encoded.
+//
+// File layout:
+//   SimHeader
+//   SimColumnDesc[column_count]
+//   chunks...: SimChunkHeader, then column_count encoded columns back to back
+//
+// Each chunk holds up to CHUNK_FRAMES frames. Deltas restart from 0 at
+// every chunk so chunks decode independently. Floats are delta-coded on
+// their IEEE bit pattern (as int32), so an unchanged value costs 1 byte.
+//
+// Host decoder: tools/sim_bin.py
+
+constexpr char SIM_MAGIC[4] = {'S', 'M', 'S', 'M'};
+constexpr char CHUNK_MAGIC[4] = {'S', 'M', 'C', 'K'};
+constexpr uint16_t SIM_VERSION = 1;
+constexpr uint32_t CHUNK_FRAMES = 256;
+
+enum class ColumnType : uint8_t {
+    U32 = 1,
+    I32 = 2,
+    F32 = 3,
+};
+
+struct SimHeader {
+    char magic[4];            // "SMSM"
+    uint16_t version;
+    uint16_t column_count;
+    uint32_t chunk_frames;    // max frames per chunk
+    uint32_t _pad;
+};
+
+struct SimColumnDesc {
+    char name[15];
+    uint8_t type;             // ColumnType
+};
+
+struct SimChunkHeader {
+    char magic[4];            // "SMCK"
+    uint32_t frame_count;
+    uint32_t payload_size;    // bytes of encoded columns after this header
+    uint32_t _pad;
+};
+
+static_assert(sizeof(SimHeader) == 16, "SimHeader size mismatch");
+static_assert(sizeof(SimColumnDesc) == 16, "SimColumnDesc size mismatch");
+static_assert(sizeof(SimChunkHeader) == 16, "SimChunkHeader size mismatch");
+
 void init();
 void per_frame(uint32_t frame);
 void flush();
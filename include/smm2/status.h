@@ -1,5 +1,9 @@
 #pragma once
 
+#include "smm2/events.h"
+#include "smm2/frame.h"
+
+#include <cstddef>
 #include <cstdint>
 
 namespace smm2 {
@@ -7,8 +11,10 @@ namespace status {
 
 // Game status written to sd:/smm2-hooks/status.bin every frame.
 // Host-side tools poll this for instant game state awareness.
+// The latest block sits at offset 0; a seqlock ring of the last
+// RING_SLOTS blocks follows it (see StatusRingHeader below).
 //
-// Layout (64 bytes):
+// Layout (first 64 bytes; the full block is 200):
 //   [0x00] uint32_t frame
 //   [0x04] uint32_t game_phase     (0=unknown, 4=playing — from GamePhaseManager)
 //   [0x08] uint32_t player_state   (from PlayerObject+0x3F8)
@@ -54,8 +60,12 @@ struct StatusBlock {
     uint32_t is_playing;        // 0x48: inner+0x10: 0=editor, 1=playing/title
     // GPM inner dump for research
     uint32_t gpm_inner[6];      // 0x4C: inner struct offsets 0x00-0x14 (24 bytes)
-    // Debug: wearable/equipment detection (note: 4-byte padding before player_ptr for alignment)
-    uint64_t player_ptr;        // 0x68: raw PlayerObject* for GDB (after 4-byte padding)
+    // Course tile index around the player (course_map.h, main area); 0 until a course is captured
+    uint16_t near_objects;      // 0x64: objects within NEAR_RADIUS tiles, capped at NEAR_MAX
+    uint8_t  player_cell;       // 0x66: course_map::CellFlag bits of the player's tile
+    uint8_t  _pad4;
+    // Debug: wearable/equipment detection
+    uint64_t player_ptr;        // 0x68: raw PlayerObject* for GDB
     uint64_t carried_obj;       // 0x70: PlayerObject+0x2718
     uint64_t carried_obj_2;     // 0x78: PlayerObject+0x2A30
     uint32_t debug_field_1;     // 0x80: PlayerObject+0x22E4 (powerup_flags)
@@ -67,18 +77,101 @@ struct StatusBlock {
     uint8_t  collision_normal;   // 0x94: from normal array at +0x1B30
     uint8_t  _coll_pad[3];       // 0x95-0x97
     int32_t  collision_slope;    // 0x98: slope angle from normal+0x08
-    uint32_t _pad3;              // 0x9C: padding for alignment
+    uint32_t input_cmd_seq;      // 0x9C: last input_cmd.bin seq injected into a poll (tas::input_cmd_seq)
+    frame::FrameTiming timing;   // 0xA0: procFrame_ interval/orig/callback times (frame::timing)
+    uint32_t input_cmd_frame;    // 0xC0: frame::current() when input_cmd_seq was injected
+    uint32_t log_dropped;        // 0xC4: log records dropped since boot (log::dropped_records)
 };
 
-static_assert(sizeof(StatusBlock) == 160, "StatusBlock size mismatch");
+static_assert(sizeof(StatusBlock) == 200, "StatusBlock size mismatch");
+static_assert(offsetof(StatusBlock, timing) == 0xA0, "StatusBlock timing offset mismatch");
+static_assert(offsetof(StatusBlock, player_ptr) == 0x68, "StatusBlock player_ptr offset mismatch");
+
+constexpr uint32_t NEAR_RADIUS = 4;    // tiles, square — one query covers at most 3 × 3 blocks
+constexpr uint32_t NEAR_MAX = 32;
 
 // static_assert to be updated after size is confirmed
 
+// ============================================================
+// status.bin file layout
+//
+//   [0x000] StatusBlock      latest block (legacy readers use only this)
+//   [0x0C8] StatusRingHeader seqlock header
+//   [0x0E8] StatusSlot[RING_SLOTS]
+//   [events_offset] events::Event[EVENT_SLOTS]   (ring version 2+)
+//
+// Writer, per frame (handle stays open):
+//   1. seq++ (odd)              — 4-byte write into the header
+//   2. slot[write_index % N]    — one slot write
+//   3. event slots published since the last frame, if any (see events.h)
+//   4. latest + header, seq++ (even), write_index++ — one 232-byte write
+//
+// Event slots are read the same way: [max(last, event_index - EVENT_SLOTS),
+// event_index), each slot's index field checked against the one expected.
+//
+// Reader: read the file, note seq (retry if odd), take slots
+// [max(last, write_index - N), write_index), then re-read the header.
+// If seq changed the oldest slot may be torn — retry or drop it.
+// See tools/smm2.py Game.frames().
+// ============================================================
+
+constexpr char RING_MAGIC[4] = {'S', 'M', 'S', 'R'};
+constexpr uint16_t RING_VERSION = 3;   // 3: StatusBlock grew to 200 bytes
+constexpr uint16_t RING_SLOTS = 64;  // ~1 s at 60 fps
+
+struct StatusRingHeader {
+    char magic[4];           // "SMSR"
+    uint32_t seq;            // seqlock: odd while a slot is being written
+    uint32_t write_index;    // blocks published; newest is slot[(write_index - 1) % slot_count]
+    uint16_t version;
+    uint16_t slot_count;
+    uint16_t slot_size;      // sizeof(StatusSlot)
+    uint16_t block_size;     // sizeof(StatusBlock)
+    uint32_t slots_offset;   // file offset of slot[0]
+    uint32_t event_index;    // events published; newest is event[(event_index - 1) % EVENT_SLOTS]
+    uint32_t events_offset;  // file offset of event[0]
+};
+
+struct StatusSlot {
+    uint32_t index;          // write_index value this block was published as
+    uint32_t _pad;
+    StatusBlock blk;
+};
+
+struct StatusFileHead {
+    StatusBlock latest;
+    StatusRingHeader ring;
+};
+
+static_assert(sizeof(StatusRingHeader) == 32, "StatusRingHeader size mismatch");
+static_assert(sizeof(StatusSlot) == 208, "StatusSlot size mismatch");
+static_assert(sizeof(StatusFileHead) == 0xE8, "StatusFileHead size mismatch");
+
+constexpr uint32_t RING_HEADER_OFFSET = sizeof(StatusBlock);
+constexpr uint32_t RING_SLOTS_OFFSET = sizeof(StatusFileHead);
+constexpr uint32_t EVENTS_OFFSET = RING_SLOTS_OFFSET + RING_SLOTS * sizeof(StatusSlot);
+constexpr uint32_t STATUS_FILE_SIZE = EVENTS_OFFSET + events::EVENT_SLOTS * sizeof(events::Event);
+
 void init();
 void update(uint32_t frame);
-void update_from_input_poll();  // fallback: called from NpadStates hook, fires in ALL scenes
+void update_from_input_poll();  // fallback: called from NpadStates hook, fires in ALL scenes unless frame::gated()
 void set_player(uintptr_t player);
-void set_mode(uint8_t mode);  // 0=editor, 1=playing
+uintptr_t player();  // current PlayerObject*, 0 outside play scenes or when stale
+void set_mode(uint8_t mode);  // 0=editor, 1=playing, 2=goal, 3=dead — normally set from events
+
+// The state checks behind StatusBlock.is_dead / is_goal
+bool is_death_state(uint32_t state);
+bool is_goal_state(uint32_t state);
+
+// scene_mode values (StatusBlock.scene_mode, world::WorldSnapshot)
+constexpr uint32_t SCENE_EDITOR = 1;
+constexpr uint32_t SCENE_TEST_PLAY = 5;   // editor test-play
+constexpr uint32_t SCENE_COURSEBOT = 7;   // coursebot play
+
+// A scene with a live player — the only ones whose player data is trusted
+constexpr bool is_play_scene(uint32_t scene_mode) {
+    return scene_mode == SCENE_TEST_PLAY || scene_mode == SCENE_COURSEBOT;
+}
 
 } // namespace status
 } // namespace smm2
@@ -6,8 +6,10 @@ namespace smm2 {
 namespace tas {
 
 // TAS (Tool-Assisted Script) playback via nn::hid hook.
-// Reads a script file from sd:/smm2-hooks/tas.csv
-// Format: frame,buttons,stick_lx,stick_ly
+// Streams a binary keyframe script from sd:/smm2-hooks/tas.bin
+// (convert from CSV on the host with tools/tas_bin.py).
+//
+// CSV source format: frame,buttons,stick_lx,stick_ly
 //
 // buttons is a bitmask (hex or decimal):
 //   A=0x01, B=0x02, X=0x04, Y=0x08,
@@ -28,6 +30,148 @@ namespace tas {
 //   100,0x4001,0,0
 //   120,0x4000,0,0
 //   300,0,0,0
+//
+// tas.bin layout: TasHeader, then TasKeyframe[keyframe_count] sorted by
+// frame. Only a WINDOW_KEYFRAMES window is resident; it is refilled in
+// REFILL_KEYFRAMES reads as playback advances, so script length is
+// unbounded and memory is constant. keyframe_count TAS_COUNT_STREAMED
+// means "to the end of the file" (recordings, written as they go).
+//
+// Scripts OR their buttons into the controller's and override non-zero
+// sticks. With TAS_FLAG_EXACT the keyframe state replaces the left stick
+// and buttons outright, so the game sees exactly what was recorded.
+//
+// Record mode: sd:/smm2-hooks/tas.cfg (optional), key=value per line:
+//   record=1          record every take, alongside any mode
+// A take runs from a live player appearing in a play scene until the
+// scene changes, into the first free rec_NNN.bin. It holds the
+// post-injection buttons and left stick the game got from GetNpadStates,
+// run-length encoded at frame resolution: a keyframe only when the state
+// changes, the last poll of a frame winning. Frames are relative to the
+// spawn, as batch scripts are, and the file is TAS_FLAG_EXACT — list it
+// in batch.txt to replay and recheck it (recording the replay too gives a
+// second take to compare). Host tool: tools/tas_bin.py (CSV, --diff).
+
+constexpr char TAS_MAGIC[4] = {'S', 'M', 'T', 'S'};
+constexpr uint16_t TAS_VERSION = 1;
+constexpr uint32_t WINDOW_KEYFRAMES = 256;   // resident ring, 4 KB
+constexpr uint32_t REFILL_KEYFRAMES = 128;   // one ReadFile per refill, 2 KB
+constexpr uint32_t TAS_COUNT_STREAMED = 0xFFFFFFFF;
+constexpr uint32_t TAS_FLAG_EXACT = 1;
+constexpr uint32_t REC_FLUSH_FRAMES = 300;   // a take is flushed this often
+constexpr uint32_t REC_MAX_TAKES = 1000;     // rec_000.bin .. rec_999.bin
+
+struct TasHeader {
+    char magic[4];            // "SMTS"
+    uint16_t version;
+    uint16_t keyframe_size;   // sizeof(TasKeyframe)
+    uint32_t keyframe_count;  // or TAS_COUNT_STREAMED
+    uint32_t flags;           // TAS_FLAG_*
+};
+
+struct TasKeyframe {
+    uint32_t frame;
+    int16_t stick_lx;
+    int16_t stick_ly;
+    uint64_t buttons;
+};
+
+static_assert(sizeof(TasHeader) == 16, "TasHeader size mismatch");
+static_assert(sizeof(TasKeyframe) == 16, "TasKeyframe size mismatch");
+static_assert(WINDOW_KEYFRAMES % REFILL_KEYFRAMES == 0, "refills must not wrap the window");
+
+// ============================================================
+// Live input command ring: sd:/smm2-hooks/input_cmd.bin
+//
+// Written by the host (tools/input_cmd.py), read by the hook. The host
+// appends an InputCmd to slot (seq - 1) % CMD_SLOTS, then bumps
+// InputCmdHeader.write_seq to seq. The hook reads the 16-byte header on
+// each input poll and only reads slots when write_seq has moved. Each
+// command is applied exactly once, in seq order:
+//   frame == CMD_FRAME_NEXT → on the next poll (one such command per poll,
+//                             so a queued press/release pair is never merged)
+//   otherwise               → on the first poll with frame::current() >= frame
+// The state it sets is held until the next command.
+//
+// The last seq injected into a poll's output (a poll that returned at
+// least one state) is echoed in StatusBlock.input_cmd_seq, and the frame
+// it was injected on in input_cmd_frame — the game sees it that frame.
+// The host must keep write_seq - input_cmd_seq < CMD_SLOTS. A write_seq
+// lower than the hook's position (host restarted the file) resyncs to it.
+// host/input_bench.cpp measures the round trip.
+// ============================================================
+
+constexpr char CMD_MAGIC[4] = {'S', 'M', 'I', 'C'};
+constexpr uint32_t CMD_SLOTS = 64;
+constexpr uint32_t CMD_FRAME_NEXT = 0xFFFFFFFF;
+
+struct InputCmdHeader {
+    char magic[4];            // "SMIC"
+    uint32_t write_seq;       // seq of the newest complete command (0 = none)
+    uint32_t slot_count;      // CMD_SLOTS
+    uint32_t _pad;
+};
+
+struct InputCmd {
+    uint32_t seq;             // must equal the expected seq, else not written yet
+    uint32_t frame;           // target frame, or CMD_FRAME_NEXT
+    uint64_t buttons;
+    int32_t stick_lx;
+    int32_t stick_ly;
+};
+
+static_assert(sizeof(InputCmdHeader) == 16, "InputCmdHeader size mismatch");
+static_assert(sizeof(InputCmd) == 24, "InputCmd size mismatch");
+
+// ============================================================
+// Batch mode: sd:/smm2-hooks/batch.txt
+//
+// One run per line: "<script.bin> [timeout_frames]" ('#' comments allowed;
+// names are relative to sd:/smm2-hooks/). Scripts use the tas.bin format
+// with keyframe frames relative to the player spawning. For each run the
+// plugin waits for a live player in a play scene, plays the script, stops
+// on goal / death (status::is_goal_state / is_death_state) / timeout
+// (counted in input polls — one per frame in play — so it still fires if
+// the game leaves play and procFrame_ stops),
+// appends a BatchResult to batch_results.bin, then returns to the editor
+// and long-presses MINUS to restart the course from the start.
+//
+// batch_results.bin: BatchResultsHeader, then BatchResult per run.
+// Host tool: tools/batch.py
+// ============================================================
+
+constexpr char BATCH_MAGIC[4] = {'S', 'M', 'B', 'R'};
+constexpr uint16_t BATCH_VERSION = 1;
+constexpr uint32_t BATCH_DEFAULT_TIMEOUT = 3600;   // polls (60 s)
+
+enum class Outcome : uint32_t {
+    Goal = 1,
+    Death = 2,
+    Timeout = 3,
+    Aborted = 4,       // left the play scene on its own
+    ScriptError = 5,   // script missing or bad header — run skipped
+};
+
+struct BatchResultsHeader {
+    char magic[4];            // "SMBR"
+    uint16_t version;
+    uint16_t record_size;     // sizeof(BatchResult)
+    uint32_t _pad[2];
+};
+
+struct BatchResult {
+    uint32_t run_index;       // manifest line number (0-based, counting every line)
+    uint32_t outcome;         // Outcome
+    uint32_t frames;          // frames from spawn to the end condition
+    uint32_t end_state;       // player state at the end
+    float end_x;
+    float end_y;
+    uint32_t keyframes;       // keyframes applied
+    uint32_t start_frame;     // frame::current() at spawn
+};
+
+static_assert(sizeof(BatchResultsHeader) == 16, "BatchResultsHeader size mismatch");
+static_assert(sizeof(BatchResult) == 32, "BatchResult size mismatch");
 
 // Button constants matching nn::hid
 namespace btn {
@@ -49,8 +193,18 @@ namespace btn {
     constexpr uint64_t DOWN    = 0x8000;
 }
 
+// Final controller state the game saw on the last poll (after injection)
+struct InputState {
+    uint64_t buttons;
+    int32_t stick_lx;
+    int32_t stick_ly;
+};
+
 void init();
 uint32_t input_poll_count();
+uint32_t input_cmd_seq();     // seq of the last InputCmd injected into a poll
+uint32_t input_cmd_frame();   // frame::current() when it was injected
+InputState last_input();
 
 } // namespace tas
 } // namespace smm2
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+namespace smm2 {
+namespace ticks {
+
+// ARM generic timer (cntvct_el0): the system counter, 19.2 MHz on Switch —
+// ~52 ns per tick, not CPU cycles. Cheap enough (one mrs) to bracket single
+// delegate calls; short calls read 0-1 ticks, so aggregate over many calls.
+//
+// The isb keeps the read from being hoisted above the code being timed.
+
+inline uint64_t now() {
+#if defined(__aarch64__)
+    uint64_t v;
+    asm volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(v) :: "memory");
+    return v;
+#else
+    return 0;
+#endif
+}
+
+inline uint64_t frequency() {
+#if defined(__aarch64__)
+    uint64_t v;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(v));
+    return v;
+#else
+    return 19200000;
+#endif
+}
+
+inline uint64_t to_ns(uint64_t t) {
+    uint64_t f = frequency();
+    return t / f * 1000000000ull + t % f * 1000000000ull / f;
+}
+
+// Microseconds, saturating — for 32-bit duration fields
+inline uint32_t to_us(uint64_t t) {
+    uint64_t us = to_ns(t) / 1000;
+    return us > UINT32_MAX ? UINT32_MAX : uint32_t(us);
+}
+
+} // namespace ticks
+} // namespace smm2
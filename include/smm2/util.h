@@ -0,0 +1,34 @@
+#pragma once
+
+#include "nn/fs.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace smm2 {
+
+// Spinlock over an atomic_flag, for critical sections of a few loads and
+// stores — a table probe, a ring push. Never hold one across SD I/O.
+struct SpinGuard {
+    explicit SpinGuard(std::atomic_flag& lock) : lock(lock) {
+        while (lock.test_and_set(std::memory_order_acquire)) {}
+    }
+    ~SpinGuard() { lock.clear(std::memory_order_release); }
+    SpinGuard(const SpinGuard&) = delete;
+    SpinGuard& operator=(const SpinGuard&) = delete;
+
+    std::atomic_flag& lock;
+};
+
+constexpr uint32_t align4(uint32_t v) {
+    return (v + 3) & ~3u;
+}
+
+// Sequential writes of an export file (course_map.bin):
+// WriteFile at off, no flush, and advance off
+inline void write_at(nn::fs::FileHandle f, uint32_t& off, const void* data, uint32_t len) {
+    nn::fs::WriteFile(f, off, data, len, {0});
+    off += len;
+}
+
+} // namespace smm2
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+namespace smm2 {
+namespace world {
+
+// Per-frame snapshot of the global pointer chains every plugin reads.
+// Resolved once at the top of on_frame; consumers read current() instead
+// of walking the chains themselves.
+//
+// Threading: current() belongs to the game thread (procFrame_, plugin
+// per_frame) and is frozen whenever procFrame_ doesn't run — the editor,
+// menus, loads. Code on the npad poll thread (tas, status's fallback)
+// reads resolve_poll() instead, never current().
+//
+// Chains:
+//   GamePhaseManager: [[main+0x2C57D58]+0x30] = inner struct
+//     inner+0x10 is_playing, +0x14 scene_mode, +0x1C game_style / phase
+//   Course theme:     [[main+0x2A67B70]+0x28]+0x210
+//
+// Adding a field: read it in resolve(), once.
+
+struct WorldSnapshot {
+    uint32_t frame;          // frame number resolve() was called with
+    bool     gpm_valid;      // GamePhaseManager inner pointer passed the range check
+    uint32_t gpm_inner[6];   // inner+0x00..0x14
+    uint32_t is_playing;     // inner+0x10: 0=editor, 1=playing/title
+    uint32_t scene_mode;     // inner+0x14: 1=editor, 5=play, 6=title/menu, 7=coursebot
+    uint32_t game_style;     // inner+0x1C: gamestyle index (0-4)
+    int32_t  phase;          // inner+0x1C as read by game_phase (-1 if chain invalid)
+    uint8_t  course_theme;   // 0xFF = unknown
+};
+
+void init();
+
+// Walk all pointer chains and refresh current(). Cheap: a handful of loads.
+void resolve(uint32_t frame);
+
+// Same walk into out, leaving current() alone
+void resolve(uint32_t frame, WorldSnapshot& out);
+
+// Game thread only — see above
+const WorldSnapshot& current();
+
+// npad poll thread only: walk the chains now into the poll thread's own
+// snapshot and return it. Valid until the next resolve_poll().
+const WorldSnapshot& resolve_poll(uint32_t frame);
+
+// Main module base address (resolved once at init)
+uintptr_t main_base();
+
+} // namespace world
+} // namespace smm2
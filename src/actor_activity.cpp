@@ -0,0 +1,152 @@
+#include "smm2/actor_activity.h"
+#include "smm2/camera_debug.h"
+#include "smm2/log.h"
+#include "smm2/perf.h"
+#include "smm2/ticks.h"
+#include "smm2/world.h"
+#include "hk/hook/Trampoline.h"
+
+#include <cstring>
+
+namespace smm2 {
+namespace actor_activity {
+
+// ActorMgr executes actors from procFrame_ on the game thread, so the
+// counters are plain fields: the hook adds, per_frame (after procFrame_'s
+// orig) reads and resets. Classes live in an open-addressed table keyed by
+// vtable; once it is full, new classes are folded into key 0.
+
+constexpr uint32_t CLASS_SLOTS = MAX_CLASSES * 2;
+
+static_assert((CLASS_SLOTS & (CLASS_SLOTS - 1)) == 0, "CLASS_SLOTS must be a power of two");
+
+struct Counts {
+    uint32_t calls;
+    uint32_t active;
+    uint32_t placeholder;
+    uint32_t collision;
+    uint64_t ticks;
+};
+
+struct Class {
+    uint32_t vtable;           // main-relative; 0 = overflow bucket
+    uint32_t seen_seq;         // s_seq of the last frame it ran in
+    bool used;
+    Counts window;
+};
+
+static Class s_classes[CLASS_SLOTS];
+static uint32_t s_class_count = 0;
+static Counts s_frame_counts = {};
+static uint32_t s_frame_classes = 0;
+static uint32_t s_seq = 1;
+static uint32_t s_window_start = 0;
+
+static log::Logger s_log;
+static bool s_inited = false;
+
+static Class& find_class(uint32_t vtable) {
+    for (uint32_t i = (vtable * 0x9E3779B1u) & (CLASS_SLOTS - 1);; i = (i + 1) & (CLASS_SLOTS - 1)) {
+        Class& c = s_classes[i];
+        if (c.used && c.vtable == vtable) return c;
+        if (!c.used) {
+            if (s_class_count >= MAX_CLASSES && vtable != 0) return find_class(0);
+            c.used = true;
+            c.vtable = vtable;
+            s_class_count++;
+            return c;
+        }
+    }
+}
+
+static void add(Counts& c, bool active, bool placeholder, bool collision, uint64_t dt) {
+    c.calls++;
+    c.active += active;
+    c.placeholder += placeholder;
+    c.collision += collision;
+    c.ticks += dt;
+}
+
+// Actor::execute(actor) — ActorBaseCalc runs inside and settles the flags
+static HkTrampoline<long, void*> execute_hook =
+    hk::hook::trampoline([](void* actor) -> long {
+        PERF_SCOPE(actor_activity_execute);
+        uint64_t t0 = ticks::now();
+        long ret = PERF_ORIG(execute_hook.orig(actor));
+        uint64_t dt = ticks::now() - t0;
+
+        uintptr_t a = reinterpret_cast<uintptr_t>(actor);
+        uint32_t flags = *reinterpret_cast<uint32_t*>(a + FLAGS1324_OFFSET);
+        bool active = flags & FLAG_IN_BOUNDS;
+        bool placeholder = flags & FLAG_PLACEHOLDER;
+        bool collision = !placeholder && *reinterpret_cast<uintptr_t*>(a + COLLISION_OFFSET) != 0;
+        uint32_t vtable = uint32_t(*reinterpret_cast<uintptr_t*>(a) - world::main_base());
+
+        Class& c = find_class(vtable);
+        if (c.seen_seq != s_seq) {
+            c.seen_seq = s_seq;
+            s_frame_classes++;
+        }
+        add(c.window, active, placeholder, collision, dt);
+        add(s_frame_counts, active, placeholder, collision, dt);
+        return ret;
+    });
+
+static ActivityRecord make_record(RecordKind kind, uint32_t frame, uint32_t key, const Counts& c) {
+    ActivityRecord r = {};
+    r.kind = uint8_t(kind);
+    r.bounds_override = camera_debug::clamping();
+    r.frame = frame;
+    r.key = key;
+    r.calls = c.calls;
+    r.active = c.active;
+    r.placeholder = c.placeholder;
+    r.collision = c.collision;
+    r.calc_us = ticks::to_us(c.ticks);
+    return r;
+}
+
+void init() {
+    s_log.init("actor_activity.bin", log::Mode::Async);
+    ActivityHeader hdr = {};
+    std::memcpy(hdr.magic, ACTIVITY_MAGIC, sizeof(hdr.magic));
+    hdr.version = ACTIVITY_VERSION;
+    hdr.record_size = sizeof(ActivityRecord);
+    hdr.tick_hz = uint32_t(ticks::frequency());
+    hdr.class_interval = CLASS_INTERVAL;
+    s_log.begin_preamble();
+    s_log.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    s_log.end_preamble();
+    s_inited = true;
+
+    execute_hook.installAtSym<"ActorExecute">();
+}
+
+void per_frame(uint32_t frame) {
+    if (!s_inited) return;
+
+    // Frames where no actor ran (menus, loads) aren't recorded
+    if (s_frame_counts.calls) {
+        ActivityRecord r = make_record(RecordKind::Frame, frame, s_frame_classes, s_frame_counts);
+        s_log.write(reinterpret_cast<const char*>(&r), sizeof(r));
+    }
+    s_frame_counts = {};
+    s_frame_classes = 0;
+    s_seq++;
+
+    if (frame - s_window_start < CLASS_INTERVAL) return;
+    s_window_start = frame;
+    for (Class& c : s_classes) {
+        if (!c.used || c.window.calls == 0) continue;
+        ActivityRecord r = make_record(RecordKind::Class, frame, c.vtable, c.window);
+        s_log.write(reinterpret_cast<const char*>(&r), sizeof(r));
+        c.window = {};
+    }
+}
+
+void flush() {
+    if (s_inited) s_log.flush();
+}
+
+} // namespace actor_activity
+} // namespace smm2
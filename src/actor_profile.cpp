@@ -10,29 +10,29 @@
  *   - State name string
  *   - State ID
  *
- * Output: sd:/smm2-hooks/profiles.csv and sd:/smm2-hooks/actor_states.csv
+ * Both go into boot_tables (interned, deduplicated, dumped once to
+ * sd:/smm2-hooks/boot_tables.bin). With a cached dump on SD the hooks
+ * aren't installed.
  *
  * Research: Mario Possamodder (2026-02-16)
  */
 
 #include <hk/hook/Trampoline.h>
 #include <hk/ro/RoUtil.h>
-#include "smm2/log.h"
+#include "smm2/boot_tables.h"
+#include "smm2/perf.h"
+#include "smm2/plugin.h"
 
 namespace smm2 {
 namespace actor_profile {
 
-static log::Logger g_profile_log;
-static log::Logger g_state_log;
-static int g_profile_count = 0;
-static int g_state_count = 0;
-
 // sub_7101047F40: registerActorProfile(name, index, callback)
 // x0 = sead::SafeStringBase<char>* (stack-constructed: [vtable, char*])
 // w1 = behavior index (0-18)
 // x2 = callback function pointer
 static HkTrampoline<void, void*, unsigned int, void*> profile_hook =
     hk::hook::trampoline([](void* name_obj, unsigned int index, void* callback) -> void {
+        PERF_SCOPE(actor_profile_register);
         const char* name = "unknown";
 
         // sead::SafeStringBase layout: [8 bytes vtable] [8 bytes char*]
@@ -44,12 +44,12 @@ static HkTrampoline<void, void*, unsigned int, void*> profile_hook =
             }
         }
 
-        if (g_profile_count < 2000) {
-            g_profile_log.writef("%s,%u,0x%lx\n", name, index, (unsigned long)callback);
-            g_profile_count++;
-        }
+        // Main-relative so the cached table survives ASLR
+        uintptr_t base = hk::ro::getMainModule()->range().start();
+        uint32_t cb = callback ? uint32_t(uintptr_t(callback) - base) : 0;
+        boot_tables::add(boot_tables::Table::Profiles, boot_tables::intern(name), index, cb);
 
-        profile_hook.orig(name_obj, index, callback);
+        PERF_ORIG(profile_hook.orig(name_obj, index, callback));
     });
 
 // sub_71008B8FA0: StateMachine::registerState(sm, state_id, delegate_pair)
@@ -58,6 +58,7 @@ static HkTrampoline<void, void*, unsigned int, void*> profile_hook =
 // x2 = delegate pair (stack: [vtable, char* state_name])
 static HkTrampoline<void, void*, unsigned int, void*> state_hook =
     hk::hook::trampoline([](void* sm, unsigned int state_id, void* delegate_pair) -> void {
+        PERF_SCOPE(actor_profile_state);
         const char* state_name = "unknown";
 
         // delegate pair: [8 bytes vtable-like pointer] [8 bytes char* name]
@@ -69,22 +70,20 @@ static HkTrampoline<void, void*, unsigned int, void*> state_hook =
             }
         }
 
-        if (g_state_count < 20000) {
-            g_state_log.writef("%s,%u\n", state_name, state_id);
-            g_state_count++;
-        }
+        // Every StateMachine instance registers its states — mostly repeats
+        boot_tables::add(boot_tables::Table::States, boot_tables::intern(state_name), state_id, 0);
 
-        state_hook.orig(sm, state_id, delegate_pair);
+        PERF_ORIG(state_hook.orig(sm, state_id, delegate_pair));
     });
 
 void init() {
-    g_profile_log.init("profiles.csv");
-    g_profile_log.write("name,index,callback\n", 20);
-    g_state_log.init("actor_states.csv");
-    g_state_log.write("state_name,state_id\n", 20);
+    if (boot_tables::cached()) return;
 
-    profile_hook.installAtSym<"ActorProfileRegister">();
-    state_hook.installAtSym<"SMRegisterState">();
+    // Hook groups: profiles, states
+    if (plugin::hooks_enabled("actor_profile", "profiles"))
+        profile_hook.installAtSym<"ActorProfileRegister">();
+    if (plugin::hooks_enabled("actor_profile", "states"))
+        state_hook.installAtSym<"SMRegisterState">();
 }
 
 } // namespace actor_profile
@@ -0,0 +1,346 @@
+#include "smm2/actor_registry.h"
+#include "smm2/cfg.h"
+#include "smm2/paths.h"
+#include "smm2/boot_tables.h"
+#include "smm2/frame.h"
+#include "smm2/log.h"
+#include "smm2/perf.h"
+#include "smm2/world.h"
+#include "smm2/util.h"
+#include "nn/fs.h"
+#include "hk/hook/Trampoline.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace smm2 {
+namespace actor_registry {
+
+// ============================================================
+// Actor table: open-addressed by StateMachine pointer (linear probing).
+// registerState runs during actor construction, changeState during the
+// actor's update — both mostly on the game thread, but loaders construct
+// actors too, so the table is guarded by a spinlock held for one probe.
+//
+// Callback table: profile callbacks (main-relative) sorted by address,
+// double-buffered so per_frame can rebuild one copy while hooks search
+// the other.
+// ============================================================
+
+constexpr uint32_t ACTOR_SLOTS = MAX_ACTORS * 2;
+constexpr uint32_t MAX_PROFILES = 2048;
+
+static_assert((ACTOR_SLOTS & (ACTOR_SLOTS - 1)) == 0, "ACTOR_SLOTS must be a power of two");
+
+struct Actor {
+    uintptr_t sm;              // 0 = free
+    uint32_t id;
+    uint32_t reg_frame;        // frame of the last registerState
+    uint32_t seen_frame;       // frame of the last registerState / changeState
+    uint16_t profile;
+    uint8_t streamed;          // passed the actors.cfg filter
+    uint8_t _pad;
+};
+
+struct Callback {
+    uint32_t offset;           // main-relative
+    uint16_t profile;
+};
+
+static Actor s_actors[ACTOR_SLOTS];
+static uint32_t s_live = 0;
+static uint32_t s_next_id = 1;
+
+static Callback s_callbacks[2][MAX_PROFILES];
+static uint32_t s_callback_count[2];
+static std::atomic<uint32_t> s_callback_buf{0};
+static uint32_t s_linked_profiles = 0;      // boot_tables profile count last built from
+static boot_tables::BootEntry s_scratch[MAX_PROFILES];
+
+static uint16_t s_include[MAX_FILTER];
+static uint16_t s_exclude[MAX_FILTER];
+static uint32_t s_include_count = 0;
+static uint32_t s_exclude_count = 0;
+static bool s_keep_unlinked = true;
+
+static std::atomic_flag s_lock = ATOMIC_FLAG_INIT;
+
+static log::Logger s_stream;
+static bool s_inited = false;
+
+static uint32_t actor_hash(uintptr_t sm) {
+    return uint32_t((sm >> 4) * 0x9E3779B97F4A7C15ull >> 32);
+}
+
+static bool allowed(uint16_t profile) {
+    if (profile == NO_PROFILE) return s_keep_unlinked && s_include_count == 0;
+    for (uint32_t i = 0; i < s_exclude_count; i++)
+        if (s_exclude[i] == profile) return false;
+    if (s_include_count == 0) return true;
+    for (uint32_t i = 0; i < s_include_count; i++)
+        if (s_include[i] == profile) return true;
+    return false;
+}
+
+static void emit(uint32_t frame, uint32_t actor, uint16_t profile, uint32_t old_state,
+                 uint32_t new_state, RecordKind kind) {
+    ActorRecord r = {frame, actor, profile, uint16_t(old_state), uint16_t(new_state),
+                     uint8_t(kind), 0};
+    s_stream.write(reinterpret_cast<const char*>(&r), sizeof(r));
+}
+
+// Profile whose callback the current call stack passes through. Frames
+// are only followed upwards and within 64 KiB, so a broken chain ends
+// the walk instead of faulting.
+static uint16_t creating_profile() {
+    uint32_t buf = s_callback_buf.load(std::memory_order_acquire);
+    const Callback* cbs = s_callbacks[buf];
+    uint32_t n = s_callback_count[buf];
+    if (n == 0) return NO_PROFILE;
+    uintptr_t base = world::main_base();
+    uint32_t hi = cbs[n - 1].offset + CALLBACK_SPAN;
+
+    uintptr_t fp = uintptr_t(__builtin_frame_address(0));
+    for (uint32_t depth = 0; depth < MAX_STACK_WALK && fp && (fp & 0xF) == 0; depth++) {
+        const uintptr_t* frame_rec = reinterpret_cast<const uintptr_t*>(fp);
+        uintptr_t lr = frame_rec[1];
+        if (lr > base && lr - base < hi) {
+            uint32_t rel = uint32_t(lr - base);
+            // Last callback starting at or before rel
+            uint32_t lo = 0, top = n;
+            while (lo < top) {
+                uint32_t mid = (lo + top) / 2;
+                if (cbs[mid].offset <= rel) lo = mid + 1;
+                else top = mid;
+            }
+            if (lo > 0 && rel - cbs[lo - 1].offset < CALLBACK_SPAN) return cbs[lo - 1].profile;
+        }
+        uintptr_t next = frame_rec[0];
+        if (next <= fp || next - fp > 0x10000) break;
+        fp = next;
+    }
+    return NO_PROFILE;
+}
+
+// Free slot i, shifting later entries of its probe run back so lookups
+// never stop at the hole
+static void erase(uint32_t i) {
+    for (uint32_t j = (i + 1) & (ACTOR_SLOTS - 1); s_actors[j].sm; j = (j + 1) & (ACTOR_SLOTS - 1)) {
+        uint32_t home = actor_hash(s_actors[j].sm) & (ACTOR_SLOTS - 1);
+        // j may move to i unless its home lies cyclically in (i, j]
+        if (((j - home) & (ACTOR_SLOTS - 1)) >= ((j - i) & (ACTOR_SLOTS - 1))) {
+            s_actors[i] = s_actors[j];
+            i = j;
+        }
+    }
+    s_actors[i] = {};
+    s_live--;
+}
+
+static uint32_t age_bucket(uint32_t frame, const Actor& a) {
+    return 32 - __builtin_clz((frame - a.seen_frame) | 1);
+}
+
+// Erase up to limit entries in age bucket min_bucket or older
+static uint32_t erase_older(uint32_t frame, uint32_t min_bucket, uint32_t limit) {
+    uint32_t dropped = 0;
+    for (uint32_t i = 0; i < ACTOR_SLOTS && dropped < limit;) {
+        if (s_actors[i].sm && age_bucket(frame, s_actors[i]) >= min_bucket) {
+            erase(i);       // a later entry may have shifted into i
+            dropped++;
+        } else {
+            i++;
+        }
+    }
+    return dropped;
+}
+
+// Drop the EVICT_BATCH least recently seen actors: bucket them by log2
+// age, erase every bucket older than the cut, then top up from the cut
+// bucket. Returns how many went.
+static uint32_t evict(uint32_t frame) {
+    uint32_t hist[33] = {};
+    for (uint32_t i = 0; i < ACTOR_SLOTS; i++)
+        if (s_actors[i].sm) hist[age_bucket(frame, s_actors[i])]++;
+    uint32_t cut = 32, older = 0;
+    while (cut > 0 && older + hist[cut] < EVICT_BATCH) older += hist[cut--];
+
+    uint32_t dropped = erase_older(frame, cut + 1, older);
+    return dropped + erase_older(frame, cut, EVICT_BATCH - dropped);
+}
+
+// Caller holds the lock. Makes room by eviction when the table is full;
+// evicted is how many went (0 if none).
+static Actor* find_or_insert(uintptr_t sm, uint32_t frame, bool& inserted, uint32_t& evicted) {
+    inserted = false;
+    evicted = 0;
+    for (uint32_t i = actor_hash(sm) & (ACTOR_SLOTS - 1);; i = (i + 1) & (ACTOR_SLOTS - 1)) {
+        Actor& a = s_actors[i];
+        if (a.sm == sm) {
+            a.seen_frame = frame;
+            return &a;
+        }
+        if (a.sm == 0) break;
+    }
+    if (s_live >= MAX_ACTORS) evicted = evict(frame);
+    for (uint32_t i = actor_hash(sm) & (ACTOR_SLOTS - 1);; i = (i + 1) & (ACTOR_SLOTS - 1)) {
+        Actor& a = s_actors[i];
+        if (a.sm == 0) {
+            a.sm = sm;
+            a.seen_frame = frame;
+            s_live++;
+            inserted = true;
+            return &a;
+        }
+    }
+}
+
+// Fresh entry, or an old one whose StateMachine was reused by a new actor
+static void link(Actor& a, uint16_t profile, uint32_t frame) {
+    a.id = s_next_id++;
+    a.reg_frame = frame;
+    a.profile = profile;
+    a.streamed = allowed(profile);
+}
+
+// StateMachine::registerState(sm, state_id, delegate_pair) — see actor_profile.cpp
+static HkTrampoline<void, void*, unsigned int, void*> register_hook =
+    hk::hook::trampoline([](void* sm, unsigned int state_id, void* delegate_pair) -> void {
+        PERF_SCOPE(actor_registry_register);
+        uint32_t frame = frame::current();
+        uint16_t profile = creating_profile();
+
+        bool inserted, spawned = false;
+        uint32_t id = 0, evicted;
+        {
+            SpinGuard g(s_lock);
+            Actor* a = find_or_insert(uintptr_t(sm), frame, inserted, evicted);
+            // An actor registers all its states in one go; a later burst on
+            // the same StateMachine is a new actor at a reused address
+            if (inserted || a->reg_frame != frame) {
+                link(*a, profile, frame);
+                spawned = a->streamed;
+                id = a->id;
+            }
+        }
+        if (evicted) emit(frame, evicted, NO_PROFILE, 0, 0, RecordKind::Evict);
+        if (spawned) emit(frame, id, profile, 0, 0, RecordKind::Spawn);
+
+        PERF_ORIG(register_hook.orig(sm, state_id, delegate_pair));
+    });
+
+// StateMachine::changeState(sm, state_id); current state at sm+0x08
+static HkTrampoline<void, void*, uint32_t> change_hook =
+    hk::hook::trampoline([](void* sm, uint32_t new_state) -> void {
+        PERF_SCOPE(actor_registry_change);
+        uint32_t old_state = *reinterpret_cast<uint32_t*>(reinterpret_cast<uintptr_t>(sm) + 0x08);
+        PERF_ORIG(change_hook.orig(sm, new_state));
+
+        uint32_t frame = frame::current();
+        bool inserted, streamed;
+        uint32_t id, evicted;
+        uint16_t profile;
+        {
+            SpinGuard g(s_lock);
+            Actor* a = find_or_insert(uintptr_t(sm), frame, inserted, evicted);
+            // Registered before init or evicted since — track it unlinked
+            if (inserted) link(*a, NO_PROFILE, frame);
+            streamed = a->streamed;
+            id = a->id;
+            profile = a->profile;
+        }
+        if (evicted) emit(frame, evicted, NO_PROFILE, 0, 0, RecordKind::Evict);
+        if (!streamed) return;
+        if (inserted) emit(frame, id, profile, 0, 0, RecordKind::Spawn);
+        emit(frame, id, profile, old_state, new_state, RecordKind::Change);
+    });
+
+// Names may not be registered yet on a first boot; interning them now
+// gives the id the registration hook will find later
+static void parse_names(const char* list, uint16_t* out, uint32_t& count) {
+    cfg::for_each_token(list, [&](const char* tok, size_t len) {
+        char name[64];
+        if (count >= MAX_FILTER || len >= sizeof(name)) return;
+        std::memcpy(name, tok, len);
+        name[len] = '\0';
+        uint16_t id = boot_tables::intern(name);
+        if (id != boot_tables::NO_STRING) out[count++] = id;
+    });
+}
+
+static void load_config() {
+    cfg::read("actors.cfg", [](char* line) {
+        if (std::strncmp(line, "include=", 8) == 0) {
+            parse_names(line + 8, s_include, s_include_count);
+        } else if (std::strncmp(line, "exclude=", 8) == 0) {
+            parse_names(line + 8, s_exclude, s_exclude_count);
+        } else if (std::strncmp(line, "unlinked=", 9) == 0) {
+            s_keep_unlinked = line[9] == '1';
+        }
+    });
+}
+
+// Sort the profile table into the idle buffer and publish it
+static void rebuild_callbacks() {
+    uint32_t n = boot_tables::copy(boot_tables::Table::Profiles, s_scratch, MAX_PROFILES);
+    uint32_t buf = s_callback_buf.load(std::memory_order_relaxed) ^ 1;
+    Callback* out = s_callbacks[buf];
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (s_scratch[i].value == 0) continue;
+        Callback c = {s_scratch[i].value, s_scratch[i].name};
+        // Registration order is close to address order — insertion sort
+        uint32_t j = count++;
+        while (j > 0 && out[j - 1].offset > c.offset) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = c;
+    }
+    s_callback_count[buf] = count;
+    s_callback_buf.store(buf, std::memory_order_release);
+}
+
+void init() {
+    load_config();
+
+    s_stream.init("actor_states.bin", log::Mode::Shared);
+    ActorStreamHeader hdr = {};
+    std::memcpy(hdr.magic, ACTOR_MAGIC, sizeof(hdr.magic));
+    hdr.version = ACTOR_VERSION;
+    hdr.record_size = sizeof(ActorRecord);
+    hdr.game_version = boot_tables::GAME_VERSION;
+    s_stream.begin_preamble();
+    s_stream.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    s_stream.end_preamble();
+
+    s_linked_profiles = boot_tables::count(boot_tables::Table::Profiles);
+    rebuild_callbacks();
+    s_inited = true;
+
+    register_hook.installAtSym<"SMRegisterState">();
+    change_hook.installAtSym<"StateMachine_changeState">();
+}
+
+void per_frame(uint32_t frame) {
+    (void)frame;
+    if (!s_inited) return;
+    // Profiles register during boot; rebuild whenever the table grew
+    uint32_t profiles = boot_tables::count(boot_tables::Table::Profiles);
+    if (profiles != s_linked_profiles) {
+        s_linked_profiles = profiles;
+        rebuild_callbacks();
+    }
+}
+
+void flush() {
+    if (s_inited) s_stream.flush();
+}
+
+uint32_t live_count() {
+    SpinGuard g(s_lock);
+    return s_live;
+}
+
+} // namespace actor_registry
+} // namespace smm2
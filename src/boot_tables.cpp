@@ -0,0 +1,299 @@
+#include "smm2/boot_tables.h"
+#include "smm2/log.h"
+#include "smm2/paths.h"
+#include "smm2/ticks.h"
+#include "smm2/util.h"
+#include "nn/fs.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace smm2 {
+namespace boot_tables {
+
+// ============================================================
+// Two open-addressed hash sets (linear probing, slot = id + 1, 0 = empty),
+// both append-only: ids and pool offsets never move, so a dump can copy
+// the counts under the lock and write the arrays without holding it.
+// Registration runs on loader threads as well as the game thread; the
+// lock covers a hash + probe, never an fs call.
+// ============================================================
+
+constexpr const char* FILE_NAME = "boot_tables.bin";
+constexpr uint32_t STRING_SLOTS = MAX_STRINGS * 2;
+constexpr uint32_t ENTRY_SLOTS = MAX_ENTRIES * 2;
+
+static_assert((STRING_SLOTS & (STRING_SLOTS - 1)) == 0, "STRING_SLOTS must be a power of two");
+static_assert((ENTRY_SLOTS & (ENTRY_SLOTS - 1)) == 0, "ENTRY_SLOTS must be a power of two");
+static_assert(MAX_STRINGS < NO_STRING, "string ids must fit below NO_STRING");
+
+static const char* const TABLE_NAMES[uint32_t(Table::COUNT)] = {
+    "profiles",
+    "states",
+    "xlink2_enums",
+};
+
+static char s_pool[POOL_BYTES];
+static uint32_t s_pool_used = 0;
+static uint32_t s_string_offset[MAX_STRINGS];
+static uint32_t s_string_count = 0;
+static uint16_t s_string_slots[STRING_SLOTS];
+
+static BootEntry s_entries[MAX_ENTRIES];
+static uint32_t s_entry_count = 0;
+static uint16_t s_entry_slots[ENTRY_SLOTS];
+
+static uint32_t s_counts[uint32_t(Table::COUNT)];
+static uint32_t s_calls[uint32_t(Table::COUNT)];
+static uint32_t s_dropped = 0;
+
+static std::atomic_flag s_lock = ATOMIC_FLAG_INIT;
+static std::atomic<bool> s_added{false};
+
+static bool s_cached = false;
+static uint32_t s_generation = 0;
+
+// poll() state, owned by whichever thread holds s_polling
+static std::atomic_flag s_polling = ATOMIC_FLAG_INIT;
+static bool s_pending = false;
+static uint64_t s_last_added = 0;   // ticks
+static bool s_dumping = false;
+
+constexpr uint32_t DUMP_BYTES_PER_POLL = log::BUFFER_SIZE / 2;
+constexpr uint32_t SECTION_COUNT = 3;
+
+struct Section {
+    const char* data;
+    uint32_t len;
+};
+
+static log::Logger s_out;
+static Section s_sections[SECTION_COUNT];   // string offsets, pool, entries
+static uint32_t s_section = 0;
+static uint32_t s_section_off = 0;
+
+static uint32_t fnv1a(const char* s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= uint8_t(s[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static uint32_t entry_hash(uint8_t table, uint16_t name, uint32_t key) {
+    uint32_t h = (uint32_t(table) << 16 | name) * 0x9E3779B1u;
+    return (h ^ key) * 0x85EBCA6Bu;
+}
+
+uint16_t intern(const char* s) {
+    if (!s) return NO_STRING;
+    size_t len = std::strlen(s);
+    uint32_t h = fnv1a(s, len);
+
+    SpinGuard g(s_lock);
+    for (uint32_t i = h & (STRING_SLOTS - 1);; i = (i + 1) & (STRING_SLOTS - 1)) {
+        uint16_t slot = s_string_slots[i];
+        if (slot == 0) {
+            if (s_string_count >= MAX_STRINGS || s_pool_used + len + 1 > POOL_BYTES) {
+                s_dropped++;
+                return NO_STRING;
+            }
+            uint16_t id = uint16_t(s_string_count++);
+            s_string_offset[id] = s_pool_used;
+            std::memcpy(s_pool + s_pool_used, s, len + 1);
+            s_pool_used += uint32_t(len + 1);
+            s_string_slots[i] = uint16_t(id + 1);
+            return id;
+        }
+        const char* existing = s_pool + s_string_offset[slot - 1];
+        if (std::strcmp(existing, s) == 0) return uint16_t(slot - 1);
+    }
+}
+
+void add(Table t, uint16_t name, uint32_t key, uint32_t value) {
+    if (name == NO_STRING) return;
+    uint8_t table = uint8_t(t);
+    uint32_t h = entry_hash(table, name, key);
+
+    SpinGuard g(s_lock);
+    s_calls[table]++;
+    for (uint32_t i = h & (ENTRY_SLOTS - 1);; i = (i + 1) & (ENTRY_SLOTS - 1)) {
+        uint16_t slot = s_entry_slots[i];
+        if (slot == 0) {
+            if (s_entry_count >= MAX_ENTRIES) {
+                s_dropped++;
+                return;
+            }
+            uint32_t id = s_entry_count++;
+            s_entries[id] = {table, 0, name, key, value};
+            s_entry_slots[i] = uint16_t(id + 1);
+            s_counts[table]++;
+            s_added.store(true, std::memory_order_relaxed);
+            return;
+        }
+        const BootEntry& e = s_entries[slot - 1];
+        if (e.table == table && e.name == name && e.key == key) return;
+    }
+}
+
+// Header first, then the arrays a chunk per poll through an Async logger —
+// the writer thread does the SD I/O. A dump cut short is shorter than its
+// header says, so load_cache()'s reads reject it.
+static void start_dump() {
+    BootHeader hdr = {};
+    BootTableDesc descs[uint32_t(Table::COUNT)] = {};
+    {
+        SpinGuard g(s_lock);
+        hdr.string_count = s_string_count;
+        hdr.pool_bytes = align4(s_pool_used);
+        hdr.entry_count = s_entry_count;
+        hdr.dropped = s_dropped;
+        for (uint32_t t = 0; t < uint32_t(Table::COUNT); t++) {
+            descs[t].count = s_counts[t];
+            descs[t].calls = s_calls[t];
+        }
+    }
+    for (uint32_t t = 0; t < uint32_t(Table::COUNT); t++)
+        std::strncpy(descs[t].name, TABLE_NAMES[t], sizeof(descs[t].name) - 1);
+    std::memcpy(hdr.magic, BOOT_MAGIC, sizeof(hdr.magic));
+    hdr.version = BOOT_VERSION;
+    hdr.table_count = uint16_t(Table::COUNT);
+    hdr.game_version = GAME_VERSION;
+    hdr.generation = ++s_generation;
+
+    // Pool bytes past s_pool_used are still zero, so the 4-byte pad is free
+    s_sections[0] = {reinterpret_cast<const char*>(s_string_offset), hdr.string_count * uint32_t(sizeof(uint32_t))};
+    s_sections[1] = {s_pool, hdr.pool_bytes};
+    s_sections[2] = {reinterpret_cast<const char*>(s_entries), hdr.entry_count * uint32_t(sizeof(BootEntry))};
+    s_section = 0;
+    s_section_off = 0;
+
+    s_out.init(FILE_NAME, log::Mode::Async);
+    s_out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    s_out.write(reinterpret_cast<const char*>(descs), sizeof(descs));
+}
+
+// Up to DUMP_BYTES_PER_POLL more; true once the whole file is queued
+static bool dump_step() {
+    uint32_t budget = DUMP_BYTES_PER_POLL;
+    while (budget > 0 && s_section < SECTION_COUNT) {
+        const Section& sec = s_sections[s_section];
+        uint32_t n = sec.len - s_section_off;
+        if (n > budget) n = budget;
+        s_out.write(sec.data + s_section_off, n);
+        budget -= n;
+        s_section_off += n;
+        if (s_section_off == sec.len) {
+            s_section++;
+            s_section_off = 0;
+        }
+    }
+    if (s_section < SECTION_COUNT) return false;
+    s_out.flush();
+    return true;
+}
+
+static bool read_at(nn::fs::FileHandle f, int64_t& off, void* out, size_t len) {
+    size_t got = 0;
+    uint32_t rc = nn::fs::ReadFile(&got, f, off, out, len);
+    off += int64_t(len);
+    return rc == 0 && got == len;
+}
+
+// Rebuild both hash sets from the loaded arrays
+static void rehash() {
+    std::memset(s_string_slots, 0, sizeof(s_string_slots));
+    for (uint32_t id = 0; id < s_string_count; id++) {
+        const char* s = s_pool + s_string_offset[id];
+        uint32_t i = fnv1a(s, std::strlen(s)) & (STRING_SLOTS - 1);
+        while (s_string_slots[i]) i = (i + 1) & (STRING_SLOTS - 1);
+        s_string_slots[i] = uint16_t(id + 1);
+    }
+    std::memset(s_entry_slots, 0, sizeof(s_entry_slots));
+    for (uint32_t id = 0; id < s_entry_count; id++) {
+        const BootEntry& e = s_entries[id];
+        uint32_t i = entry_hash(e.table, e.name, e.key) & (ENTRY_SLOTS - 1);
+        while (s_entry_slots[i]) i = (i + 1) & (ENTRY_SLOTS - 1);
+        s_entry_slots[i] = uint16_t(id + 1);
+    }
+}
+
+static bool load_cache() {
+    nn::fs::FileHandle f;
+    if (!paths::open_read(&f, FILE_NAME)) return false;
+    BootHeader hdr = {};
+    BootTableDesc descs[uint32_t(Table::COUNT)];
+    int64_t off = 0;
+    bool ok = read_at(f, off, &hdr, sizeof(hdr)) &&
+              std::memcmp(hdr.magic, BOOT_MAGIC, sizeof(hdr.magic)) == 0 &&
+              hdr.version == BOOT_VERSION && hdr.game_version == GAME_VERSION &&
+              hdr.table_count == uint16_t(Table::COUNT) && hdr.entry_count > 0 &&
+              hdr.string_count <= MAX_STRINGS && hdr.pool_bytes <= POOL_BYTES &&
+              hdr.entry_count <= MAX_ENTRIES &&
+              read_at(f, off, descs, sizeof(descs)) &&
+              read_at(f, off, s_string_offset, hdr.string_count * sizeof(uint32_t)) &&
+              read_at(f, off, s_pool, hdr.pool_bytes) &&
+              read_at(f, off, s_entries, hdr.entry_count * sizeof(BootEntry));
+    nn::fs::CloseFile(f);
+
+    if (!ok) {
+        std::memset(s_pool, 0, sizeof(s_pool));
+        return false;
+    }
+    s_string_count = hdr.string_count;
+    s_pool_used = hdr.pool_bytes;
+    s_entry_count = hdr.entry_count;
+    for (uint32_t t = 0; t < uint32_t(Table::COUNT); t++) {
+        s_counts[t] = descs[t].count;
+        s_calls[t] = descs[t].calls;
+    }
+    rehash();
+    return true;
+}
+
+void init() {
+    s_cached = load_cache();
+}
+
+bool cached() {
+    return s_cached;
+}
+
+uint32_t count(Table t) {
+    SpinGuard g(s_lock);
+    return s_counts[uint32_t(t)];
+}
+
+uint32_t copy(Table t, BootEntry* out, uint32_t max) {
+    SpinGuard g(s_lock);
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < s_entry_count && n < max; i++)
+        if (s_entries[i].table == uint8_t(t)) out[n++] = s_entries[i];
+    return n;
+}
+
+const char* string(uint16_t id) {
+    SpinGuard g(s_lock);
+    return id < s_string_count ? s_pool + s_string_offset[id] : "";
+}
+
+void poll() {
+    // Game thread and npad poll thread both call in; the second one skips
+    if (s_polling.test_and_set(std::memory_order_acquire)) return;
+    uint64_t now = ticks::now();
+    if (s_dumping) {
+        if (dump_step()) s_dumping = false;
+    } else if (s_added.exchange(false, std::memory_order_relaxed)) {
+        s_last_added = now;
+        s_pending = true;
+    } else if (s_pending && now - s_last_added >= SETTLE_MS * ticks::frequency() / 1000) {
+        start_dump();
+        s_pending = false;
+        s_dumping = true;
+    }
+    s_polling.clear(std::memory_order_release);
+}
+
+} // namespace boot_tables
+} // namespace smm2
@@ -1,3 +1,4 @@
+#include "smm2/camera_debug.h"
 #include "smm2/log.h"
 #include "hk/ro/RoUtil.h"
 
@@ -6,6 +7,7 @@ namespace smm2 { namespace camera_debug {
 static uintptr_t s_cam_global_addr = 0;
 static uintptr_t s_last_cam = 0;
 static log::Logger s_log;
+static bool s_clamping = false;
 
 uintptr_t get_camera() {
     if (s_cam_global_addr == 0) return 0;
@@ -52,14 +54,21 @@ void per_frame(uint32_t frame) {
         f[0x74/4] = -40.0f;
         f[0x78/4] = -16.0f;
         f[0x7C/4] = 424.0f;
+        s_clamping = true;
     }
 }
 
+bool clamping() {
+    return s_clamping;
+}
+
 void init() {
     uintptr_t base = hk::ro::getMainModule()->range().start();
     s_cam_global_addr = base + 0x2C55080;
     s_log.init("camera_debug.csv");
+    s_log.begin_preamble();
     s_log.write("frame,field,value\n", 18);
+    s_log.end_preamble();
 }
 
 }} // namespace smm2::camera_debug
@@ -1,5 +1,10 @@
 #include "smm2/course_data.h"
+#include "smm2/course_map.h"
+#include "smm2/load_profile.h"
 #include "smm2/log.h"
+#include "smm2/perf.h"
+#include "smm2/plugin.h"
+#include "smm2/ticks.h"
 #include "nn/fs.h"
 #include "hk/hook/Trampoline.h"
 
@@ -22,8 +27,15 @@ static int s_count = 0;
 // Logs directly to file (initialized late by dump_open_log trigger)
 static bool s_log_ready = false;
 
+// OpenFile is called from loader threads as well as the game thread, so this
+// logger runs in Shared mode: each thread appends to its own ring. The
+// merged file is flushed every OPEN_LOG_FLUSH records rather than per open,
+// so logging doesn't slow the loads it observes. Timing goes to load_profile.
+constexpr int OPEN_LOG_FLUSH = 32;
+
 static HkTrampoline<uint32_t, nn::fs::FileHandle*, const char*, int> open_hook =
     hk::hook::trampoline([](nn::fs::FileHandle* handle, const char* path, int mode) -> uint32_t {
+        PERF_SCOPE(course_data_open);
         // Only log after dump_open_log signals we're ready
         if (s_log_ready && path && s_count < 500) {
             // Skip our own files to avoid spam
@@ -32,18 +44,22 @@ static HkTrampoline<uint32_t, nn::fs::FileHandle*, const char*, int> open_hook =
                 // sd:/smm2-hooks/... skip
             } else {
                 s_log.writef("open,%s,%d\n", path, mode);
-                s_log.flush();
-                s_count++;
+                if (++s_count % OPEN_LOG_FLUSH == 0) s_log.flush();
             }
         }
-        return open_hook.orig(handle, path, mode);
+        uint64_t t0 = ticks::now();
+        uint32_t rc = PERF_ORIG(open_hook.orig(handle, path, mode));
+        load_profile::on_open(handle, path, rc, ticks::now() - t0);
+        return rc;
     });
 
 // Call this after status system is running - enables OpenFile logging
 void dump_open_log() {
     if (!s_inited) {
-        s_log.init("course_data.csv");
+        s_log.init("course_data.csv", log::Mode::Shared);
+        s_log.begin_preamble();
         s_log.write("event,path,mode\n", 16);
+        s_log.end_preamble();
         s_inited = true;
     }
     s_log_ready = true;
@@ -51,10 +67,13 @@ void dump_open_log() {
 
 static HkTrampoline<uint32_t, nn::fs::FileHandle, int64_t, const void*, size_t, const nn::fs::WriteOption&> write_hook =
     hk::hook::trampoline([](nn::fs::FileHandle fh, int64_t offset, const void* data, size_t size, const nn::fs::WriteOption& opt) -> uint32_t {
+        PERF_SCOPE(course_data_write);
         if (s_count < 50) {
             if (!s_inited) {
-                s_log.init("course_data.csv");
+                s_log.init("course_data.csv", log::Mode::Shared);
+                s_log.begin_preamble();
                 s_log.write("event,size,b0b1b2b3\n", 20);
+                s_log.end_preamble();
                 s_inited = true;
             }
             const uint8_t* b = (const uint8_t*)data;
@@ -76,13 +95,21 @@ static HkTrampoline<uint32_t, nn::fs::FileHandle, int64_t, const void*, size_t,
                 }
             }
         }
-        
-        return write_hook.orig(fh, offset, data, size, opt);
+
+        // Decrypted course buffer: rebuild the tile index (not capped by s_count)
+        const uint8_t* bcd = (const uint8_t*)data;
+        if (size >= 0x5BFC0 && size <= 0x5C000 && bcd[0] <= 30 && bcd[1] <= 30)
+            course_map::build(bcd, size);
+
+        return PERF_ORIG(write_hook.orig(fh, offset, data, size, opt));
     });
 
+// Hook groups: open (OpenFile log + load_profile's open timing), write (BCD / course_map)
 void init() {
-    open_hook.installAtSym<"_ZN2nn2fs8OpenFileEPNS0_10FileHandleEPKci">();
-    write_hook.installAtSym<"_ZN2nn2fs9WriteFileENS0_10FileHandleElPKvmRKNS0_11WriteOptionE">();
+    if (plugin::hooks_enabled("course_data", "open"))
+        open_hook.installAtSym<"_ZN2nn2fs8OpenFileEPNS0_10FileHandleEPKci">();
+    if (plugin::hooks_enabled("course_data", "write"))
+        write_hook.installAtSym<"_ZN2nn2fs9WriteFileENS0_10FileHandleElPKvmRKNS0_11WriteOptionE">();
 }
 
 } // namespace course_data
@@ -0,0 +1,296 @@
+#include "smm2/course_map.h"
+#include "smm2/paths.h"
+#include "smm2/util.h"
+#include "nn/fs.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace smm2 {
+namespace course_map {
+
+// ============================================================
+// BCD layout (decrypted, see tools/parse_course.py)
+// ============================================================
+
+constexpr size_t BCD_AREA_OFFSET = 0x200;
+constexpr size_t BCD_AREA_SIZE = 0x2DEE0;
+constexpr size_t BCD_SIZE = BCD_AREA_OFFSET + AREA_COUNT * BCD_AREA_SIZE;
+
+// Area header
+constexpr size_t AREA_THEME        = 0x00;
+constexpr size_t AREA_ORIENTATION  = 0x03;
+constexpr size_t AREA_OBJECT_COUNT = 0x1C;
+constexpr size_t AREA_PIPE_COUNT   = 0x28;
+constexpr size_t AREA_GROUND_COUNT = 0x3C;
+constexpr size_t AREA_TRACK_COUNT  = 0x40;
+
+// Tables: objects and ground match tools/gen_level.py; pipes and tracks
+// are placed around ground by the published table sizes
+constexpr size_t OBJECTS_OFFSET = 0x48;       // 2600 × 0x20
+constexpr size_t GROUND_OFFSET  = 0x247A4;    // 4000 × 4: x, y, u16 id
+constexpr size_t PIPES_OFFSET   = GROUND_OFFSET - 0x1B8 - 0x1B8 - 0x348 - 200 * 0x124;
+constexpr size_t TRACKS_OFFSET  = GROUND_OFFSET + 4000 * 4;   // 1500 × 0xC
+
+constexpr uint32_t MAX_GROUND = 4000;
+constexpr uint32_t MAX_PIPES = 200;
+constexpr uint32_t PIPE_SIZE = 0x124;         // index, node_count, u16, nodes[36]
+constexpr uint32_t PIPE_NODES = 36;
+constexpr uint32_t MAX_TRACKS = 1500;
+constexpr uint32_t TRACK_SIZE = 0xC;
+
+static_assert(TRACKS_OFFSET + MAX_TRACKS * TRACK_SIZE <= BCD_AREA_SIZE, "track table overruns area");
+
+struct Area {
+    MapAreaHeader hdr;
+    uint8_t cells[MAX_CELLS];
+    uint16_t block_start[MAX_BLOCKS + 1];
+    MapObject objects[MAX_OBJECTS];
+};
+
+static Area s_areas[AREA_COUNT];
+
+// Seqlock: odd while build() is rewriting s_areas
+static std::atomic<uint32_t> s_seq{0};
+static uint32_t s_generation = 0;
+
+template<typename T>
+static T load(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t count_at(const uint8_t* area, size_t off, uint32_t max) {
+    uint32_t n = load<uint32_t>(area + off);
+    return n < max ? n : max;
+}
+
+// Footprint origin of a BCD object (positions are box centres)
+static int obj_origin(int32_t pos, uint8_t size) {
+    int32_t lo = pos - int32_t(size - 1) * int32_t(BCD_TILE / 2);
+    return lo < 0 ? -1 - (-lo - 1) / int32_t(BCD_TILE) : lo / int32_t(BCD_TILE);
+}
+
+struct Extent {
+    int w = 0, h = 0;
+    void add(int x, int y) {
+        if (x >= 0 && x + 1 > w) w = x + 1;
+        if (y >= 0 && y + 1 > h) h = y + 1;
+    }
+};
+
+static void mark(Area& a, int x, int y, int w, int h, uint8_t flag) {
+    for (int ty = y; ty < y + h; ty++) {
+        if (ty < 0 || ty >= a.hdr.height) continue;
+        for (int tx = x; tx < x + w; tx++) {
+            if (tx < 0 || tx >= a.hdr.width) continue;
+            a.cells[ty * a.hdr.width + tx] |= flag;
+        }
+    }
+}
+
+static bool in_grid(const Area& a, int x, int y) {
+    return x >= 0 && y >= 0 && x < a.hdr.width && y < a.hdr.height;
+}
+
+static uint32_t block_of(const Area& a, int x, int y) {
+    return uint32_t(y / int(BLOCK_TILES)) * a.hdr.block_cols + uint32_t(x / int(BLOCK_TILES));
+}
+
+static void build_area(Area& a, const uint8_t* ar) {
+    uint32_t objects = count_at(ar, AREA_OBJECT_COUNT, MAX_OBJECTS);
+    uint32_t ground  = count_at(ar, AREA_GROUND_COUNT, MAX_GROUND);
+    uint32_t pipes   = count_at(ar, AREA_PIPE_COUNT, MAX_PIPES);
+    uint32_t tracks  = count_at(ar, AREA_TRACK_COUNT, MAX_TRACKS);
+
+    // Grid size from the data itself
+    Extent ext;
+    for (uint32_t i = 0; i < ground; i++) {
+        const uint8_t* g = ar + GROUND_OFFSET + i * 4;
+        ext.add(g[0], g[1]);
+    }
+    for (uint32_t i = 0; i < objects; i++) {
+        const uint8_t* o = ar + OBJECTS_OFFSET + i * 0x20;
+        uint8_t w = o[0x0A] ? o[0x0A] : 1, h = o[0x0B] ? o[0x0B] : 1;
+        ext.add(obj_origin(load<int32_t>(o + 0x00), w) + w - 1,
+                obj_origin(load<int32_t>(o + 0x04), h) + h - 1);
+    }
+    for (uint32_t i = 0; i < tracks; i++) {
+        const uint8_t* t = ar + TRACKS_OFFSET + i * TRACK_SIZE;
+        ext.add(t[3], t[4]);
+    }
+
+    std::memset(&a.hdr, 0, sizeof(a.hdr));
+    int w = ext.w < int(MAX_W) ? ext.w : int(MAX_W);
+    int h = ext.h < int(MAX_H) ? ext.h : int(MAX_H);
+    if (w > 0 && h > int(MAX_CELLS) / w) h = int(MAX_CELLS) / w;
+    a.hdr.width = uint16_t(w);
+    a.hdr.height = uint16_t(h);
+    a.hdr.block_cols = uint16_t((w + BLOCK_TILES - 1) / BLOCK_TILES);
+    a.hdr.block_rows = uint16_t((h + BLOCK_TILES - 1) / BLOCK_TILES);
+    a.hdr.theme = ar[AREA_THEME];
+    a.hdr.orientation = ar[AREA_ORIENTATION];
+    a.hdr.ground_count = uint16_t(ground);
+    a.hdr.track_count = uint16_t(tracks);
+    std::memset(a.cells, 0, size_t(w) * h);
+
+    uint32_t dropped = 0;
+    for (uint32_t i = 0; i < ground; i++) {
+        const uint8_t* g = ar + GROUND_OFFSET + i * 4;
+        if (!in_grid(a, g[0], g[1])) { dropped++; continue; }
+        a.cells[g[1] * w + g[0]] |= CELL_GROUND;
+    }
+    for (uint32_t i = 0; i < tracks; i++) {
+        const uint8_t* t = ar + TRACKS_OFFSET + i * TRACK_SIZE;
+        if (!in_grid(a, t[3], t[4])) { dropped++; continue; }
+        a.cells[t[4] * w + t[3]] |= CELL_TRACK;
+    }
+    uint32_t pipe_nodes = 0;
+    for (uint32_t i = 0; i < pipes; i++) {
+        const uint8_t* p = ar + PIPES_OFFSET + i * PIPE_SIZE;
+        uint32_t nodes = p[1] < PIPE_NODES ? p[1] : PIPE_NODES;
+        for (uint32_t n = 0; n < nodes; n++) {
+            const uint8_t* nd = p + 4 + n * 8;   // type, index, x, y, w, h, _, dir
+            mark(a, nd[2], nd[3], nd[4] ? nd[4] : 1, nd[5] ? nd[5] : 1, CELL_PIPE);
+        }
+        pipe_nodes += nodes;
+    }
+    a.hdr.pipe_node_count = uint16_t(pipe_nodes);
+
+    // Objects: count per block, prefix sum, then place (counting sort)
+    uint32_t blocks = uint32_t(a.hdr.block_cols) * a.hdr.block_rows;
+    std::memset(a.block_start, 0, (blocks + 1) * sizeof(a.block_start[0]));
+    for (uint32_t i = 0; i < objects; i++) {
+        const uint8_t* o = ar + OBJECTS_OFFSET + i * 0x20;
+        uint8_t ow = o[0x0A] ? o[0x0A] : 1, oh = o[0x0B] ? o[0x0B] : 1;
+        int x = obj_origin(load<int32_t>(o + 0x00), ow);
+        int y = obj_origin(load<int32_t>(o + 0x04), oh);
+        mark(a, x, y, ow, oh, CELL_OBJECT);
+        if (in_grid(a, x, y)) a.block_start[block_of(a, x, y) + 1]++;
+    }
+    for (uint32_t b = 0; b < blocks; b++)
+        a.block_start[b + 1] += a.block_start[b];
+
+    static uint16_t fill[MAX_BLOCKS];
+    std::memcpy(fill, a.block_start, blocks * sizeof(fill[0]));
+    for (uint32_t i = 0; i < objects; i++) {
+        const uint8_t* o = ar + OBJECTS_OFFSET + i * 0x20;
+        uint8_t ow = o[0x0A] ? o[0x0A] : 1, oh = o[0x0B] ? o[0x0B] : 1;
+        int x = obj_origin(load<int32_t>(o + 0x00), ow);
+        int y = obj_origin(load<int32_t>(o + 0x04), oh);
+        if (!in_grid(a, x, y)) { dropped++; continue; }
+        MapObject& m = a.objects[fill[block_of(a, x, y)]++];
+        m.type = load<uint16_t>(o + 0x18);
+        m.x = uint8_t(x);
+        m.y = uint8_t(y);
+        m.w = ow;
+        m.h = oh;
+        m.slot = uint16_t(i);
+    }
+    a.hdr.object_count = blocks ? a.block_start[blocks] : 0;
+    a.hdr.dropped = uint16_t(dropped);
+}
+
+// Runs inside the WriteFile hook, so these writes re-enter it —
+// harmless, they are nowhere near BCD-sized.
+static void export_map() {
+    char path[paths::MAX_PATH];
+    paths::make(path, sizeof(path), "course_map.bin");
+
+    uint32_t off = sizeof(MapHeader) + AREA_COUNT * sizeof(MapAreaHeader);
+    for (Area& a : s_areas) {
+        uint32_t blocks = uint32_t(a.hdr.block_cols) * a.hdr.block_rows;
+        a.hdr.cells_offset = off;
+        off += align4(uint32_t(a.hdr.width) * a.hdr.height);
+        a.hdr.blocks_offset = off;
+        off += align4((blocks + 1) * sizeof(uint16_t));
+        a.hdr.objects_offset = off;
+        off += a.hdr.object_count * sizeof(MapObject);
+    }
+    uint32_t file_size = off;
+
+    nn::fs::DeleteFile(path);
+    nn::fs::CreateFile(path, file_size);
+    nn::fs::FileHandle f;
+    if (nn::fs::OpenFile(&f, path, nn::fs::MODE_WRITE) != 0) return;
+
+    MapHeader hdr = {};
+    std::memcpy(hdr.magic, MAP_MAGIC, sizeof(hdr.magic));
+    hdr.version = MAP_VERSION;
+    hdr.area_count = AREA_COUNT;
+    hdr.generation = s_generation;
+    hdr.block_tiles = BLOCK_TILES;
+
+    static const uint8_t s_zero[4] = {};
+    off = 0;
+    write_at(f, off, &hdr, sizeof(hdr));
+    for (const Area& a : s_areas)
+        write_at(f, off, &a.hdr, sizeof(a.hdr));
+    for (const Area& a : s_areas) {
+        uint32_t cells = uint32_t(a.hdr.width) * a.hdr.height;
+        uint32_t starts = (uint32_t(a.hdr.block_cols) * a.hdr.block_rows + 1) * sizeof(uint16_t);
+        write_at(f, off, a.cells, cells);
+        write_at(f, off, s_zero, align4(cells) - cells);
+        write_at(f, off, a.block_start, starts);
+        write_at(f, off, s_zero, align4(starts) - starts);
+        write_at(f, off, a.objects, a.hdr.object_count * sizeof(MapObject));
+    }
+    nn::fs::FlushFile(f);
+    nn::fs::CloseFile(f);
+}
+
+void build(const uint8_t* bcd, size_t size) {
+    if (size < BCD_SIZE) return;
+
+    s_seq.fetch_add(1, std::memory_order_acq_rel);   // odd
+    for (uint32_t i = 0; i < AREA_COUNT; i++)
+        build_area(s_areas[i], bcd + BCD_AREA_OFFSET + i * BCD_AREA_SIZE);
+    s_generation++;
+    s_seq.fetch_add(1, std::memory_order_release);   // even
+
+    export_map();
+}
+
+uint32_t generation() {
+    return s_generation;
+}
+
+uint8_t cell(uint32_t area, int tx, int ty) {
+    if (area >= AREA_COUNT) return 0;
+    const Area& a = s_areas[area];
+    return in_grid(a, tx, ty) ? a.cells[ty * a.hdr.width + tx] : 0;
+}
+
+uint32_t near(uint32_t area, int tx, int ty, uint32_t radius, MapObject* out, uint32_t max) {
+    if (area >= AREA_COUNT) return 0;
+    uint32_t seq = s_seq.load(std::memory_order_acquire);
+    if (seq & 1) return 0;
+
+    const Area& a = s_areas[area];
+    int r = int(radius);
+    int bx0 = (tx - r) / int(BLOCK_TILES), bx1 = (tx + r) / int(BLOCK_TILES);
+    int by0 = (ty - r) / int(BLOCK_TILES), by1 = (ty + r) / int(BLOCK_TILES);
+    if (bx0 < 0) bx0 = 0;
+    if (by0 < 0) by0 = 0;
+    if (bx1 >= a.hdr.block_cols) bx1 = a.hdr.block_cols - 1;
+    if (by1 >= a.hdr.block_rows) by1 = a.hdr.block_rows - 1;
+
+    uint32_t n = 0;
+    for (int by = by0; by <= by1; by++) {
+        for (int bx = bx0; bx <= bx1; bx++) {
+            uint32_t b = uint32_t(by) * a.hdr.block_cols + uint32_t(bx);
+            for (uint32_t i = a.block_start[b]; i < a.block_start[b + 1] && n < max; i++) {
+                const MapObject& m = a.objects[i];
+                int dx = m.x - tx, dy = m.y - ty;
+                if (dx >= -r && dx <= r && dy >= -r && dy <= r) out[n++] = m;
+            }
+        }
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return s_seq.load(std::memory_order_relaxed) == seq ? n : 0;
+}
+
+} // namespace course_map
+} // namespace smm2
@@ -0,0 +1,91 @@
+#include "smm2/events.h"
+#include "smm2/status.h"
+
+namespace smm2 {
+namespace events {
+
+struct Subscriber {
+    uint32_t mask;
+    handler_t fn;
+};
+
+static Subscriber s_subs[MAX_SUBSCRIBERS];
+static uint32_t s_sub_count = 0;
+
+static Event s_ring[EVENT_SLOTS];
+static uint32_t s_written = 0;
+static uint32_t s_scene_changes = 0;
+
+// Previous update's inputs; the first update only primes them
+static bool s_primed = false;
+static Inputs s_prev = {};
+
+void subscribe(uint32_t mask, handler_t fn) {
+    if (s_sub_count < MAX_SUBSCRIBERS) s_subs[s_sub_count++] = {mask, fn};
+}
+
+static void emit(uint32_t frame, Kind kind, int32_t from, int32_t to) {
+    Event& e = s_ring[s_written % EVENT_SLOTS];
+    e = {};
+    e.index = s_written;
+    e.frame = frame;
+    e.kind = uint8_t(kind);
+    e.from = from;
+    e.to = to;
+    s_written++;
+    if (kind == Kind::SceneChange) s_scene_changes++;
+
+    for (uint32_t i = 0; i < s_sub_count; i++)
+        if (s_subs[i].mask & bit(kind)) s_subs[i].fn(e);
+}
+
+void update(const Inputs& in) {
+    if (!s_primed) {
+        s_prev = in;
+        s_primed = true;
+        return;
+    }
+
+    if (in.phase != s_prev.phase)
+        emit(in.frame, Kind::PhaseChange, s_prev.phase, in.phase);
+
+    if (in.scene_mode != s_prev.scene_mode) {
+        emit(in.frame, Kind::SceneChange, int32_t(s_prev.scene_mode), int32_t(in.scene_mode));
+        if (in.scene_mode == SCENE_LOADING)
+            emit(in.frame, Kind::LoadBegin, int32_t(s_prev.scene_mode), int32_t(in.scene_mode));
+        else if (s_prev.scene_mode == SCENE_LOADING)
+            emit(in.frame, Kind::LoadEnd, int32_t(s_prev.scene_mode), int32_t(in.scene_mode));
+    }
+
+    // A different PlayerObject (course restart) is a despawn + spawn
+    if (s_prev.player && in.player != s_prev.player)
+        emit(in.frame, Kind::PlayerDespawn, int32_t(s_prev.player_state), 0);
+    if (in.player && in.player != s_prev.player)
+        emit(in.frame, Kind::PlayerSpawn, 0, int32_t(in.player_state));
+
+    if (in.player && in.player == s_prev.player && in.player_state != s_prev.player_state) {
+        if (status::is_goal_state(in.player_state) && !status::is_goal_state(s_prev.player_state))
+            emit(in.frame, Kind::Goal, int32_t(s_prev.player_state), int32_t(in.player_state));
+        if (status::is_death_state(in.player_state) && !status::is_death_state(s_prev.player_state))
+            emit(in.frame, Kind::Death, int32_t(s_prev.player_state), int32_t(in.player_state));
+    }
+
+    s_prev = in;
+}
+
+uint32_t written() {
+    return s_written;
+}
+
+bool get(uint32_t index, Event& out) {
+    if (index >= s_written || s_written - index > EVENT_SLOTS) return false;
+    out = s_ring[index % EVENT_SLOTS];
+    return true;
+}
+
+uint32_t scene_changes() {
+    return s_scene_changes;
+}
+
+} // namespace events
+} // namespace smm2
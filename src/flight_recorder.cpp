@@ -0,0 +1,205 @@
+#include "smm2/flight_recorder.h"
+#include "smm2/cfg.h"
+#include "smm2/paths.h"
+#include "smm2/log.h"
+#include "nn/fs.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace smm2 {
+namespace flight_recorder {
+
+// ============================================================
+// State machine, advanced once per status::update():
+//
+//   Recording — append to both rings, watch for trigger edges
+//   Armed     — trigger fired, keep recording post_frames more
+//   Dumping   — rings frozen, write DUMP_BLOCKS_PER_FRAME /
+//               DUMP_TRACES_PER_FRAME items per frame, then back
+//               to Recording
+// ============================================================
+
+// Each frame's dump step fits one Logger buffer (40 × 200 B / 40 × 192 B)
+constexpr uint32_t DUMP_BLOCKS_PER_FRAME = 40;
+constexpr uint32_t DUMP_TRACES_PER_FRAME = 40;
+
+enum class Phase : uint8_t {
+    Recording,
+    Armed,
+    Dumping,
+};
+
+static bool s_enabled = false;
+static Config s_cfg = DEFAULT_CONFIG;
+static Phase s_phase = Phase::Recording;
+
+static status::StatusBlock s_blocks[HISTORY_FRAMES];
+static uint32_t s_block_count = 0;       // total ever recorded
+static func_trace::TraceRecord s_traces[HISTORY_TRACES];
+
+static_assert(DUMP_BLOCKS_PER_FRAME * sizeof(status::StatusBlock) <= log::BUFFER_SIZE,
+              "a dump step's blocks must fit one Logger buffer");
+static_assert(DUMP_TRACES_PER_FRAME * sizeof(func_trace::TraceRecord) <= log::BUFFER_SIZE,
+              "a dump step's traces must fit one Logger buffer");
+static uint32_t s_trace_count = 0;
+
+static uint8_t s_prev_dead = 0;
+static uint8_t s_prev_goal = 0;
+static bool s_manual = false;
+
+static uint32_t s_reason = 0;
+static uint32_t s_trigger_frame = 0;
+static uint32_t s_post_left = 0;
+
+// Current dump window, as absolute ring indices
+static uint32_t s_dump_block = 0;
+static uint32_t s_dump_block_end = 0;
+static uint32_t s_dump_trace = 0;
+static uint32_t s_dump_trace_end = 0;
+static uint32_t s_dump_seq = 0;
+static log::Logger s_dump;
+
+// False without flight.cfg — the recorder stays off
+static bool load_config() {
+    return cfg::read("flight.cfg", [](char* line) {
+        if (std::strncmp(line, "triggers=", 9) == 0) {
+            const char* v = line + 9;
+            s_cfg.triggers = 0;
+            if (std::strstr(v, "death"))  s_cfg.triggers |= TRIGGER_DEATH;
+            if (std::strstr(v, "goal"))   s_cfg.triggers |= TRIGGER_GOAL;
+            if (std::strstr(v, "manual")) s_cfg.triggers |= TRIGGER_MANUAL;
+        } else if (std::strncmp(line, "pre=", 4) == 0) {
+            s_cfg.pre_frames = (uint32_t)std::strtoul(line + 4, nullptr, 10);
+        } else if (std::strncmp(line, "post=", 5) == 0) {
+            s_cfg.post_frames = (uint32_t)std::strtoul(line + 5, nullptr, 10);
+        } else if (std::strncmp(line, "stream=", 7) == 0) {
+            s_cfg.stream = line[7] == '1';
+        }
+    });
+}
+
+static void arm(uint32_t reason, uint32_t frame) {
+    if (!(s_cfg.triggers & reason)) return;
+    s_reason = reason;
+    s_trigger_frame = frame;
+    s_post_left = s_cfg.post_frames;
+    s_phase = Phase::Armed;
+}
+
+static void begin_dump() {
+    uint32_t window = s_cfg.pre_frames + s_cfg.post_frames + 1;
+    uint32_t held = s_block_count < HISTORY_FRAMES ? s_block_count : HISTORY_FRAMES;
+    if (window > held) window = held;
+    s_dump_block_end = s_block_count;
+    s_dump_block = s_block_count - window;
+
+    // Traces inside [first block frame, last block frame]
+    uint32_t first_frame = s_blocks[s_dump_block % HISTORY_FRAMES].frame;
+    uint32_t oldest = s_trace_count > HISTORY_TRACES ? s_trace_count - HISTORY_TRACES : 0;
+    s_dump_trace_end = s_trace_count;
+    s_dump_trace = s_trace_count;
+    while (s_dump_trace > oldest && s_traces[(s_dump_trace - 1) % HISTORY_TRACES].frame >= first_frame)
+        s_dump_trace--;
+    bool truncated = s_dump_trace == oldest && oldest > 0;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "flight_%03u.bin", s_dump_seq++);
+    s_dump.init(name, log::Mode::Async);
+
+    DumpHeader hdr = {};
+    std::memcpy(hdr.magic, DUMP_MAGIC, sizeof(hdr.magic));
+    hdr.version = DUMP_VERSION;
+    hdr.header_size = sizeof(DumpHeader);
+    hdr.reason = s_reason;
+    hdr.trigger_frame = s_trigger_frame;
+    hdr.status_count = s_dump_block_end - s_dump_block;
+    hdr.trace_count = s_dump_trace_end - s_dump_trace;
+    hdr.block_size = sizeof(status::StatusBlock);
+    hdr.record_size = sizeof(func_trace::TraceRecord);
+    hdr.pre_frames = s_cfg.pre_frames;
+    hdr.post_frames = s_cfg.post_frames;
+    hdr.trace_truncated = truncated ? 1 : 0;
+    s_dump.begin_preamble();
+    s_dump.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    s_dump.end_preamble();
+
+    s_phase = Phase::Dumping;
+}
+
+// Write one frame's worth of the dump. Returns true when finished.
+static bool dump_step() {
+    for (uint32_t n = 0; n < DUMP_BLOCKS_PER_FRAME && s_dump_block < s_dump_block_end; n++) {
+        const auto& blk = s_blocks[s_dump_block++ % HISTORY_FRAMES];
+        s_dump.write(reinterpret_cast<const char*>(&blk), sizeof(blk));
+    }
+    if (s_dump_block < s_dump_block_end) return false;
+
+    for (uint32_t n = 0; n < DUMP_TRACES_PER_FRAME && s_dump_trace < s_dump_trace_end; n++) {
+        const auto& rec = s_traces[s_dump_trace++ % HISTORY_TRACES];
+        s_dump.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+    }
+    if (s_dump_trace < s_dump_trace_end) return false;
+
+    s_dump.flush();
+    return true;
+}
+
+void init(const Config& cfg) {
+    s_cfg = cfg;
+    if (!load_config()) return;
+    // The window (pre + trigger + post) must fit the ring: post first, pre
+    // gets what's left
+    if (s_cfg.post_frames > HISTORY_FRAMES - 1) s_cfg.post_frames = HISTORY_FRAMES - 1;
+    if (s_cfg.pre_frames > HISTORY_FRAMES - 1 - s_cfg.post_frames)
+        s_cfg.pre_frames = HISTORY_FRAMES - 1 - s_cfg.post_frames;
+    s_enabled = true;
+}
+
+bool enabled() {
+    return s_enabled;
+}
+
+bool stream_traces() {
+    return !s_enabled || s_cfg.stream;
+}
+
+void record_status(const status::StatusBlock& blk) {
+    if (!s_enabled) return;
+
+    if (s_phase == Phase::Dumping) {
+        if (dump_step()) s_phase = Phase::Recording;
+        return;
+    }
+
+    s_blocks[s_block_count++ % HISTORY_FRAMES] = blk;
+
+    if (s_phase == Phase::Recording) {
+        if (blk.has_player && blk.is_dead && !s_prev_dead)
+            arm(TRIGGER_DEATH, blk.frame);
+        else if (blk.has_player && blk.is_goal && !s_prev_goal)
+            arm(TRIGGER_GOAL, blk.frame);
+        else if (s_manual)
+            arm(TRIGGER_MANUAL, blk.frame);
+    } else if (s_post_left > 0) {
+        s_post_left--;
+    } else {
+        begin_dump();
+    }
+    s_manual = false;
+    s_prev_dead = blk.is_dead;
+    s_prev_goal = blk.is_goal;
+}
+
+void record_trace(const func_trace::TraceRecord& rec) {
+    if (!s_enabled || s_phase == Phase::Dumping) return;
+    s_traces[s_trace_count++ % HISTORY_TRACES] = rec;
+}
+
+void trigger() {
+    s_manual = true;
+}
+
+} // namespace flight_recorder
+} // namespace smm2
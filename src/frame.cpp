@@ -1,6 +1,15 @@
 #include "smm2/frame.h"
+#include "smm2/log.h"
+#include "smm2/paths.h"
+#include "smm2/perf.h"
+#include "smm2/ticks.h"
+#include "nn/fs.h"
+#include "nn/os.h"
 #include "hk/hook/Trampoline.h"
 
+#include <atomic>
+#include <cstring>
+
 namespace smm2 {
 namespace frame {
 
@@ -8,16 +17,128 @@ static uint32_t s_frame = 0;
 static callback_t s_cb = nullptr;
 static uintptr_t s_scene = 0;
 
+// --- Timing ---
+static FrameTiming s_timing = {};
+static uint64_t s_prev_start = 0;
+static uint64_t s_gate_ticks = 0;       // time the last frame spent blocked in step_gate
+static uint32_t s_window_peak = 0;
+static uint32_t s_hist_interval[TIMING_BUCKETS];
+static uint32_t s_hist_orig[TIMING_BUCKETS];
+static uint32_t s_hist_callback[TIMING_BUCKETS];
+static log::Logger s_timing_log;
+static bool s_timing_log_open = false;
+
+// --- Lockstep ---
+static nn::fs::FileHandle s_step_file;
+static bool s_step_open = false;
+static StepControl s_step = {};
+static std::atomic<bool> s_gated{false};
+
+static void open_step() {
+    char path[paths::MAX_PATH];
+    paths::make(path, sizeof(path), "step.bin");
+    if (nn::fs::OpenFile(&s_step_file, path, nn::fs::MODE_READ) != 0) {
+        // Disabled control block, so the host can rewrite it in place
+        nn::fs::CreateFile(path, sizeof(StepControl));
+        StepControl ctl = {};
+        std::memcpy(ctl.magic, STEP_MAGIC, sizeof(ctl.magic));
+        nn::fs::FileHandle f;
+        if (nn::fs::OpenFile(&f, path, nn::fs::MODE_WRITE) == 0) {
+            nn::fs::WriteFile(f, 0, &ctl, sizeof(ctl), {nn::fs::WRITE_OPTION_FLUSH});
+            nn::fs::CloseFile(f);
+        }
+        if (nn::fs::OpenFile(&s_step_file, path, nn::fs::MODE_READ) != 0)
+            return;
+    }
+    s_step_open = true;
+}
+
+static void read_step() {
+    StepControl ctl;
+    size_t bytes_read = 0;
+    nn::fs::ReadFile(&bytes_read, s_step_file, 0, &ctl, sizeof(ctl));
+    if (bytes_read == sizeof(ctl) && std::memcmp(ctl.magic, STEP_MAGIC, sizeof(ctl.magic)) == 0)
+        s_step = ctl;
+}
+
+// Called after frame f's callback; returns once the host lets f complete
+static void step_gate(uint32_t f) {
+    if (!s_step.enabled && f % STEP_POLL_FRAMES != 0) return;
+    read_step();
+
+    uint64_t waited_us = 0;
+    s_gated.store(true, std::memory_order_relaxed);
+    while (s_step.enabled && f >= s_step.run_until) {
+        if (s_step.timeout_ms != 0 && waited_us >= uint64_t(s_step.timeout_ms) * 1000) break;
+        nn::os::SleepThread(nn::TimeSpan::FromMicroSeconds(STEP_POLL_US));
+        waited_us += STEP_POLL_US;
+        read_step();
+    }
+    s_gated.store(false, std::memory_order_relaxed);
+}
+
+bool gated() {
+    return s_gated.load(std::memory_order_relaxed);
+}
+
+static uint32_t bucket(uint32_t us) {
+    uint32_t b = us / 1000;
+    return b < TIMING_BUCKETS ? b : TIMING_BUCKETS - 1;
+}
+
+// Before the callback: this frame's interval and orig() time
+static void record_start(uint64_t start, uint64_t orig_end) {
+    s_timing.orig_us = ticks::to_us(orig_end - start);
+    s_hist_orig[bucket(s_timing.orig_us)]++;
+
+    if (s_prev_start != 0) {
+        uint64_t dt = start - s_prev_start;
+        dt = dt > s_gate_ticks ? dt - s_gate_ticks : 0;
+        uint32_t us = ticks::to_us(dt);
+        s_timing.interval_us = us;
+        s_hist_interval[bucket(us)]++;
+        if (us > FRAME_BUDGET_US) s_timing.over_1_frame++;
+        if (us > 2 * FRAME_BUDGET_US) {
+            s_timing.over_2_frames++;
+            s_timing.last_hitch_frame = s_frame;
+        }
+        if (us > s_window_peak) s_window_peak = us;
+    }
+    if (s_frame % TIMING_WINDOW == 0) {
+        s_timing.peak_interval_us = s_window_peak;
+        s_window_peak = 0;
+    }
+    s_prev_start = start;
+}
+
+// After the callback: published in the next frame's StatusBlock
+static void record_callback(uint64_t t) {
+    s_timing.callback_us = ticks::to_us(t);
+    s_hist_callback[bucket(s_timing.callback_us)]++;
+}
+
 static HkTrampoline<void, void*> procFrame_ =
     hk::hook::trampoline([](void* t) -> void {
+        // Timestamps only around orig() — no other work before it
+        uint64_t t0 = ticks::now();
         procFrame_.orig(t);
-        s_scene = reinterpret_cast<uintptr_t>(t);
-        if (s_cb) s_cb(s_frame);
+        uint64_t t1 = ticks::now();
+        {
+            PERF_SCOPE(frame_proc);
+            record_start(t0, t1);
+            s_scene = reinterpret_cast<uintptr_t>(t);
+            if (s_cb) s_cb(s_frame);
+        }
+        uint64_t t2 = ticks::now();
+        record_callback(t2 - t1);
+        if (s_step_open) step_gate(s_frame);
+        s_gate_ticks = ticks::now() - t2;
         s_frame++;
     });
 
 void init(callback_t cb) {
     s_cb = cb;
+    open_step();
     procFrame_.installAtSym<"procFrame_">();
 }
 
@@ -29,5 +150,26 @@ uintptr_t scene_object() {
     return s_scene;
 }
 
+const FrameTiming& timing() {
+    return s_timing;
+}
+
+// One row per non-empty bucket, counts cumulative since boot
+void flush() {
+    if (!s_timing_log_open) {
+        s_timing_log.init("frame_time.csv", log::Mode::Async);
+        s_timing_log.begin_preamble();
+        s_timing_log.write("frame,bucket_ms,interval,orig,callback\n", 39);
+        s_timing_log.end_preamble();
+        s_timing_log_open = true;
+    }
+    for (uint32_t b = 0; b < TIMING_BUCKETS; b++) {
+        if (!s_hist_interval[b] && !s_hist_orig[b] && !s_hist_callback[b]) continue;
+        s_timing_log.writef("%u,%u,%u,%u,%u\n", s_frame, b,
+            s_hist_interval[b], s_hist_orig[b], s_hist_callback[b]);
+    }
+    s_timing_log.flush();
+}
+
 } // namespace frame
 } // namespace smm2
@@ -1,6 +1,13 @@
 #include "smm2/func_trace.h"
+#include "smm2/cfg.h"
+#include "smm2/paths.h"
 #include "smm2/frame.h"
+#include "smm2/flight_recorder.h"
+#include "smm2/perf.h"
+#include "nn/fs.h"
 #include "hk/hook/Trampoline.h"
+#include <cstddef>
+#include <cstdlib>
 
 namespace smm2 {
 namespace func_trace {
@@ -18,157 +25,259 @@ static log::Logger trace_log;
 //   - Return value from original
 //   - Output PlayerObject fields after (delegates can modify state)
 //
-// Host-side test: read CSV, replay with our C++ reimplementation,
+// Host-side test: read trace.bin (or CSV), replay with our C++ reimplementation,
 // compare return values. Any mismatch = decomp bug.
 // ============================================================
 
+// ============================================================
+// Per-delegate filter, indexed by slot. Checked before any snapshot is
+// taken: want_call() on entry (enable, predicates, and sampling when it
+// can be decided up front), want_ret() once the return value is known.
+// ============================================================
+
+constexpr uint32_t MAX_SLOTS = 64;
+
+#define CHECK_SLOT(name, slot) static_assert(slot < MAX_SLOTS, #name " slot out of range");
+FUNC_TRACE_DELEGATES(CHECK_SLOT)
+#undef CHECK_SLOT
+
+constexpr uint8_t FILTER_ENABLED   = 1 << 0;
+constexpr uint8_t FILTER_ON_CHANGE = 1 << 1;
+
+struct Filter {
+    uint8_t flags;
+    uint8_t has_last;
+    uint16_t sample;      // keep 1 in N (1 = every call)
+    uint32_t count;       // candidate calls seen, for sampling
+    int32_t last_ret;
+};
+
+static Filter s_filter[MAX_SLOTS];
+static uint32_t s_state_mask[8];    // bit per cur_state 0-255
+static uint32_t s_powerup_mask;     // bit per powerup_id 0-31
+static bool s_state_pred = false;   // states= given; otherwise any state passes
+static bool s_powerup_pred = false; // powerups= given
+static bool s_reload = false;
+
+static bool sample_tick(Filter& f) {
+    return f.sample <= 1 || (f.count++ % f.sample) == 0;
+}
+
+static inline bool want_call(uint16_t slot, uintptr_t p) {
+    Filter& f = s_filter[slot];
+    if (!(f.flags & FILTER_ENABLED)) return false;
+
+    if (s_state_pred) {
+        uint32_t state = player::get<player::Field::cur_state>(p);
+        if (state >= 256 || !(s_state_mask[state >> 5] & (1u << (state & 31)))) return false;
+    }
+    if (s_powerup_pred) {
+        uint32_t powerup = player::get<player::Field::powerup_id>(p);
+        if (powerup >= 32 || !(s_powerup_mask & (1u << powerup))) return false;
+    }
+
+    // With on_change the sample applies to changed calls, so decide later
+    return (f.flags & FILTER_ON_CHANGE) || sample_tick(f);
+}
+
+static inline bool want_ret(uint16_t slot, int ret) {
+    Filter& f = s_filter[slot];
+    if (!(f.flags & FILTER_ON_CHANGE)) return true;
+    bool changed = !f.has_last || f.last_ret != ret;
+    f.has_last = 1;
+    f.last_ret = ret;
+    return changed && sample_tick(f);
+}
+
+// False when the flight recorder takes the records instead (flight.cfg stream=0)
+static bool s_stream = true;
+
+static void emit(uint16_t func_id, const char* name, int ret,
+                 const PlayerSnapshot& input, const PlayerSnapshot& output) {
+    if (FORMAT == Format::Binary || flight_recorder::enabled()) {
+        TraceRecord rec;
+        rec.frame = frame::current();
+        rec.func_id = func_id;
+        rec._pad = 0;
+        rec.ret = ret;
+        rec._pad2 = 0;
+        rec.in = input;
+        rec.out = output;
+        if (flight_recorder::enabled()) flight_recorder::record_trace(rec);
+        if (!s_stream) return;
+        if constexpr (FORMAT == Format::Binary) {
+            trace_log.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+            return;
+        }
+    }
+    if constexpr (FORMAT != Format::Binary) {
+        trace_log.writef("%u,%s,%d,", frame::current(), name, ret);
+        input.write_csv(trace_log);
+        trace_log.write(",", 1);
+        output.write_csv(trace_log);
+        trace_log.write("\n", 1);
+    }
+}
+
 // Helper: hook a delegate, capture input/output/return
-#define DEFINE_DELEGATE_HOOK(name)                                               \
+#define DEFINE_DELEGATE_HOOK(name, slot)                                         \
 static HkTrampoline<int, void*> name##_hook =                                   \
     hk::hook::trampoline([](void* player_obj) -> int {                          \
+        PERF_SCOPE(func_trace_delegate);                                         \
         auto p = reinterpret_cast<uintptr_t>(player_obj);                       \
+        if (!want_call(slot, p)) return PERF_ORIG(name##_hook.orig(player_obj)); \
         PlayerSnapshot input, output;                                            \
         input.capture(p);                                                        \
-        int ret = name##_hook.orig(player_obj);                                 \
-        output.capture(p);                                                       \
-        trace_log.writef("%u," #name ",%d,", frame::current(), ret);            \
-        input.write_csv(trace_log);                                              \
-        trace_log.write(",", 1);                                                 \
-        output.write_csv(trace_log);                                             \
-        trace_log.write("\n", 1);                                                \
+        int ret = PERF_ORIG(name##_hook.orig(player_obj));                      \
+        if (want_ret(slot, ret)) {                                               \
+            output.capture(p);                                                   \
+            emit(slot, #name, ret, input, output);                               \
+        }                                                                        \
         return ret;                                                              \
-    })
-
-// All delegate hooks EXCEPT ≤16B functions (trampoline can't fit)
-// Skipped (≤16B): None, Jump, BroadJump, WallClimb, ClimbRollingAttack, WallHitLand, ObjJumpDai
-// 47 hooks total, pool size 0x80 (128)
-DEFINE_DELEGATE_HOOK(delegate_Walk);
-DEFINE_DELEGATE_HOOK(delegate_Landing);
-DEFINE_DELEGATE_HOOK(delegate_Crouch);
-DEFINE_DELEGATE_HOOK(delegate_CrouchEnd);
-DEFINE_DELEGATE_HOOK(delegate_CrouchJump);
-DEFINE_DELEGATE_HOOK(delegate_CrouchJumpEnd);
-DEFINE_DELEGATE_HOOK(delegate_CrouchSwim);
-DEFINE_DELEGATE_HOOK(delegate_CrouchSwimEnd);
-DEFINE_DELEGATE_HOOK(delegate_CrouchSwimWalk);
-DEFINE_DELEGATE_HOOK(delegate_Rolling);
-DEFINE_DELEGATE_HOOK(delegate_BroadJumpLand);
-DEFINE_DELEGATE_HOOK(delegate_StartFall);
-DEFINE_DELEGATE_HOOK(delegate_WorldShortTurn);
-DEFINE_DELEGATE_HOOK(delegate_Turn);
-DEFINE_DELEGATE_HOOK(delegate_HipAttack);
-DEFINE_DELEGATE_HOOK(delegate_HipAttackEnd);
-DEFINE_DELEGATE_HOOK(delegate_Slip);
-DEFINE_DELEGATE_HOOK(delegate_RollSlip);
-DEFINE_DELEGATE_HOOK(delegate_WallSlide);
-DEFINE_DELEGATE_HOOK(delegate_WallJump);
-DEFINE_DELEGATE_HOOK(delegate_WallClimbSlide);
-DEFINE_DELEGATE_HOOK(delegate_WallClimbFall);
-DEFINE_DELEGATE_HOOK(delegate_WallClimbTopJump);
-DEFINE_DELEGATE_HOOK(delegate_WallClimbTopCrouchJump);
-DEFINE_DELEGATE_HOOK(delegate_ClimbAttack);
-DEFINE_DELEGATE_HOOK(delegate_ClimbAttackSwim);
-DEFINE_DELEGATE_HOOK(delegate_ClimbJumpAttack);
-DEFINE_DELEGATE_HOOK(delegate_ClimbSlidingAttack);
-DEFINE_DELEGATE_HOOK(delegate_ClimbBodyAttack);
-DEFINE_DELEGATE_HOOK(delegate_ClimbBodyAttackLand);
-DEFINE_DELEGATE_HOOK(delegate_WallHit);
-DEFINE_DELEGATE_HOOK(delegate_Drag);
-DEFINE_DELEGATE_HOOK(delegate_SideJumpDai);
-DEFINE_DELEGATE_HOOK(delegate_PlayerJumpDai);
-DEFINE_DELEGATE_HOOK(delegate_Swim);
-DEFINE_DELEGATE_HOOK(delegate_CrouchSwimJump);
-DEFINE_DELEGATE_HOOK(delegate_Fire);
-DEFINE_DELEGATE_HOOK(delegate_FireSwim);
-DEFINE_DELEGATE_HOOK(delegate_Throw);
-DEFINE_DELEGATE_HOOK(delegate_FrogWalk);
-DEFINE_DELEGATE_HOOK(delegate_FrogSwim);
-DEFINE_DELEGATE_HOOK(delegate_Flying);
-DEFINE_DELEGATE_HOOK(delegate_FlyingSlowFall);
-DEFINE_DELEGATE_HOOK(delegate_FlyingWallStick);
-DEFINE_DELEGATE_HOOK(delegate_LiftUp);
-DEFINE_DELEGATE_HOOK(delegate_LiftUpSnowBall);
-DEFINE_DELEGATE_HOOK(delegate_LiftUpCloud);
-DEFINE_DELEGATE_HOOK(delegate_LiftUpBomb);
-DEFINE_DELEGATE_HOOK(delegate_CarryPlayer);
+    });
+
+FUNC_TRACE_DELEGATES(DEFINE_DELEGATE_HOOK)
+
+#define TRACE_FUNC(name, slot) {slot, #name},
+static const TraceFuncDesc s_funcs[] = {
+    FUNC_TRACE_DELEGATES(TRACE_FUNC)
+};
+
+constexpr uint16_t FIELD_COUNT = PlayerSnapshot::COUNT;
+constexpr uint16_t FUNC_COUNT = sizeof(s_funcs) / sizeof(s_funcs[0]);
+
+// Slot for a config name ("Walk" or "delegate_Walk"), -1 if unknown
+static int find_slot(const char* name, size_t len) {
+    constexpr size_t PREFIX = sizeof("delegate_") - 1;
+    for (const auto& fn : s_funcs) {
+        const char* n = fn.name;
+        if (len < PREFIX || std::strncmp(name, "delegate_", PREFIX) != 0) n += PREFIX;
+        if (std::strlen(n) == len && std::strncmp(n, name, len) == 0) return fn.id;
+    }
+    return -1;
+}
+
+// Apply flag_set/flag_clear to every delegate named in list ("all" = every one)
+static void apply_flags(const char* list, uint8_t set, uint8_t clear) {
+    cfg::for_each_token(list, [&](const char* tok, size_t len) {
+        if (len == 3 && std::strncmp(tok, "all", 3) == 0) {
+            for (const auto& fn : s_funcs)
+                s_filter[fn.id].flags = uint8_t((s_filter[fn.id].flags | set) & ~clear);
+            return;
+        }
+        int slot = find_slot(tok, len);
+        if (slot >= 0) s_filter[slot].flags = uint8_t((s_filter[slot].flags | set) & ~clear);
+    });
+}
+
+static void load_config() {
+    // Defaults: every delegate on, no sampling, no predicates
+    for (const auto& fn : s_funcs) {
+        s_filter[fn.id].flags = FILTER_ENABLED;
+        s_filter[fn.id].sample = 1;
+    }
+    s_state_pred = false;
+    s_powerup_pred = false;
+    s_reload = false;
+
+    cfg::read("func_trace.cfg", [](char* line) {
+        if (std::strncmp(line, "enable=", 7) == 0) {
+            apply_flags("all", 0, FILTER_ENABLED);
+            apply_flags(line + 7, FILTER_ENABLED, 0);
+        } else if (std::strncmp(line, "disable=", 8) == 0) {
+            apply_flags(line + 8, 0, FILTER_ENABLED);
+        } else if (std::strncmp(line, "on_change=", 10) == 0) {
+            apply_flags(line + 10, FILTER_ON_CHANGE, 0);
+        } else if (std::strncmp(line, "sample=", 7) == 0) {
+            uint16_t n = (uint16_t)std::strtoul(line + 7, nullptr, 10);
+            for (const auto& fn : s_funcs) s_filter[fn.id].sample = n ? n : 1;
+        } else if (std::strncmp(line, "sample.", 7) == 0) {
+            char* eq = std::strchr(line, '=');
+            int slot = eq ? find_slot(line + 7, size_t(eq - (line + 7))) : -1;
+            if (slot >= 0) {
+                uint16_t n = (uint16_t)std::strtoul(eq + 1, nullptr, 10);
+                s_filter[slot].sample = n ? n : 1;
+            }
+        } else if (std::strncmp(line, "states=", 7) == 0) {
+            for (auto& m : s_state_mask) m = 0;
+            s_state_pred = true;
+            cfg::for_each_token(line + 7, [](const char* tok, size_t) {
+                uint32_t v = (uint32_t)std::strtoul(tok, nullptr, 10);
+                if (v < 256) s_state_mask[v >> 5] |= 1u << (v & 31);
+            });
+        } else if (std::strncmp(line, "powerups=", 9) == 0) {
+            s_powerup_mask = 0;
+            s_powerup_pred = true;
+            cfg::for_each_token(line + 9, [](const char* tok, size_t) {
+                uint32_t v = (uint32_t)std::strtoul(tok, nullptr, 10);
+                if (v < 32) s_powerup_mask |= 1u << v;
+            });
+        } else if (std::strncmp(line, "reload=", 7) == 0) {
+            s_reload = line[7] == '1';
+        }
+    });
+}
+
+static void write_bin_header() {
+    TraceFieldDesc fields[FIELD_COUNT];
+    PlayerSnapshot::describe(fields);
+
+    TraceHeader hdr = {};
+    std::memcpy(hdr.magic, TRACE_MAGIC, sizeof(hdr.magic));
+    hdr.version = TRACE_VERSION;
+    hdr.header_size = sizeof(TraceHeader) + sizeof(fields) + sizeof(s_funcs);
+    hdr.record_size = sizeof(TraceRecord);
+    hdr.snapshot_size = sizeof(PlayerSnapshot);
+    hdr.in_offset = offsetof(TraceRecord, in);
+    hdr.out_offset = offsetof(TraceRecord, out);
+    hdr.field_count = FIELD_COUNT;
+    hdr.func_count = FUNC_COUNT;
+    static_assert(sizeof(hdr) + sizeof(fields) + sizeof(s_funcs) <= log::PREAMBLE_MAX,
+                  "trace.bin header must fit a segment preamble");
+    trace_log.begin_preamble();
+    trace_log.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    trace_log.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+    trace_log.write(reinterpret_cast<const char*>(s_funcs), sizeof(s_funcs));
+    trace_log.end_preamble();
+}
+
+static void write_csv_header() {
+    trace_log.begin_preamble();
+    trace_log.write("frame,func,return,", 18);
+    PlayerSnapshot::write_csv_header(trace_log, "in_");
+    trace_log.write(",", 1);
+    PlayerSnapshot::write_csv_header(trace_log, "out_");
+    trace_log.write("\n", 1);
+    trace_log.end_preamble();
+}
 
 void init() {
-    trace_log.init("trace.csv");
-
-    // Write header
-    trace_log.write("frame,func,return,"
-        "in_pos_x,in_pos_y,in_pos_z,in_vel_x,in_vel_y,"
-        "in_cur_state,in_state_frames,in_powerup_id,in_facing,"
-        "in_target_speed,in_gravity,in_friction,in_accel,"
-        "in_in_water,in_style_features,in_game_style_flags,"
-        "in_field_490,in_field_484,in_field_488,in_buffered_action,"
-        "in_carried_object,in_frame_counter,"
-        "out_pos_x,out_pos_y,out_pos_z,out_vel_x,out_vel_y,"
-        "out_cur_state,out_state_frames,out_powerup_id,out_facing,"
-        "out_target_speed,out_gravity,out_friction,out_accel,"
-        "out_in_water,out_style_features,out_game_style_flags,"
-        "out_field_490,out_field_484,out_field_488,out_buffered_action,"
-        "out_carried_object,out_frame_counter\n", 660);
-
-    // Install 49 delegate hooks (skipping 7 that are ≤16B)
-    delegate_Walk_hook.installAtSym<"delegate_Walk">();
-    delegate_Landing_hook.installAtSym<"delegate_Landing">();
-    delegate_Crouch_hook.installAtSym<"delegate_Crouch">();
-    delegate_CrouchEnd_hook.installAtSym<"delegate_CrouchEnd">();
-    delegate_CrouchJump_hook.installAtSym<"delegate_CrouchJump">();
-    delegate_CrouchJumpEnd_hook.installAtSym<"delegate_CrouchJumpEnd">();
-    delegate_CrouchSwim_hook.installAtSym<"delegate_CrouchSwim">();
-    delegate_CrouchSwimEnd_hook.installAtSym<"delegate_CrouchSwimEnd">();
-    delegate_CrouchSwimWalk_hook.installAtSym<"delegate_CrouchSwimWalk">();
-    delegate_Rolling_hook.installAtSym<"delegate_Rolling">();
-    // skip BroadJump (16B)
-    delegate_BroadJumpLand_hook.installAtSym<"delegate_BroadJumpLand">();
-    delegate_StartFall_hook.installAtSym<"delegate_StartFall">();
-    delegate_WorldShortTurn_hook.installAtSym<"delegate_WorldShortTurn">();
-    delegate_Turn_hook.installAtSym<"delegate_Turn">();
-    delegate_HipAttack_hook.installAtSym<"delegate_HipAttack">();
-    delegate_HipAttackEnd_hook.installAtSym<"delegate_HipAttackEnd">();
-    delegate_Slip_hook.installAtSym<"delegate_Slip">();
-    delegate_RollSlip_hook.installAtSym<"delegate_RollSlip">();
-    delegate_WallSlide_hook.installAtSym<"delegate_WallSlide">();
-    delegate_WallJump_hook.installAtSym<"delegate_WallJump">();
-    // skip WallClimb (16B)
-    delegate_WallClimbSlide_hook.installAtSym<"delegate_WallClimbSlide">();
-    delegate_WallClimbFall_hook.installAtSym<"delegate_WallClimbFall">();
-    delegate_WallClimbTopJump_hook.installAtSym<"delegate_WallClimbTopJump">();
-    delegate_WallClimbTopCrouchJump_hook.installAtSym<"delegate_WallClimbTopCrouchJump">();
-    delegate_ClimbAttack_hook.installAtSym<"delegate_ClimbAttack">();
-    delegate_ClimbAttackSwim_hook.installAtSym<"delegate_ClimbAttackSwim">();
-    delegate_ClimbJumpAttack_hook.installAtSym<"delegate_ClimbJumpAttack">();
-    delegate_ClimbSlidingAttack_hook.installAtSym<"delegate_ClimbSlidingAttack">();
-    // skip ClimbRollingAttack (16B)
-    delegate_ClimbBodyAttack_hook.installAtSym<"delegate_ClimbBodyAttack">();
-    delegate_ClimbBodyAttackLand_hook.installAtSym<"delegate_ClimbBodyAttackLand">();
-    delegate_WallHit_hook.installAtSym<"delegate_WallHit">();
-    // skip WallHitLand (16B)
-    delegate_Drag_hook.installAtSym<"delegate_Drag">();
-    // skip ObjJumpDai (16B)
-    delegate_SideJumpDai_hook.installAtSym<"delegate_SideJumpDai">();
-    delegate_PlayerJumpDai_hook.installAtSym<"delegate_PlayerJumpDai">();
-    delegate_Swim_hook.installAtSym<"delegate_Swim">();
-    delegate_CrouchSwimJump_hook.installAtSym<"delegate_CrouchSwimJump">();
-    delegate_Fire_hook.installAtSym<"delegate_Fire">();
-    delegate_FireSwim_hook.installAtSym<"delegate_FireSwim">();
-    delegate_Throw_hook.installAtSym<"delegate_Throw">();
-    delegate_FrogWalk_hook.installAtSym<"delegate_FrogWalk">();
-    delegate_FrogSwim_hook.installAtSym<"delegate_FrogSwim">();
-    delegate_Flying_hook.installAtSym<"delegate_Flying">();
-    delegate_FlyingSlowFall_hook.installAtSym<"delegate_FlyingSlowFall">();
-    delegate_FlyingWallStick_hook.installAtSym<"delegate_FlyingWallStick">();
-    delegate_LiftUp_hook.installAtSym<"delegate_LiftUp">();
-    delegate_LiftUpSnowBall_hook.installAtSym<"delegate_LiftUpSnowBall">();
-    delegate_LiftUpCloud_hook.installAtSym<"delegate_LiftUpCloud">();
-    delegate_LiftUpBomb_hook.installAtSym<"delegate_LiftUpBomb">();
-    delegate_CarryPlayer_hook.installAtSym<"delegate_CarryPlayer">();
+    load_config();
+
+    // flight_recorder::init() runs before the plugins
+    s_stream = flight_recorder::stream_traces();
+    if (s_stream) {
+        if constexpr (FORMAT == Format::Binary) {
+            trace_log.init("trace.bin", log::Mode::Async);
+            write_bin_header();
+        } else {
+            trace_log.init("trace.csv", log::Mode::Async);
+            write_csv_header();
+        }
+    }
+
+    // Install up to 49 delegate hooks (skipping 7 that are ≤16B). Delegates
+    // disabled in func_trace.cfg don't take a trampoline, unless reload=1
+    // could enable them later.
+#define INSTALL_DELEGATE_HOOK(name, slot) \
+    if (s_reload || (s_filter[slot].flags & FILTER_ENABLED)) name##_hook.installAtSym<#name>();
+    FUNC_TRACE_DELEGATES(INSTALL_DELEGATE_HOOK)
+#undef INSTALL_DELEGATE_HOOK
 }
 
 void flush() {
     trace_log.flush();
+    if (s_reload) load_config();
 }
 
 } // namespace func_trace
@@ -0,0 +1,265 @@
+#include "smm2/load_profile.h"
+#include "smm2/paths.h"
+#include "smm2/log.h"
+#include "smm2/perf.h"
+#include "smm2/plugin.h"
+#include "smm2/ticks.h"
+#include "smm2/util.h"
+#include "hk/hook/Trampoline.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace smm2 {
+namespace load_profile {
+
+// ============================================================
+// Window state machine, advanced once per status update:
+//
+//   Idle     — no file activity; the next open/read starts a window
+//   Loading  — activity seen; settles after SETTLE_FRAMES quiet frames
+//   Dumping  — rows for [0, s_dump_end) written a few per frame, then
+//              later opens are moved to the front and back to Idle/Loading
+//
+// The hooks run on loader threads as well as the game thread, so the
+// file table is guarded by a spinlock. The hooks hold it for a table
+// lookup and a few adds — never across an fs call.
+// ============================================================
+
+enum class Phase : uint8_t {
+    Idle,
+    Loading,
+    Dumping,
+};
+
+constexpr uint32_t NO_FILE = 0xFFFFFFFF;
+
+struct FileStats {
+    char path[PATH_LEN];
+    uint32_t open_frame;
+    uint32_t reads;
+    uint64_t bytes;
+    uint64_t open_ticks;
+    uint64_t read_ticks;
+    uint64_t close_ticks;
+    uint64_t opened_at;
+    uint64_t lifetime_ticks;   // 0 while still open
+};
+
+struct OpenSlot {
+    void* handle;              // nullptr = free
+    uint32_t file;             // index into s_files, NO_FILE if not tracked
+};
+
+static FileStats s_files[MAX_FILES];
+static OpenSlot s_open[MAX_OPEN];
+static uint32_t s_file_count = 0;
+static uint32_t s_dropped = 0;           // opens with no room in s_files / s_open
+
+static std::atomic_flag s_lock = ATOMIC_FLAG_INIT;
+static std::atomic<bool> s_activity{false};
+static std::atomic<uint32_t> s_frame{0};
+static std::atomic<uint32_t> s_untracked_reads{0};
+
+static log::Logger s_windows;
+static log::Logger s_rows;
+static bool s_inited = false;
+
+static Phase s_phase = Phase::Idle;
+static uint32_t s_window = 0;
+static uint32_t s_scene_from = 0;
+static uint32_t s_last_scene = 0;
+static uint32_t s_start_frame = 0;
+static uint32_t s_last_activity = 0;
+static uint32_t s_dump_end = 0;
+static uint32_t s_dump_next = 0;
+
+static bool is_own_file(const char* path) {
+    return std::strncmp(path, paths::ROOT, std::strlen(paths::ROOT)) == 0;
+}
+
+static OpenSlot* find_slot(void* handle) {
+    for (OpenSlot& s : s_open)
+        if (s.handle == handle) return &s;
+    return nullptr;
+}
+
+void on_open(const nn::fs::FileHandle* handle, const char* path, uint32_t rc, uint64_t ticks) {
+    if (!s_inited || rc != 0 || !handle || !path || is_own_file(path)) return;
+    s_activity.store(true, std::memory_order_relaxed);
+
+    SpinGuard g(s_lock);
+    OpenSlot* slot = find_slot(nullptr);
+    if (!slot || s_file_count >= MAX_FILES) {
+        s_dropped++;
+        return;
+    }
+    FileStats& f = s_files[s_file_count];
+    std::memset(&f, 0, sizeof(f));
+    size_t len = std::strlen(path);
+    const char* tail = len < PATH_LEN ? path : path + len - (PATH_LEN - 1);
+    std::strncpy(f.path, tail, PATH_LEN - 1);
+    f.open_frame = s_frame.load(std::memory_order_relaxed);
+    f.open_ticks = ticks;
+    f.opened_at = ticks::now();
+    slot->handle = handle->handle;
+    slot->file = s_file_count++;
+}
+
+static HkTrampoline<uint32_t, size_t*, nn::fs::FileHandle, int64_t, void*, size_t> read_hook =
+    hk::hook::trampoline([](size_t* bytes_read, nn::fs::FileHandle fh, int64_t off, void* buf, size_t len) -> uint32_t {
+        PERF_SCOPE(load_profile_read);
+        uint64_t t0 = ticks::now();
+        uint32_t rc = PERF_ORIG(read_hook.orig(bytes_read, fh, off, buf, len));
+        uint64_t dt = ticks::now() - t0;
+
+        SpinGuard g(s_lock);
+        OpenSlot* slot = find_slot(fh.handle);
+        if (!slot || slot->file == NO_FILE) {
+            s_untracked_reads.fetch_add(1, std::memory_order_relaxed);
+            return rc;
+        }
+        s_activity.store(true, std::memory_order_relaxed);
+        FileStats& f = s_files[slot->file];
+        f.reads++;
+        f.bytes += bytes_read ? *bytes_read : 0;
+        f.read_ticks += dt;
+        return rc;
+    });
+
+static HkTrampoline<void, nn::fs::FileHandle> close_hook =
+    hk::hook::trampoline([](nn::fs::FileHandle fh) -> void {
+        PERF_SCOPE(load_profile_close);
+        uint64_t t0 = ticks::now();
+        PERF_ORIG(close_hook.orig(fh));
+        uint64_t t1 = ticks::now();
+
+        SpinGuard g(s_lock);
+        OpenSlot* slot = find_slot(fh.handle);
+        if (!slot) return;
+        if (slot->file != NO_FILE) {
+            FileStats& f = s_files[slot->file];
+            f.close_ticks = t1 - t0;
+            f.lifetime_ticks = t1 - f.opened_at;
+        }
+        slot->handle = nullptr;
+    });
+
+static uint32_t s_total_files;
+static uint64_t s_total_bytes;
+static uint64_t s_total_open, s_total_read, s_total_close;
+
+static void begin_dump(uint32_t frame, uint32_t scene_mode) {
+    uint32_t dropped;
+    {
+        SpinGuard g(s_lock);
+        s_dump_end = s_file_count;
+        dropped = s_dropped;
+        s_dropped = 0;
+    }
+    s_dump_next = 0;
+
+    s_total_files = s_dump_end;
+    s_total_bytes = s_total_open = s_total_read = s_total_close = 0;
+    for (uint32_t i = 0; i < s_dump_end; i++) {
+        const FileStats& f = s_files[i];
+        s_total_bytes += f.bytes;
+        s_total_open += f.open_ticks;
+        s_total_read += f.read_ticks;
+        s_total_close += f.close_ticks;
+    }
+    s_windows.writef("%u,%u,%u,%u,%u,%u,%llu,%u,%u,%u,%u,%u\n", s_window, s_scene_from,
+        scene_mode, s_start_frame, frame, s_total_files, (unsigned long long)s_total_bytes,
+        ticks::to_us(s_total_open), ticks::to_us(s_total_read), ticks::to_us(s_total_close),
+        s_untracked_reads.exchange(0, std::memory_order_relaxed), dropped);
+    s_windows.flush();
+    s_phase = Phase::Dumping;
+}
+
+// Returns true once every row of the window is written
+static bool dump_step() {
+    for (uint32_t n = 0; n < DUMP_ROWS_PER_FRAME && s_dump_next < s_dump_end; n++) {
+        const FileStats& f = s_files[s_dump_next++];
+        s_rows.writef("%u,%s,%u,%u,%llu,%u,%u,%u,%u\n", s_window, f.path, f.open_frame,
+            f.reads, (unsigned long long)f.bytes, ticks::to_us(f.open_ticks), ticks::to_us(f.read_ticks),
+            ticks::to_us(f.close_ticks), ticks::to_us(f.lifetime_ticks));
+    }
+    if (s_dump_next < s_dump_end) return false;
+    s_rows.flush();
+    return true;
+}
+
+// Drop the dumped rows; opens that arrived during the dump move to the front
+static void end_dump() {
+    SpinGuard g(s_lock);
+    uint32_t keep = s_file_count - s_dump_end;
+    std::memmove(s_files, s_files + s_dump_end, keep * sizeof(FileStats));
+    for (OpenSlot& s : s_open) {
+        if (!s.handle || s.file == NO_FILE) continue;
+        s.file = s.file >= s_dump_end ? s.file - s_dump_end : NO_FILE;
+    }
+    s_file_count = keep;
+    s_window++;
+}
+
+void init() {
+    s_windows.init("loads.csv", log::Mode::Async);
+    static const char windows_hdr[] = "window,scene_from,scene_to,start_frame,settle_frame,files,"
+                                      "bytes,open_us,read_us,close_us,untracked_reads,dropped\n";
+    s_windows.begin_preamble();
+    s_windows.write(windows_hdr, sizeof(windows_hdr) - 1);
+    s_windows.end_preamble();
+    s_rows.init("load_files.csv", log::Mode::Async);
+    static const char rows_hdr[] = "window,path,open_frame,reads,bytes,open_us,read_us,"
+                                   "close_us,lifetime_us\n";
+    s_rows.begin_preamble();
+    s_rows.write(rows_hdr, sizeof(rows_hdr) - 1);
+    s_rows.end_preamble();
+    s_inited = true;
+
+    // Hook groups: read, close. Opens come from course_data's "open" group.
+    if (plugin::hooks_enabled("load_profile", "read"))
+        read_hook.installAtSym<"_ZN2nn2fs8ReadFileEPmNS0_10FileHandleElPvm">();
+    if (plugin::hooks_enabled("load_profile", "close"))
+        close_hook.installAtSym<"_ZN2nn2fs9CloseFileENS0_10FileHandleE">();
+}
+
+void per_frame(uint32_t frame, uint32_t scene_mode) {
+    if (!s_inited) return;
+    s_frame.store(frame, std::memory_order_relaxed);
+
+    bool active = s_activity.exchange(false, std::memory_order_relaxed) || scene_mode != s_last_scene;
+
+    switch (s_phase) {
+    case Phase::Idle:
+        if (active) {
+            s_scene_from = s_last_scene;
+            s_start_frame = frame;
+            s_last_activity = frame;
+            s_phase = Phase::Loading;
+        }
+        break;
+    case Phase::Loading:
+        if (active) s_last_activity = frame;
+        else if (frame - s_last_activity >= SETTLE_FRAMES) begin_dump(frame, scene_mode);
+        break;
+    case Phase::Dumping:
+        if (dump_step()) {
+            end_dump();
+            if (s_file_count > 0) {
+                // Next load began while dumping
+                s_scene_from = scene_mode;
+                s_start_frame = frame;
+                s_last_activity = frame;
+                s_phase = Phase::Loading;
+            } else {
+                s_phase = Phase::Idle;
+            }
+        }
+        break;
+    }
+    s_last_scene = scene_mode;
+}
+
+} // namespace load_profile
+} // namespace smm2
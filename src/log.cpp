@@ -0,0 +1,582 @@
+#include "smm2/log.h"
+#include "smm2/cfg.h"
+#include "smm2/paths.h"
+#include "smm2/ring.h"
+#include "smm2/util.h"
+#include "nn/fs.h"
+#include "nn/os.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+namespace smm2 {
+namespace log {
+
+// ============================================================
+// Background SD writer for Async and Shared loggers.
+//
+// Async: producers (hooks, procFrame_) copy a full or flushed Logger
+// buffer into a fixed queue slot and signal. One low-priority thread
+// drains the queue in FIFO order and does all OpenFile/WriteFile/CloseFile.
+// FIFO keeps each logger's file_pos sequential without extra locking.
+// The mutex only guards the queue indices and the slot memcpy; SD I/O
+// happens with the mutex released, so the game thread never waits on
+// the filesystem unless all slots are in flight.
+//
+// Shared: every producer thread gets its own SPSC ring, claimed on first
+// use by CAS on the owning ThreadType*. write() only touches the calling
+// thread's ring — no lock, no contention with the 60 Hz npad poll or the
+// loader threads. The writer is the single consumer: it merges the rings
+// into each Logger's buffer and writes that to SD. Threads that come
+// after the MAX_PRODUCERS slots are taken (slots are never released —
+// there is no thread-exit hook) share one more ring behind a spinlock.
+//
+// With no Shared logger registered the writer sleeps until a slot is
+// queued; otherwise it wakes every SHARED_POLL_MS to merge the rings.
+// ============================================================
+
+constexpr uint32_t QUEUE_SLOTS = 16;  // 16 × 8 KB = 128 KB in flight
+constexpr size_t WRITER_STACK_SIZE = 0x4000;
+constexpr int WRITER_PRIORITY = 24;   // below the game thread
+constexpr int64_t SHARED_POLL_MS = 2; // max latency before rings are merged
+
+constexpr int MAX_PRODUCERS = 4;                // game, npad, loader threads; the rest share s_locked
+constexpr size_t PRODUCER_RING_SIZE = 0x4000;
+constexpr size_t MAX_RECORD = 2048;             // larger writes are split
+constexpr int MAX_SHARED = 8;
+
+struct Slot {
+    Logger* owner;
+    size_t len;
+    size_t record_len;   // submit()
+    char data[BUFFER_SIZE];
+};
+
+struct RecordHeader {
+    Logger* owner;
+    uint32_t len;
+};
+
+struct Producer {
+    std::atomic<nn::os::ThreadType*> thread{nullptr};
+    ByteRing<PRODUCER_RING_SIZE> ring;
+};
+
+static Slot s_slots[QUEUE_SLOTS];
+static uint32_t s_head = 0;  // next slot to fill (producers)
+static uint32_t s_tail = 0;  // next slot to drain (writer)
+static nn::os::MutexType s_mutex;
+static nn::os::ConditionVariableType s_ready;  // signalled when head advances
+static nn::os::ConditionVariableType s_space;  // signalled when tail advances
+static nn::os::ThreadType s_thread;
+alignas(nn::os::THREAD_STACK_ALIGN) static uint8_t s_stack[WRITER_STACK_SIZE];
+static bool s_running = false;
+
+static Producer s_producers[MAX_PRODUCERS];
+static Producer s_locked;                       // every thread without a slot of its own
+static std::atomic_flag s_locked_lock = ATOMIC_FLAG_INIT;
+static Logger* s_shared[MAX_SHARED];
+static std::atomic<int> s_shared_count{0};
+static std::atomic<uint32_t> s_dropped{0};
+
+// ------------------------------------------------------------
+// log.cfg
+// ------------------------------------------------------------
+
+constexpr size_t MAX_CFG_LIST = 256;
+
+static bool s_cfg_loaded = false;
+static char s_compress[MAX_CFG_LIST] = {};
+static char s_segment[MAX_CFG_LIST] = {};
+static uint32_t s_segment_kb = DEFAULT_SEGMENT_KB;
+static uint32_t s_segments = DEFAULT_SEGMENTS;
+
+static void load_config() {
+    s_cfg_loaded = true;
+    cfg::read("log.cfg", [](char* line) {
+        if (std::strncmp(line, "compress=", 9) == 0)
+            std::strncpy(s_compress, line + 9, sizeof(s_compress) - 1);
+        else if (std::strncmp(line, "segment=", 8) == 0)
+            std::strncpy(s_segment, line + 8, sizeof(s_segment) - 1);
+        else if (std::strncmp(line, "segment_kb=", 11) == 0)
+            s_segment_kb = uint32_t(std::strtoul(line + 11, nullptr, 10));
+        else if (std::strncmp(line, "segments=", 9) == 0)
+            s_segments = uint32_t(std::strtoul(line + 9, nullptr, 10));
+    });
+    if (s_segment_kb < MIN_SEGMENT_KB) s_segment_kb = MIN_SEGMENT_KB;
+    if (s_segments < 2) s_segments = 2;
+    if (s_segments > MAX_SEGMENTS) s_segments = MAX_SEGMENTS;
+}
+
+// filename (or *) is in list
+static bool listed(const char* list, const char* filename) {
+    size_t name_len = std::strlen(filename);
+    bool on = false;
+    cfg::for_each_token(list, [&](const char* tok, size_t len) {
+        if ((len == 1 && tok[0] == '*') ||
+            (len == name_len && std::strncmp(tok, filename, len) == 0))
+            on = true;
+    });
+    return on;
+}
+
+// ------------------------------------------------------------
+// Files and segments. The first Logger::init runs on the boot thread
+// (log.cfg is read there); the handles belong to whichever thread writes
+// (the writer, for Async and Shared). Re-initializing an Async logger
+// (flight dumps, tas takes) first waits out its queued slots.
+// ------------------------------------------------------------
+
+constexpr size_t SEG_PATH_LEN = paths::MAX_PATH + 8;   // .seg, .<slot>
+
+static void segment_path(char* out, const char* base, uint32_t slot) {
+    std::snprintf(out, SEG_PATH_LEN, "%s.%u", base, slot);
+}
+
+static void manifest_path(char* out, const char* base) {
+    std::snprintf(out, SEG_PATH_LEN, "%s.seg", base);
+}
+
+// Previous session's file, or its segments and manifest
+static void remove_outputs(const char* base) {
+    nn::fs::DeleteFile(base);
+    char p[SEG_PATH_LEN];
+    manifest_path(p, base);
+    nn::fs::FileHandle f;
+    if (nn::fs::OpenFile(&f, p, nn::fs::MODE_READ) != 0) return;
+    SegmentManifest m = {};
+    size_t bytes_read = 0;
+    nn::fs::ReadFile(&bytes_read, f, 0, &m, offsetof(SegmentManifest, len));
+    nn::fs::CloseFile(f);
+    uint32_t n = std::memcmp(m.magic, SEG_MAGIC, sizeof(m.magic)) == 0 ? m.segments : MAX_SEGMENTS;
+    for (uint32_t i = 0; i < n && i < MAX_SEGMENTS; i++) {
+        char seg[SEG_PATH_LEN];
+        segment_path(seg, base, i);
+        nn::fs::DeleteFile(seg);
+    }
+    nn::fs::DeleteFile(p);
+}
+
+static void write_at(Logger* log, const void* data, size_t len) {
+    if (!log->file_open) return;
+    nn::fs::WriteOption opt = {.flags = nn::fs::WRITE_OPTION_FLUSH};
+    nn::fs::WriteFile(log->file, log->file_pos, data, len, opt);
+    log->file_pos += len;
+}
+
+// first / current / current_len / preamble_len, in place
+static void update_manifest(Logger* log) {
+    uint32_t preamble = log->preamble_overflow ? PREAMBLE_OVERFLOW : log->preamble_len;
+    uint32_t head[4] = {log->seg_first, log->seg_current, uint32_t(log->file_pos), preamble};
+    nn::fs::WriteOption opt = {.flags = nn::fs::WRITE_OPTION_FLUSH};
+    nn::fs::WriteFile(log->manifest, offsetof(SegmentManifest, first), head, sizeof(head), opt);
+}
+
+static void write_lz_header(Logger* log) {
+    lz::FileHeader hdr = {};
+    std::memcpy(hdr.magic, lz::LZ_MAGIC, sizeof(hdr.magic));
+    hdr.version = lz::LZ_VERSION;
+    hdr.block_max = uint16_t(BUFFER_SIZE);
+    write_at(log, &hdr, sizeof(hdr));
+}
+
+// Open (first use: create at full size) the current segment's slot
+static void open_segment(Logger* log) {
+    char seg[SEG_PATH_LEN];
+    segment_path(seg, log->path, log->seg_current % log->segments);
+    log->file_open = nn::fs::OpenFile(&log->file, seg, nn::fs::MODE_WRITE) == 0;
+    if (!log->file_open) {
+        nn::fs::CreateFile(seg, log->segment_size);
+        log->file_open = nn::fs::OpenFile(&log->file, seg, nn::fs::MODE_WRITE) == 0;
+    }
+    log->file_pos = 0;
+    if (log->compressed) write_lz_header(log);
+    // Segment 0 gets the preamble from write(); an overflowed one is never replayed
+    if (log->seg_current == 0 || log->preamble_len == 0 || log->preamble_overflow) return;
+
+    // Every later segment starts with the preamble, raw (a stored block if compressed)
+    if (log->compressed) {
+        lz::BlockHeader hdr = {log->preamble_len, log->preamble_len | lz::STORED_RAW};
+        write_at(log, &hdr, sizeof(hdr));
+    }
+    write_at(log, log->preamble, log->preamble_len);
+}
+
+static void rotate(Logger* log) {
+    uint32_t slot = log->seg_current % log->segments;
+    uint32_t len = uint32_t(log->file_pos);
+    nn::fs::WriteOption opt = {.flags = 0};
+    nn::fs::WriteFile(log->manifest, offsetof(SegmentManifest, len) + slot * sizeof(uint32_t),
+                      &len, sizeof(len), opt);
+    if (log->file_open) nn::fs::CloseFile(log->file);
+
+    log->seg_current++;
+    if (log->seg_current - log->seg_first >= log->segments)
+        log->seg_first = log->seg_current - log->segments + 1;
+    log->file_pos = 0;
+    update_manifest(log);   // drop the oldest before its slot is overwritten
+    open_segment(log);
+}
+
+// Preamble buffers, claimed by segmented loggers at init and kept across
+// re-inits of the same Logger
+static char s_preambles[PREAMBLE_SLOTS][PREAMBLE_MAX];
+static Logger* s_preamble_owner[PREAMBLE_SLOTS];
+static std::atomic_flag s_preamble_lock = ATOMIC_FLAG_INIT;
+static std::atomic<uint32_t> s_preamble_overflows{0};
+
+static char* claim_preamble(Logger* owner) {
+    SpinGuard g(s_preamble_lock);
+    for (uint32_t i = 0; i < PREAMBLE_SLOTS; i++) {
+        if (s_preamble_owner[i] == nullptr || s_preamble_owner[i] == owner) {
+            s_preamble_owner[i] = owner;
+            return s_preambles[i];
+        }
+    }
+    return nullptr;
+}
+
+bool Logger::end_preamble() {
+    preamble_capture = false;
+    if (!preamble_overflow) return true;
+    s_preamble_overflows.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+uint32_t preamble_overflows() {
+    return s_preamble_overflows.load(std::memory_order_relaxed);
+}
+
+static void wait_drained(Logger* owner);
+
+void Logger::init(const char* filename, Mode m) {
+    if (initialized && mode == Mode::Async) wait_drained(this);
+    if (file_open) nn::fs::CloseFile(file);
+    if (segment_size) nn::fs::CloseFile(manifest);
+    file_open = false;
+    initialized = false;
+
+    if (!s_cfg_loaded) load_config();
+    compressed = listed(s_compress, filename);
+    segment_size = listed(s_segment, filename) ? s_segment_kb * 1024 : 0;
+    segments = uint16_t(s_segments);
+    if (segment_size && !preamble) preamble = claim_preamble(this);
+    if (!preamble) segment_size = 0;   // pool exhausted: one growing file
+
+    // Remove both forms so host tools never read a previous session's copy
+    char other[paths::MAX_PATH];
+    std::snprintf(other, sizeof(other), compressed ? "%s" : "%s.lz", filename);
+    paths::make(path, sizeof(path), other);
+    remove_outputs(path);
+    std::snprintf(other, sizeof(other), compressed ? "%s.lz" : "%s", filename);
+    paths::make(path, sizeof(path), other);
+    remove_outputs(path);
+
+    pos = 0;
+    file_pos = 0;
+    mode = m;
+    seg_first = 0;
+    seg_current = 0;
+    preamble_len = 0;
+    preamble_capture = false;
+    preamble_overflow = false;
+
+    if (segment_size) {
+        char p[SEG_PATH_LEN];
+        manifest_path(p, path);
+        nn::fs::CreateFile(p, sizeof(SegmentManifest));
+        if (nn::fs::OpenFile(&manifest, p, nn::fs::MODE_WRITE) != 0) {
+            segment_size = 0;   // fall back to one growing file
+        } else {
+            SegmentManifest hdr = {};
+            std::memcpy(hdr.magic, SEG_MAGIC, sizeof(hdr.magic));
+            hdr.version = SEG_VERSION;
+            hdr.segments = segments;
+            hdr.segment_size = segment_size;
+            nn::fs::WriteFile(manifest, 0, &hdr, sizeof(hdr), {nn::fs::WRITE_OPTION_FLUSH});
+            open_segment(this);
+            update_manifest(this);
+        }
+    }
+    if (!segment_size) {
+        // One growing file, appended at file_pos
+        nn::fs::CreateFile(path, 0);
+        file_open = nn::fs::OpenFile(&file, path, nn::fs::MODE_WRITE | nn::fs::MODE_APPEND) == 0;
+        if (compressed) write_lz_header(this);
+    }
+
+    if (mode == Mode::Shared) register_shared(this);
+    initialized = true;
+}
+
+// ------------------------------------------------------------
+// Compression (lz.h). One scratch for the writer thread, one shared by
+// Sync flushes under a spinlock — Sync already does SD I/O on the
+// flushing thread, so waiting for another Sync flush is no worse.
+// ------------------------------------------------------------
+
+struct Scratch {
+    uint16_t table[lz::HASH_SIZE];
+    uint8_t block[sizeof(lz::BlockHeader) + lz::bound(BUFFER_SIZE)];
+};
+
+static_assert(BUFFER_SIZE <= lz::MAX_BLOCK, "Logger buffers must fit one LZ4 block");
+static_assert(sizeof(lz::FileHeader) + sizeof(lz::BlockHeader) * 2 + PREAMBLE_MAX +
+              lz::bound(BUFFER_SIZE) <= MIN_SEGMENT_KB * 1024, "a block must fit an empty segment");
+
+// Bytes a record of len takes in a segment: raw, or its BUFFER_SIZE chunks
+// as worst-case blocks
+static size_t stored_size(const Logger* log, size_t len) {
+    if (!log->compressed) return len;
+    size_t full = len / BUFFER_SIZE, rest = len % BUFFER_SIZE;
+    return full * (sizeof(lz::BlockHeader) + lz::bound(BUFFER_SIZE)) +
+           (rest ? sizeof(lz::BlockHeader) + lz::bound(rest) : 0);
+}
+
+// What open_segment() writes ahead of the first record
+static size_t segment_start(const Logger* log) {
+    size_t n = log->preamble_len;
+    if (log->compressed) n += sizeof(lz::FileHeader) + sizeof(lz::BlockHeader);
+    return n;
+}
+
+bool fits_segment(const Logger* log, size_t len) {
+    if (segment_start(log) + stored_size(log, len) <= log->segment_size) return true;
+    s_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+// One rotation decision per record, before it is chunked — the chunks of
+// a record that fits never start another segment
+static void reserve(Logger* log, size_t record_len) {
+    if (log->segment_size && log->file_pos + stored_size(log, record_len) > log->segment_size)
+        rotate(log);
+}
+
+static Scratch s_writer_scratch;
+static Scratch s_sync_scratch;
+static std::atomic_flag s_sync_lock = ATOMIC_FLAG_INIT;
+
+// BUFFER_SIZE chunks, each one BlockHeader + payload (or raw bytes) in one
+// write. The caller has reserve()d room for the record.
+static void write_chunks(Logger* log, const char* data, size_t len, Scratch* s) {
+    while (len > 0) {
+        size_t n = len < BUFFER_SIZE ? len : BUFFER_SIZE;
+        if (!log->compressed) {
+            write_at(log, data, n);
+        } else {
+            uint8_t* payload = s->block + sizeof(lz::BlockHeader);
+            size_t c = lz::compress(reinterpret_cast<const uint8_t*>(data), n, payload,
+                                    lz::bound(n), s->table);
+            if (c == 0) std::memcpy(payload, data, n);
+            lz::BlockHeader hdr = {uint32_t(n), c ? uint32_t(c) : uint32_t(n) | lz::STORED_RAW};
+            std::memcpy(s->block, &hdr, sizeof(hdr));
+            write_at(log, s->block, sizeof(hdr) + (c ? c : n));
+        }
+        data += n;
+        len -= n;
+    }
+    if (log->segment_size) update_manifest(log);
+}
+
+void append_block(Logger* log, const char* data, size_t len) {
+    reserve(log, len);
+    if (!log->compressed) {
+        write_chunks(log, data, len, nullptr);
+        return;
+    }
+    SpinGuard g(s_sync_lock);
+    write_chunks(log, data, len, &s_sync_scratch);
+}
+
+// Writer thread only
+static void write_block(Logger* log, const char* data, size_t len, size_t record_len) {
+    reserve(log, record_len);
+    write_chunks(log, data, len, &s_writer_scratch);
+}
+
+static void write_out(Logger* log) {
+    write_block(log, log->buffer, log->pos, log->pos);
+    log->pos = 0;
+}
+
+static void drain_ring(ByteRing<PRODUCER_RING_SIZE>& ring) {
+    // push() publishes header + payload together, so a visible header
+    // always has its payload behind it
+    while (ring.used() >= sizeof(RecordHeader)) {
+        RecordHeader hdr;
+        ring.peek(&hdr, sizeof(hdr));
+        Logger* log = hdr.owner;
+        if (log->pos + hdr.len > BUFFER_SIZE) write_out(log);
+        ring.peek(log->buffer + log->pos, hdr.len, sizeof(hdr));
+        log->pos += hdr.len;
+        ring.consume(sizeof(hdr) + hdr.len);
+    }
+}
+
+// Merge every producer ring into its loggers' buffers (writer thread only)
+static void drain_shared() {
+    for (auto& p : s_producers) drain_ring(p.ring);
+    drain_ring(s_locked.ring);   // the consumer side needs no lock
+
+    int n = s_shared_count.load(std::memory_order_acquire);
+    for (int i = 0; i < n; i++) {
+        Logger* log = s_shared[i];
+        if (log->flush_requested.exchange(false) && log->pos > 0) write_out(log);
+    }
+}
+
+static void writer_main(void*) {
+    for (;;) {
+        nn::os::LockMutex(&s_mutex);
+        if (s_tail == s_head) {
+            // No ring to merge: sleep until submit() or register_shared()
+            if (s_shared_count.load(std::memory_order_acquire) == 0)
+                nn::os::WaitConditionVariable(&s_ready, &s_mutex);
+            else
+                nn::os::TimedWaitConditionVariable(&s_ready, &s_mutex,
+                    nn::TimeSpan::FromMilliSeconds(SHARED_POLL_MS));
+        }
+        Slot* slot = s_tail != s_head ? &s_slots[s_tail % QUEUE_SLOTS] : nullptr;
+        nn::os::UnlockMutex(&s_mutex);
+
+        if (slot) {
+            write_block(slot->owner, slot->data, slot->len, slot->record_len);
+
+            nn::os::LockMutex(&s_mutex);
+            s_tail++;
+            nn::os::SignalConditionVariable(&s_space);
+            nn::os::UnlockMutex(&s_mutex);
+        }
+
+        drain_shared();
+    }
+}
+
+void start_writer() {
+    if (s_running) return;
+
+    nn::os::InitializeMutex(&s_mutex, false, 0);
+    nn::os::InitializeConditionVariable(&s_ready);
+    nn::os::InitializeConditionVariable(&s_space);
+
+    if (nn::os::CreateThread(&s_thread, writer_main, nullptr,
+                             s_stack, sizeof(s_stack), WRITER_PRIORITY) != 0)
+        return;  // stay in sync mode
+    nn::os::SetThreadName(&s_thread, "smm2-hooks:log");
+    nn::os::StartThread(&s_thread);
+    s_running = true;
+}
+
+bool writer_running() {
+    return s_running;
+}
+
+bool submit(Logger* owner, const char* data, size_t len, size_t record_len) {
+    if (!s_running) return false;
+
+    nn::os::LockMutex(&s_mutex);
+    while (s_head - s_tail == QUEUE_SLOTS) {
+        // Writer is behind by 128 KB — wait rather than reorder the file
+        nn::os::WaitConditionVariable(&s_space, &s_mutex);
+    }
+    Slot& slot = s_slots[s_head % QUEUE_SLOTS];
+    slot.owner = owner;
+    slot.len = len;
+    slot.record_len = record_len;
+    std::memcpy(slot.data, data, len);
+    s_head++;
+    nn::os::SignalConditionVariable(&s_ready);
+    nn::os::UnlockMutex(&s_mutex);
+    return true;
+}
+
+// Until no queued slot belongs to owner. The slot being written counts
+// until the writer advances s_tail.
+static void wait_drained(Logger* owner) {
+    if (!s_running) return;
+    nn::os::LockMutex(&s_mutex);
+    for (;;) {
+        bool queued = false;
+        for (uint32_t i = s_tail; i != s_head; i++) {
+            if (s_slots[i % QUEUE_SLOTS].owner == owner) {
+                queued = true;
+                break;
+            }
+        }
+        if (!queued) break;
+        // Timed: s_space is signalled, not broadcast, and submit() may be waiting too
+        nn::os::TimedWaitConditionVariable(&s_space, &s_mutex,
+            nn::TimeSpan::FromMilliSeconds(SHARED_POLL_MS));
+    }
+    nn::os::UnlockMutex(&s_mutex);
+}
+
+// Find (or claim) the calling thread's ring. Each thread only ever
+// claims for itself, so one CAS per slot is enough.
+static Producer* current_producer() {
+    nn::os::ThreadType* self = nn::os::GetCurrentThread();
+    for (auto& p : s_producers) {
+        if (p.thread.load(std::memory_order_acquire) == self) return &p;
+    }
+    for (auto& p : s_producers) {
+        nn::os::ThreadType* expected = nullptr;
+        if (p.thread.compare_exchange_strong(expected, self)) return &p;
+    }
+    return nullptr;
+}
+
+void register_shared(Logger* owner) {
+    int n = s_shared_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; i++) {
+        if (s_shared[i] == owner) return;
+    }
+    if (n >= MAX_SHARED) return;
+    s_shared[n] = owner;
+    s_shared_count.store(n + 1, std::memory_order_release);
+    if (!s_running) return;
+    // The writer may be sleeping untimed; switch it to polling
+    nn::os::LockMutex(&s_mutex);
+    nn::os::SignalConditionVariable(&s_ready);
+    nn::os::UnlockMutex(&s_mutex);
+}
+
+// Split into MAX_RECORD records; a full ring drops the rest and counts it
+static void push_records(Producer* p, Logger* owner, const char* data, size_t len) {
+    while (len > 0) {
+        size_t n = len < MAX_RECORD ? len : MAX_RECORD;
+        RecordHeader hdr = {owner, static_cast<uint32_t>(n)};
+        if (!p->ring.push(&hdr, sizeof(hdr), data, n)) {
+            s_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        data += n;
+        len -= n;
+    }
+}
+
+bool push_shared(Logger* owner, const char* data, size_t len) {
+    if (!s_running) return false;
+
+    Producer* p = current_producer();
+    if (p) {
+        push_records(p, owner, data, len);
+        return true;
+    }
+    // Out of slots: one producer at a time on the shared ring
+    SpinGuard g(s_locked_lock);
+    push_records(&s_locked, owner, data, len);
+    return true;
+}
+
+void request_flush(Logger* owner) {
+    owner->flush_requested.store(true, std::memory_order_release);
+}
+
+uint32_t dropped_records() {
+    return s_dropped.load(std::memory_order_relaxed);
+}
+
+} // namespace log
+} // namespace smm2
@@ -0,0 +1,105 @@
+#include "smm2/lz.h"
+
+#include <cstring>
+
+namespace smm2 {
+namespace lz {
+
+// LZ4 block format limits: the last match must start MFLIMIT bytes before
+// the end, and the last LAST_LITERALS bytes are always literals
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MFLIMIT = 12;
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MAX_OFFSET = 0xFFFF;
+
+static uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t hash(uint32_t seq) {
+    return (seq * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Length continuation bytes after a saturated (15) token nibble
+static uint8_t* put_len(uint8_t* op, size_t len) {
+    for (; len >= 255; len -= 255) *op++ = 255;
+    *op++ = uint8_t(len);
+    return op;
+}
+
+// Worst-case bytes for one sequence's token, literals and length bytes
+static size_t sequence_cost(size_t lit, size_t mlen) {
+    return 1 + lit / 255 + 1 + lit + 2 + mlen / 255 + 1;
+}
+
+size_t compress(const uint8_t* src, size_t n, uint8_t* dst, size_t cap, uint16_t* table) {
+    if (n == 0 || n > MAX_BLOCK) return 0;
+    std::memset(table, 0, HASH_SIZE * sizeof(uint16_t));
+
+    const uint8_t* const end = src + n;
+    const uint8_t* anchor = src;
+    uint8_t* op = dst;
+    uint8_t* const oend = dst + (cap < n ? cap : n);
+
+    if (n > MFLIMIT) {
+        const uint8_t* const mflimit = end - MFLIMIT;
+        const uint8_t* const match_limit = end - LAST_LITERALS;
+        const uint8_t* ip = src + 1;
+        table[hash(read32(src))] = 0;
+
+        while (ip < mflimit) {
+            uint32_t seq = read32(ip);
+            uint32_t h = hash(seq);
+            const uint8_t* ref = src + table[h];
+            table[h] = uint16_t(ip - src);
+            if (ref >= ip || size_t(ip - ref) > MAX_OFFSET || read32(ref) != seq) {
+                ip++;
+                continue;
+            }
+
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+            const uint8_t* m = ip + MIN_MATCH;
+            const uint8_t* r = ref + MIN_MATCH;
+            while (m < match_limit && *m == *r) {
+                m++;
+                r++;
+            }
+
+            size_t lit = size_t(ip - anchor);
+            size_t mlen = size_t(m - ip) - MIN_MATCH;
+            if (op + sequence_cost(lit, mlen) > oend) return 0;
+
+            uint8_t* token = op++;
+            *token = uint8_t((lit >= 15 ? 15 : lit) << 4);
+            if (lit >= 15) op = put_len(op, lit - 15);
+            std::memcpy(op, anchor, lit);
+            op += lit;
+            size_t off = size_t(ip - ref);
+            *op++ = uint8_t(off);
+            *op++ = uint8_t(off >> 8);
+            *token |= uint8_t(mlen >= 15 ? 15 : mlen);
+            if (mlen >= 15) op = put_len(op, mlen - 15);
+
+            ip = m;
+            anchor = ip;
+            if (ip < mflimit) table[hash(read32(ip - 2))] = uint16_t(ip - 2 - src);
+        }
+    }
+
+    size_t lit = size_t(end - anchor);
+    if (op + 1 + lit / 255 + 1 + lit >= oend) return 0;
+    uint8_t* token = op++;
+    *token = uint8_t((lit >= 15 ? 15 : lit) << 4);
+    if (lit >= 15) op = put_len(op, lit - 15);
+    std::memcpy(op, anchor, lit);
+    op += lit;
+    return size_t(op - dst);
+}
+
+} // namespace lz
+} // namespace smm2
@@ -1,92 +1,49 @@
+#include "smm2/boot_tables.h"
 #include "smm2/frame.h"
+#include "smm2/log.h"
+#include "smm2/paths.h"
+#include "smm2/flight_recorder.h"
+#include "smm2/perf.h"
+#include "smm2/plugin.h"
+#include "smm2/world.h"
 #include "nn/fs.h"
 
-// Forward declarations for plugins
-namespace smm2 { namespace state_logger {
-    void init();
-    void per_frame(uint32_t frame);
-    void flush();
-}}
-
-namespace smm2 { namespace func_trace {
-    void init();
-    void flush();
-}}
-
-namespace smm2 { namespace reimpl {
-    void init();
-}}
-
-namespace smm2 { namespace tas {
-    void init();
-}}
-
-namespace smm2 { namespace status {
-    void init();
-    void update(uint32_t frame);
-}}
-
-namespace smm2 { namespace game_phase {
-    void init();
-    void per_frame(uint32_t frame);
-}}
-
-namespace smm2 { namespace camera_debug {
-    void init();
-    void per_frame(uint32_t frame);
-}}
-namespace smm2 { namespace course_data {
-    void init();
-}}
-
-namespace smm2 { namespace actor_profile {
-    void init();
-}}
-
-namespace smm2 { namespace xlink2_enum {
-    void init();
-    void flush();
-}}
-
-namespace smm2 { namespace sim_trace {
-    void init();
-    void per_frame(uint32_t frame);
-    void flush();
-}}
-
-namespace smm2 { namespace placeholder_debug {
-    void init();
-}}
-
 static void on_frame(uint32_t frame) {
-    smm2::game_phase::per_frame(frame);
-    smm2::status::update(frame);
-    smm2::sim_trace::per_frame(frame);
-    // smm2::camera_debug::per_frame(frame); // disabled — forces viewport dims
+    // Walk the global pointer chains once; every plugin reads the snapshot
+    smm2::world::resolve(frame);
 
-    // Flush logs periodically
-    if (frame % 300 == 0) {
-        smm2::func_trace::flush();
-        smm2::xlink2_enum::flush();
-        smm2::sim_trace::flush();
-    }
+    smm2::plugin::per_frame(frame);
+    smm2::perf::per_frame(frame);
+    smm2::boot_tables::poll();
+
+    if (frame % smm2::plugin::FLUSH_INTERVAL == 0)
+        smm2::frame::flush();
 }
 
 extern "C" void hkMain() {
     nn::fs::MountSdCardForDebug("sd");
-    nn::fs::CreateDirectory("sd:/smm2-hooks");
+    nn::fs::CreateDirectory(smm2::paths::ROOT);
+
+    // Instance directory (instance.cfg) — every path below resolves under it
+    smm2::paths::init();
+
+    // Background SD writer — Async loggers hand buffers to it instead of
+    // doing file I/O inside procFrame_. Must start before plugin init.
+    smm2::log::start_writer();
+
+    // Hook overhead counters; before frame::init so frame 0 is covered
+    smm2::perf::init();
 
     // Init framework
+    smm2::world::init();
     smm2::frame::init(on_frame);
 
-    // Init plugins - ALL ENABLED
-    // smm2::tas::init();           // disabled — may interfere with Pro Controller input
-    smm2::status::init();           // writes status.bin, hooks PlayerObject_changeState
-    smm2::game_phase::init();       // reads GamePhaseManager
-    smm2::course_data::init();      // hooks WriteFile for BCD
-    smm2::camera_debug::init();
-    smm2::actor_profile::init();    // logs actor profiles + state names
-    smm2::xlink2_enum::init();      // captures xlink2 enum definitions
-    smm2::sim_trace::init();        // per-frame player trace for sim comparison
-    smm2::placeholder_debug::init(); // force spikeballs into placeholder state
+    // Flight recorder before the plugins that feed it (status, func_trace)
+    smm2::flight_recorder::init();   // only with flight.cfg: history dumped on death/goal
+
+    // Cache check for actor_profile / xlink2_enum's registration capture
+    smm2::boot_tables::init();
+
+    // Plugins selected by plugins.cfg (see plugin.h)
+    smm2::plugin::init();
 }
@@ -0,0 +1,110 @@
+#include "smm2/paths.h"
+#include "smm2/cfg.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace smm2 {
+namespace paths {
+
+static char s_id[MAX_ID] = "";
+static char s_id_dir[MAX_PATH];   // ROOT/<id>, once an instance ID is in use
+static const char* s_dir = ROOT;
+
+static bool valid_id(const char* id, size_t len) {
+    if (len == 0 || len >= MAX_ID) return false;
+    for (size_t i = 0; i < len; i++) {
+        char c = id[i];
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c >= '0' && c <= '9') || c == '-' || c == '_';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+static void use(const char* id) {
+    std::snprintf(s_id, sizeof(s_id), "%s", id);
+    std::snprintf(s_id_dir, sizeof(s_id_dir), "%s/%s", ROOT, s_id);
+    nn::fs::CreateDirectory(s_id_dir);
+    s_dir = s_id_dir;
+}
+
+// First iN whose instance.lock we create
+static bool claim(uint32_t slots) {
+    for (uint32_t i = 0; i < slots; i++) {
+        char id[MAX_ID], dir[MAX_PATH], lock[MAX_PATH];
+        std::snprintf(id, sizeof(id), "i%u", i);
+        std::snprintf(dir, sizeof(dir), "%s/%s", ROOT, id);
+        std::snprintf(lock, sizeof(lock), "%s/instance.lock", dir);
+        nn::fs::CreateDirectory(dir);
+        if (nn::fs::CreateFile(lock, 0) != 0) continue;   // taken
+        use(id);
+        return true;
+    }
+    return false;
+}
+
+void init() {
+    nn::fs::FileHandle f;
+    char cfg[MAX_PATH];
+    std::snprintf(cfg, sizeof(cfg), "%s/instance.cfg", ROOT);
+    if (nn::fs::OpenFile(&f, cfg, nn::fs::MODE_READ) != 0)
+        return;
+
+    char id[MAX_ID] = "";
+    uint32_t slots = DEFAULT_SLOTS;
+    cfg::read(f, [&](char* line) {
+        if (std::strncmp(line, "id=", 3) == 0) {
+            const char* v = line + 3;
+            size_t len = 0;
+            while (v[len] && v[len] != '\r' && v[len] != ' ') len++;
+            if (valid_id(v, len)) {
+                std::memcpy(id, v, len);
+                id[len] = '\0';
+            }
+        } else if (std::strncmp(line, "slots=", 6) == 0) {
+            slots = uint32_t(std::strtoul(line + 6, nullptr, 10));
+        }
+    });
+    if (slots > MAX_SLOTS) slots = MAX_SLOTS;
+
+    if (std::strcmp(id, "auto") == 0)
+        claim(slots);
+    else if (id[0])
+        use(id);
+}
+
+const char* dir() { return s_dir; }
+const char* id() { return s_id; }
+
+static bool exists(const char* path) {
+    nn::fs::FileHandle f;
+    if (nn::fs::OpenFile(&f, path, nn::fs::MODE_READ) != 0) return false;
+    nn::fs::CloseFile(f);
+    return true;
+}
+
+void make(char* out, size_t cap, const char* name) {
+    std::snprintf(out, cap, "%s/%s", s_dir, name);
+}
+
+bool find(char* out, size_t cap, const char* name) {
+    make(out, cap, name);
+    if (exists(out)) return true;
+    if (s_id[0]) {
+        std::snprintf(out, cap, "%s/%s", ROOT, name);
+        if (exists(out)) return true;
+        make(out, cap, name);
+    }
+    return false;
+}
+
+bool open_read(nn::fs::FileHandle* f, const char* name) {
+    char path[MAX_PATH];
+    if (!find(path, sizeof(path), name)) return false;
+    return nn::fs::OpenFile(f, path, nn::fs::MODE_READ) == 0;
+}
+
+} // namespace paths
+} // namespace smm2
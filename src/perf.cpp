@@ -0,0 +1,72 @@
+#include "smm2/perf.h"
+#include "smm2/log.h"
+
+#include <cstring>
+
+namespace smm2 {
+namespace perf {
+
+Counter g_counters[PROBE_COUNT];
+
+static log::Logger s_log;
+static bool s_inited = false;
+static uint32_t s_last_frame = 0;
+static uint32_t s_prev_calls[PROBE_COUNT];
+static uint64_t s_prev_ticks[PROBE_COUNT];
+
+struct Sample {
+    PerfSampleHeader hdr;
+    PerfCounterSample counters[PROBE_COUNT];
+};
+
+static_assert(sizeof(Sample) == sizeof(PerfSampleHeader) + PROBE_COUNT * sizeof(PerfCounterSample),
+              "Sample must be packed");
+
+static const PerfProbeDesc s_probes[PROBE_COUNT] = {
+#define PERF_PROBE_DESC(name, plugin) {#name, #plugin},
+    PERF_PROBES(PERF_PROBE_DESC)
+#undef PERF_PROBE_DESC
+};
+
+void init() {
+    if (!ENABLED) return;
+    s_log.init("perf.bin", log::Mode::Async);
+
+    PerfHeader hdr = {};
+    std::memcpy(hdr.magic, PERF_MAGIC, sizeof(hdr.magic));
+    hdr.version = PERF_VERSION;
+    hdr.probe_count = PROBE_COUNT;
+    hdr.tick_hz = uint32_t(ticks::frequency());
+    hdr.sample_size = sizeof(Sample);
+    static_assert(sizeof(hdr) + sizeof(s_probes) <= log::PREAMBLE_MAX, "perf.bin header must fit a segment preamble");
+    s_log.begin_preamble();
+    s_log.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    s_log.write(reinterpret_cast<const char*>(s_probes), sizeof(s_probes));
+    s_log.end_preamble();
+    s_inited = true;
+}
+
+// Called every frame from main.cpp
+void per_frame(uint32_t frame) {
+    if (!s_inited || frame - s_last_frame < PERF_INTERVAL) return;
+
+    Sample s;
+    s.hdr.frame = frame;
+    s.hdr.frames = frame - s_last_frame;
+    for (uint32_t i = 0; i < PROBE_COUNT; i++) {
+        uint32_t calls = g_counters[i].calls.load(std::memory_order_relaxed);
+        uint64_t t = g_counters[i].ticks.load(std::memory_order_relaxed);
+        s.counters[i].calls = calls - s_prev_calls[i];
+        s.counters[i]._pad = 0;
+        s.counters[i].ticks = t - s_prev_ticks[i];
+        s_prev_calls[i] = calls;
+        s_prev_ticks[i] = t;
+    }
+    s_last_frame = frame;
+
+    s_log.write(reinterpret_cast<const char*>(&s), sizeof(s));
+    s_log.flush();
+}
+
+} // namespace perf
+} // namespace smm2
@@ -23,6 +23,7 @@
 
 #include <hk/hook/Trampoline.h>
 #include <hk/ro/RoUtil.h>
+#include "smm2/perf.h"
 
 namespace smm2 {
 namespace placeholder_debug {
@@ -30,6 +31,7 @@ namespace placeholder_debug {
 // Hook: GabonIronBallWU::calc (sub_71010F2970)
 static HkTrampoline<long, void*> ironball_calc_hook =
     hk::hook::trampoline([](void* actor) -> long {
+        PERF_SCOPE(placeholder_ironball);
         uintptr_t a = reinterpret_cast<uintptr_t>(actor);
         
         // Save and NULL the collision component pointer at actor+1768
@@ -39,7 +41,7 @@ static HkTrampoline<long, void*> ironball_calc_hook =
         *collision_ptr = 0;
         
         // Run the original calc
-        long result = ironball_calc_hook.orig(actor);
+        long result = PERF_ORIG(ironball_calc_hook.orig(actor));
         
         // Restore collision component pointer
         *collision_ptr = saved_collision;
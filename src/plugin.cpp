@@ -0,0 +1,168 @@
+#include "smm2/plugin.h"
+#include "smm2/cfg.h"
+#include "smm2/paths.h"
+#include "smm2/actor_activity.h"
+#include "smm2/actor_profile.h"
+#include "smm2/actor_registry.h"
+#include "smm2/camera_debug.h"
+#include "smm2/course_data.h"
+#include "smm2/func_trace.h"
+#include "smm2/game_phase.h"
+#include "smm2/load_profile.h"
+#include "smm2/log.h"
+#include "smm2/reimpl.h"
+#include "smm2/status.h"
+#include "nn/fs.h"
+
+#include <cstring>
+
+// Plugins without a header of their own
+namespace smm2 { namespace state_logger {
+    void init();
+    void per_frame(uint32_t frame);
+    void flush();
+}}
+
+namespace smm2 { namespace tas {
+    void init();
+}}
+
+namespace smm2 { namespace xlink2_enum {
+    void init();
+}}
+
+namespace smm2 { namespace sim_trace {
+    void init();
+    void per_frame(uint32_t frame);
+    void flush();
+}}
+
+namespace smm2 { namespace placeholder_debug {
+    void init();
+}}
+
+namespace smm2 {
+namespace plugin {
+
+// Registry order is init, per_frame and flush order. game_phase inits
+// before status so its PhaseChange handler sees the first events.
+static const Plugin s_plugins[] = {
+    {"tas",               false, tas::init,               nullptr,                nullptr},  // may interfere with Pro Controller input
+    {"game_phase",        true,  game_phase::init,        nullptr,                game_phase::flush},
+    {"status",            true,  status::init,            status::update,         nullptr},
+    {"course_data",       true,  course_data::init,       nullptr,                nullptr},
+    {"load_profile",      true,  load_profile::init,      nullptr,                nullptr},  // per_frame driven by status
+    {"camera_debug",      true,  camera_debug::init,      nullptr,                nullptr},  // per_frame forces viewport dims
+    {"actor_profile",     true,  actor_profile::init,     nullptr,                nullptr},
+    {"xlink2_enum",       true,  xlink2_enum::init,       nullptr,                nullptr},
+    {"sim_trace",         true,  sim_trace::init,         sim_trace::per_frame,   sim_trace::flush},
+    {"placeholder_debug", true,  placeholder_debug::init, nullptr,                nullptr},
+    {"func_trace",        false, func_trace::init,        nullptr,                func_trace::flush},
+    {"reimpl",            false, reimpl::init,            nullptr,                reimpl::flush},
+    {"state_logger",      false, state_logger::init,      state_logger::per_frame, state_logger::flush},
+    {"actor_registry",    false, actor_registry::init,    actor_registry::per_frame, actor_registry::flush},
+    {"actor_activity",    false, actor_activity::init,    actor_activity::per_frame, actor_activity::flush},
+};
+
+constexpr uint32_t PLUGIN_COUNT = sizeof(s_plugins) / sizeof(s_plugins[0]);
+
+struct HookRule {
+    uint8_t plugin;
+    char groups[64];
+};
+
+static bool s_active[PLUGIN_COUNT];
+static HookRule s_rules[MAX_HOOK_RULES];
+static uint32_t s_rule_count = 0;
+static bool s_running = false;
+
+static int find(const char* name, size_t len) {
+    for (uint32_t i = 0; i < PLUGIN_COUNT; i++)
+        if (std::strlen(s_plugins[i].name) == len && std::strncmp(s_plugins[i].name, name, len) == 0)
+            return int(i);
+    return -1;
+}
+
+static void set_listed(const char* list, bool on) {
+    cfg::for_each_token(list, [on](const char* tok, size_t len) {
+        int i = find(tok, len);
+        if (i >= 0) s_active[i] = on;
+    });
+}
+
+static void load_config() {
+    for (uint32_t i = 0; i < PLUGIN_COUNT; i++) s_active[i] = s_plugins[i].default_on;
+
+    cfg::read("plugins.cfg", [](char* line) {
+        if (std::strncmp(line, "plugins=", 8) == 0) {
+            for (bool& a : s_active) a = false;
+            set_listed(line + 8, true);
+        } else if (std::strncmp(line, "enable=", 7) == 0) {
+            set_listed(line + 7, true);
+        } else if (std::strncmp(line, "disable=", 8) == 0) {
+            set_listed(line + 8, false);
+        } else if (std::strncmp(line, "hooks.", 6) == 0) {
+            char* eq = std::strchr(line, '=');
+            int i = eq ? find(line + 6, size_t(eq - (line + 6))) : -1;
+            if (i >= 0 && s_rule_count < MAX_HOOK_RULES) {
+                HookRule& r = s_rules[s_rule_count++];
+                r.plugin = uint8_t(i);
+                std::strncpy(r.groups, eq + 1, sizeof(r.groups) - 1);
+            }
+        }
+    });
+}
+
+static void write_manifest() {
+    static log::Logger out;
+    out.init("plugins.csv");
+    out.begin_preamble();
+    out.write("name,active\n", 12);
+    out.end_preamble();
+    for (uint32_t i = 0; i < PLUGIN_COUNT; i++)
+        out.writef("%s,%d\n", s_plugins[i].name, s_active[i] ? 1 : 0);
+    out.flush();
+}
+
+void init() {
+    load_config();
+    write_manifest();
+    for (uint32_t i = 0; i < PLUGIN_COUNT; i++)
+        if (s_active[i]) s_plugins[i].init();
+    s_running = true;
+}
+
+void per_frame(uint32_t frame) {
+    if (!s_running) return;
+    for (uint32_t i = 0; i < PLUGIN_COUNT; i++)
+        if (s_active[i] && s_plugins[i].per_frame) s_plugins[i].per_frame(frame);
+
+    if (frame % FLUSH_INTERVAL == 0) {
+        for (uint32_t i = 0; i < PLUGIN_COUNT; i++)
+            if (s_active[i] && s_plugins[i].flush) s_plugins[i].flush();
+    }
+}
+
+bool active(const char* name) {
+    int i = find(name, std::strlen(name));
+    return i >= 0 && s_active[i];
+}
+
+bool hooks_enabled(const char* name, const char* group) {
+    int i = find(name, std::strlen(name));
+    if (i < 0) return false;
+    bool ruled = false;
+    bool found = false;
+    size_t glen = std::strlen(group);
+    for (uint32_t r = 0; r < s_rule_count; r++) {
+        if (s_rules[r].plugin != uint8_t(i)) continue;
+        ruled = true;
+        cfg::for_each_token(s_rules[r].groups, [&](const char* tok, size_t len) {
+            if (len == glen && std::strncmp(tok, group, len) == 0) found = true;
+        });
+    }
+    return !ruled || found;
+}
+
+} // namespace plugin
+} // namespace smm2
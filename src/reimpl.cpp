@@ -1,61 +1,178 @@
 #include "smm2/reimpl.h"
 #include "smm2/log.h"
 #include "smm2/frame.h"
+#include "smm2/perf.h"
+#include "smm2/ticks.h"
 #include "hk/hook/Trampoline.h"
 #include "hk/hook/Replace.h"
 
 namespace smm2 {
 namespace reimpl {
 
-static log::Logger mismatch_log;
+static log::Logger verify_log;
 
 // ============================================================
-// VERIFY MODE: Run both original and reimplementation,
-// log any mismatches. Game still uses original result.
+// VERIFY MODE: Run both original and reimplementation, compare
+// results and time both paths. Game still uses original result.
 // This is the safe way to validate before full replacement.
+//
+// Per delegate, in memory: call count, mismatch count, tick sums
+// and a tick histogram for each path. flush() appends one summary
+// row per delegate to verify.csv — nothing is written per call.
+//
+// The two paths alternate which runs first so neither always gets
+// the warm cache.
 // ============================================================
 
+// Histogram: exact buckets for 0..63 ticks, then one per power of two
+constexpr uint32_t EXACT_BUCKETS = 64;
+constexpr uint32_t HIST_BUCKETS = EXACT_BUCKETS + 26;
+
+struct PathStats {
+    uint64_t sum;
+    uint32_t hist[HIST_BUCKETS];
+};
+
+struct VerifyStats {
+    const char* name;
+    uint32_t calls;
+    uint32_t mismatches;
+    uint32_t first_mismatch_frame;
+    uint32_t last_state;       // cur_state / powerup at the last mismatch
+    uint32_t last_powerup;
+    PathStats orig;
+    PathStats ours;
+};
+
+static uint64_t s_overhead = 0;   // ticks for an empty now()/now() pair
+
+static uint32_t bucket(uint64_t t) {
+    if (t < EXACT_BUCKETS) return uint32_t(t);
+    uint32_t b = EXACT_BUCKETS + uint32_t(63 - __builtin_clzll(t)) - 6;
+    return b < HIST_BUCKETS ? b : HIST_BUCKETS - 1;
+}
+
+// Upper bound, in ticks, of the bucket holding the given fraction of calls
+static uint64_t percentile(const PathStats& p, uint32_t calls, uint32_t permille) {
+    uint64_t target = (uint64_t(calls) * permille + 999) / 1000;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < HIST_BUCKETS; b++) {
+        seen += p.hist[b];
+        if (seen >= target)
+            return b < EXACT_BUCKETS ? b : (2ull << (b - EXACT_BUCKETS + 6)) - 1;
+    }
+    return 0;
+}
+
+static void record(PathStats& p, uint64_t t) {
+    t = t > s_overhead ? t - s_overhead : 0;
+    p.sum += t;
+    p.hist[bucket(t)]++;
+}
+
+// orig is the bare trampoline call — PERF_ORIG's wrapper would land inside
+// the timed window — so its time is handed to the perf probe afterwards.
+template<typename Orig, typename Ours>
+static int verify_call(perf::Scope& scope, VerifyStats& s, void* player, Orig orig, Ours ours) {
+    int orig_ret, our_ret;
+    uint64_t t0, t1, t2, orig_ticks;
+    if (s.calls & 1) {
+        t0 = ticks::now(); our_ret = ours(player);
+        t1 = ticks::now(); orig_ret = orig(player);
+        t2 = ticks::now();
+        orig_ticks = t2 - t1;
+        record(s.ours, t1 - t0);
+    } else {
+        t0 = ticks::now(); orig_ret = orig(player);
+        t1 = ticks::now(); our_ret = ours(player);
+        t2 = ticks::now();
+        orig_ticks = t1 - t0;
+        record(s.ours, t2 - t1);
+    }
+    record(s.orig, orig_ticks);
+    scope.exclude(orig_ticks);
+    s.calls++;
+
+    if (orig_ret != our_ret) {
+        auto p = reinterpret_cast<uintptr_t>(player);
+        if (s.mismatches++ == 0) s.first_mismatch_frame = frame::current();
+        s.last_state = player::get<player::Field::cur_state>(p);
+        s.last_powerup = player::get<player::Field::powerup_id>(p);
+    }
+    return orig_ret;  // always use original in verify mode
+}
+
 #define DEFINE_VERIFY_HOOK(name, reimpl_func)                                    \
+static VerifyStats name##_stats = {#name};                                      \
 static HkTrampoline<int, void*> name##_verify =                                 \
     hk::hook::trampoline([](void* player) -> int {                              \
-        int orig_ret = name##_verify.orig(player);                              \
-        int our_ret = reimpl_func(player);                                      \
-        if (orig_ret != our_ret) {                                              \
-            auto p = reinterpret_cast<uintptr_t>(player);                       \
-            uint32_t state = player::read<uint32_t>(p, player::off::cur_state); \
-            uint32_t powerup = player::read<uint32_t>(p, player::off::powerup_id); \
-            mismatch_log.writef("%u," #name ",%d,%d,%u,%u\n",                   \
-                frame::current(), orig_ret, our_ret, state, powerup);           \
-        }                                                                        \
-        return orig_ret;  /* always use original in verify mode */              \
+        PERF_SCOPE(reimpl_verify);                                              \
+        return verify_call(_perf_scope, name##_stats, player,                   \
+            [](void* p) { return name##_verify.orig(p); },                      \
+            reimpl_func);                                                       \
     })
 
 // ============================================================
 // REPLACE MODE: Fully replace original with our reimplementation.
-// Use only after verify mode shows zero mismatches.
+// Use only after verify mode shows zero mismatches and ours_mean
+// not above orig_mean.
 // ============================================================
 
 // #define DEFINE_REPLACE(name, reimpl_func)
 //     static HkReplace<int, void*> name##_replace(reimpl_func)
 
-// ============================================================
-// Reimplemented functions
-// ============================================================
-
 // Slot 0: None (sub_71015E4820) — trivial, always returns 0
-DEFINE_VERIFY_HOOK(delegate_None, delegate_None);
+#define DEFINE_VERIFY(name, fn) DEFINE_VERIFY_HOOK(name, fn);
+REIMPL_VERIFY_HOOKS(DEFINE_VERIFY)
+#undef DEFINE_VERIFY
+
+#define STATS_ENTRY(name, fn) &name##_stats,
+static VerifyStats* const s_stats[] = {
+    REIMPL_VERIFY_HOOKS(STATS_ENTRY)
+};
+#undef STATS_ENTRY
+
+static void write_path(const PathStats& p, uint32_t calls) {
+    uint64_t mean_ns = calls ? ticks::to_ns(p.sum) / calls : 0;
+    verify_log.writef(",%llu,%llu", (unsigned long long)mean_ns,
+                      (unsigned long long)ticks::to_ns(percentile(p, calls, 990)));
+}
 
 void init() {
-    mismatch_log.init("mismatches.csv");
-    mismatch_log.write("frame,func,orig_ret,our_ret,state,powerup\n", 42);
+    verify_log.init("verify.csv", log::Mode::Async);
+    verify_log.begin_preamble();
+    verify_log.writef("# tick_hz=%llu — mean_ns exact over all calls, p99_ns is a bucket upper bound\n",
+                      (unsigned long long)ticks::frequency());
+    static const char header[] = "frame,func,calls,mismatches,first_mismatch_frame,last_state,"
+                                 "last_powerup,orig_mean_ns,orig_p99_ns,ours_mean_ns,ours_p99_ns\n";
+    verify_log.write(header, sizeof(header) - 1);
+    verify_log.end_preamble();
+
+    // Cheapest back-to-back read pair — subtracted from every sample
+    s_overhead = ~0ull;
+    for (int i = 0; i < 64; i++) {
+        uint64_t a = ticks::now();
+        uint64_t b = ticks::now();
+        if (b - a < s_overhead) s_overhead = b - a;
+    }
 
     // Install verify hooks
-    delegate_None_verify.installAtSym<"delegate_None">();
+#define INSTALL_VERIFY(name, fn) name##_verify.installAtSym<#name>();
+    REIMPL_VERIFY_HOOKS(INSTALL_VERIFY)
+#undef INSTALL_VERIFY
+}
 
-    // As more functions are reimplemented, add them here:
-    // delegate_Walk_verify.installAtSym<"delegate_Walk">();
-    // delegate_Landing_verify.installAtSym<"delegate_Landing">();
-    // etc.
+// Called every 300 frames from main.cpp
+void flush() {
+    for (const VerifyStats* s : s_stats) {
+        if (s->calls == 0) continue;
+        verify_log.writef("%u,%s,%u,%u,%u,%u,%u", frame::current(), s->name, s->calls,
+                          s->mismatches, s->first_mismatch_frame, s->last_state, s->last_powerup);
+        write_path(s->orig, s->calls);
+        write_path(s->ours, s->calls);
+        verify_log.write("\n", 1);
+    }
+    verify_log.flush();
 }
 
 } // namespace reimpl
@@ -1,6 +1,159 @@
+#include "smm2/sim_trace.h"
 #include "smm2/frame.h"
-namespace smm2 { namespace sim_trace {
-    void init() {}
-    void per_frame(unsigned int) {}
-    void flush() {}
-}}
+#include "smm2/log.h"
+#include "smm2/perf.h"
+#include "smm2/player.h"
+#include "smm2/status.h"
+#include "smm2/tas.h"
+
+#include <cstring>
+
+namespace smm2 {
+namespace sim_trace {
+
+static log::Logger s_log;
+
+// Player columns come straight from the field table; every one is 32-bit
+// so the snapshot is a dense row of column values.
+using SimPlayer = player::Snapshot<
+    player::Field::cur_state, player::Field::state_frames,
+    player::Field::pos_x, player::Field::pos_y,
+    player::Field::vel_x, player::Field::vel_y,
+    player::Field::target_speed, player::Field::gravity,
+    player::Field::friction, player::Field::accel>;
+
+static_assert(SimPlayer::SIZE == SimPlayer::COUNT * 4, "sim columns must be 32-bit");
+
+// Column order is the file's column order — append only
+enum Column : uint32_t {
+    COL_FRAME,
+    COL_PLAYER_FIRST,
+    COL_BUTTONS = COL_PLAYER_FIRST + SimPlayer::COUNT,
+    COL_STICK_LX,
+    COL_STICK_LY,
+    COLUMN_COUNT,
+};
+
+static SimColumnDesc s_columns[COLUMN_COUNT];
+
+static ColumnType column_type(schema::FieldType t) {
+    switch (t) {
+    case schema::FieldType::F32: return ColumnType::F32;
+    case schema::FieldType::I32: return ColumnType::I32;
+    default:                     return ColumnType::U32;
+    }
+}
+
+static void set_column(uint32_t col, const char* name, ColumnType type) {
+    std::memset(s_columns[col].name, 0, sizeof(s_columns[col].name));
+    std::strncpy(s_columns[col].name, name, sizeof(s_columns[col].name) - 1);
+    s_columns[col].type = uint8_t(type);
+}
+
+// Raw 32-bit values, one row per frame, transposed at encode time
+static uint32_t s_rows[CHUNK_FRAMES][COLUMN_COUNT];
+static uint32_t s_row_count = 0;
+
+// Worst case: 5 varint bytes per value
+static uint8_t s_chunk[sizeof(SimChunkHeader) + CHUNK_FRAMES * COLUMN_COUNT * 5];
+
+static bool s_inited = false;
+
+template<typename T>
+static uint32_t bits(T v) {
+    uint32_t u;
+    std::memcpy(&u, &v, sizeof(u));
+    return u;
+}
+
+static size_t put_varint(uint8_t* out, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = uint8_t(v) | 0x80;
+        v >>= 7;
+    }
+    out[n++] = uint8_t(v);
+    return n;
+}
+
+static void emit_chunk() {
+    if (s_row_count == 0) return;
+
+    size_t off = sizeof(SimChunkHeader);
+    for (uint32_t c = 0; c < COLUMN_COUNT; c++) {
+        uint32_t prev = 0;
+        for (uint32_t r = 0; r < s_row_count; r++) {
+            int32_t delta = int32_t(s_rows[r][c] - prev);
+            uint32_t zz = (uint32_t(delta) << 1) ^ uint32_t(delta >> 31);
+            off += put_varint(s_chunk + off, zz);
+            prev = s_rows[r][c];
+        }
+    }
+
+    SimChunkHeader hdr;
+    std::memcpy(hdr.magic, CHUNK_MAGIC, sizeof(hdr.magic));
+    hdr.frame_count = s_row_count;
+    hdr.payload_size = uint32_t(off - sizeof(SimChunkHeader));
+    hdr._pad = 0;
+    std::memcpy(s_chunk, &hdr, sizeof(hdr));
+
+    s_log.write(reinterpret_cast<const char*>(s_chunk), off);
+    s_row_count = 0;
+}
+
+void init() {
+    set_column(COL_FRAME, "frame", ColumnType::U32);
+    for (uint32_t i = 0; i < SimPlayer::COUNT; i++) {
+        schema::FieldInfo fi = player::Fields::info(SimPlayer::IDS[i]);
+        set_column(COL_PLAYER_FIRST + i, fi.name, column_type(fi.type));
+    }
+    set_column(COL_BUTTONS, "buttons", ColumnType::U32);
+    set_column(COL_STICK_LX, "stick_lx", ColumnType::I32);
+    set_column(COL_STICK_LY, "stick_ly", ColumnType::I32);
+
+    s_log.init("sim.bin", log::Mode::Async);
+
+    SimHeader hdr = {};
+    std::memcpy(hdr.magic, SIM_MAGIC, sizeof(hdr.magic));
+    hdr.version = SIM_VERSION;
+    hdr.column_count = COLUMN_COUNT;
+    hdr.chunk_frames = CHUNK_FRAMES;
+    static_assert(sizeof(hdr) + sizeof(s_columns) <= log::PREAMBLE_MAX, "sim.bin header must fit a segment preamble");
+    s_log.begin_preamble();
+    s_log.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    s_log.write(reinterpret_cast<const char*>(s_columns), sizeof(s_columns));
+    s_log.end_preamble();
+    s_inited = true;
+}
+
+// Called every frame from main.cpp, after status::update()
+void per_frame(uint32_t frame) {
+    PERF_SCOPE(sim_trace_frame);
+    if (!s_inited) return;
+
+    // status clears the pointer outside play scenes and when it goes stale
+    uintptr_t p = status::player();
+    if (p == 0) return;
+
+    tas::InputState in = tas::last_input();
+    SimPlayer snap;
+    snap.capture(p);
+
+    uint32_t* row = s_rows[s_row_count];
+    row[COL_FRAME]    = frame;
+    std::memcpy(&row[COL_PLAYER_FIRST], snap.data, SimPlayer::SIZE);
+    row[COL_BUTTONS]  = uint32_t(in.buttons);
+    row[COL_STICK_LX] = bits(in.stick_lx);
+    row[COL_STICK_LY] = bits(in.stick_ly);
+
+    if (++s_row_count == CHUNK_FRAMES) emit_chunk();
+}
+
+void flush() {
+    if (!s_inited) return;
+    emit_chunk();
+    s_log.flush();
+}
+
+} // namespace sim_trace
+} // namespace smm2
@@ -2,6 +2,7 @@
 #include "smm2/player.h"
 #include "smm2/frame.h"
 #include "smm2/game_phase.h"
+#include "smm2/perf.h"
 #include "smm2/status.h"
 #include "hk/hook/Trampoline.h"
 #include "hk/ro/RoUtil.h"
@@ -18,13 +19,14 @@ static uintptr_t tracked_player = 0;
 // x0 = PlayerObject this, w1 = new state ID
 static HkTrampoline<void, void*, uint32_t> playerChangeState_hook =
     hk::hook::trampoline([](void* player_obj, uint32_t new_state) -> void {
+        PERF_SCOPE(state_logger_player);
         auto player = reinterpret_cast<uintptr_t>(player_obj);
 
         // Read current state before change
         uint32_t old_state = player::read<uint32_t>(player, player::off::cur_state);
 
         // Call original
-        playerChangeState_hook.orig(player_obj, new_state);
+        PERF_ORIG(playerChangeState_hook.orig(player_obj, new_state));
 
         // Log transition with physics snapshot
         float pos_x = player::read<float>(player, player::off::pos_x);
@@ -40,47 +42,26 @@ static HkTrampoline<void, void*, uint32_t> playerChangeState_hook =
         tracked_player = player;
         status::set_player(player);
 
-        // Mode detection: GamePhaseManager phase 3 covers both editor AND test-play
-        // So we still need state transitions to distinguish them
-        if (old_state == 16) {
-            status::set_mode(1); // 16→any = entering play
-        }
-        if (new_state == 122) {
-            status::set_mode(2); // goal
-        }
-        if (new_state == 9) {
-            status::set_mode(3); // death
-        }
-        if ((old_state == 124 || old_state == 10) && new_state == 43) {
-            status::set_mode(0); // back to editor after goal/death anim
-        }
+        // Play / goal / death mode comes from the event bus (see status.cpp)
     });
 
-// Also keep the generic StateMachine hook for all actors
-static HkTrampoline<void, void*, uint32_t> changeState_hook =
-    hk::hook::trampoline([](void* sm, uint32_t new_state) -> void {
-        uint32_t old_state = *reinterpret_cast<uint32_t*>(
-            reinterpret_cast<uintptr_t>(sm) + 0x08);
-        changeState_hook.orig(sm, new_state);
-    });
+// Generic StateMachine changes for all actors: see actor_registry
 
 void init() {
-    state_log.init("states.csv");
+    state_log.init("states.csv", log::Mode::Async);
+    state_log.begin_preamble();
     state_log.write("frame,old_state,new_state,player_ptr,pos_x,pos_y,vel_x,vel_y\n", 62);
+    state_log.end_preamble();
     playerChangeState_hook.installAtSym<"PlayerObject_changeState">();
 
-    field_log.init("fields.csv");
+    field_log.init("fields.csv", log::Mode::Async);
+    field_log.begin_preamble();
     field_log.write("frame,state,state_frames,powerup_id,pos_x,pos_y,vel_x,vel_y,in_water\n", 69);
+    field_log.end_preamble();
 }
 
 // Called every frame from main.cpp
 void per_frame(uint32_t frame) {
-    // Flush logs periodically
-    if (frame % 300 == 0) {
-        state_log.flush();
-        field_log.flush();
-    }
-
     // Dump player fields every 10 frames if we have a tracked player
     // Guard: skip if game phase is not playing (phase 3=editor/play, 4=coursebot play)
     // During scene transitions/rebuilds (theme change, etc), player pointer may be dangling
@@ -3,21 +3,44 @@
 #include "smm2/tas.h"
 #include "smm2/game_phase.h"
 #include "smm2/course_data.h"
-#include "hk/ro/RoUtil.h"
+#include "smm2/course_map.h"
+#include "smm2/events.h"
+#include "smm2/frame.h"
+#include "smm2/paths.h"
+#include "smm2/flight_recorder.h"
+#include "smm2/load_profile.h"
+#include "smm2/log.h"
+#include "smm2/perf.h"
+#include "smm2/world.h"
 #include "hk/hook/Trampoline.h"
 #include "nn/fs.h"
+#include <atomic>
+#include <cstddef>
 #include <cstring>
 #include <cstdio>
 
 namespace smm2 {
 namespace status {
 
-static const char* STATUS_PATH = "sd:/smm2-hooks/status.bin";
+static char s_path[paths::MAX_PATH];   // status.bin in paths::dir()
 static uintptr_t s_player = 0;
 static uint8_t s_mode = 0;  // 0=editor, 1=playing
 static uint32_t s_last_procframe = 0;    // last frame from procFrame_ callback
 static uint32_t s_input_poll_frame = 0;  // monotonic counter from input polls
 
+// update() runs on the game thread (procFrame_) and on the npad poll thread
+// (fallback). If both land at once, the second caller skips its frame
+// instead of waiting — no lock on the 60 Hz poll path.
+static std::atomic_flag s_updating = ATOMIC_FLAG_INIT;
+
+static void update_locked(uint32_t frame, const world::WorldSnapshot& w);
+
+// status.bin stays open across frames; reopened only if a write fails
+static nn::fs::FileHandle s_file;
+static bool s_file_open = false;
+static StatusRingHeader s_ring;
+static uint32_t s_events_published = 0;
+
 // Hook PlayerObject_changeState to track player pointer.
 // 
 // CRITICAL: Must call orig() FIRST before any other code!
@@ -30,6 +53,7 @@ static uint32_t s_input_poll_frame = 0;  // monotonic counter from input polls
 static HkTrampoline<void, void*, uint32_t> playerChangeState_hook =
     hk::hook::trampoline([](void* player_obj, uint32_t new_state) -> void {
         playerChangeState_hook.orig(player_obj, new_state);
+        PERF_SCOPE(status_change_state);
         s_player = reinterpret_cast<uintptr_t>(player_obj);
     });
 
@@ -37,47 +61,149 @@ void set_player(uintptr_t player) {
     s_player = player;
 }
 
+uintptr_t player() {
+    return s_player;
+}
+
 void set_mode(uint8_t mode) {
     s_mode = mode;
 }
 
-static bool is_death_state(uint32_t state) {
+bool is_death_state(uint32_t state) {
     // States 9, 10 = damage/death from state_logger observations
     // State 113 = death, 114 = post-death (from 3DW captures)
     return state == 9 || state == 10 || state == 113 || state == 114;
 }
 
-static bool is_goal_state(uint32_t state) {
+bool is_goal_state(uint32_t state) {
     // 122 = GoalPole grab, 124 = GoalBackJump/enter castle
     return state == 122 || state == 124;
 }
 
+// StatusBlock.game_phase: 0=editor/unknown, 1=playing, 2=goal, 3=dead
+static void on_event(const events::Event& e) {
+    switch (events::Kind(e.kind)) {
+    case events::Kind::PlayerSpawn: s_mode = 1; break;
+    case events::Kind::Goal:        s_mode = 2; break;
+    case events::Kind::Death:       s_mode = 3; break;
+    case events::Kind::SceneChange:
+        if (e.to == 1) s_mode = 0;   // back in the editor
+        break;
+    default: break;
+    }
+}
+
+static bool open_status() {
+    if (s_file_open) return true;
+    if (nn::fs::OpenFile(&s_file, s_path, nn::fs::MODE_WRITE) != 0) {
+        // File missing — recreate it (can happen if deleted externally)
+        nn::fs::CreateFile(s_path, STATUS_FILE_SIZE);
+        if (nn::fs::OpenFile(&s_file, s_path, nn::fs::MODE_WRITE) != 0)
+            return false;  // still can't open, give up this frame
+    }
+    s_file_open = true;
+    return true;
+}
+
+static bool write_status(int64_t off, const void* data, size_t len, int flags) {
+    nn::fs::WriteOption opt = {.flags = flags};
+    if (nn::fs::WriteFile(s_file, off, data, len, opt) == 0) return true;
+    // Handle went bad — drop it and reopen next frame
+    nn::fs::CloseFile(s_file);
+    s_file_open = false;
+    return false;
+}
+
+// Seqlock publish: odd seq → slot → latest + header with even seq
+static void publish(const StatusBlock& blk) {
+    if (!open_status()) return;
+
+    uint32_t idx = s_ring.write_index;
+    s_ring.seq++;
+    if (!write_status(RING_HEADER_OFFSET + offsetof(StatusRingHeader, seq),
+                      &s_ring.seq, sizeof(s_ring.seq), 0)) {
+        s_ring.seq++;  // keep seq even for the next attempt
+        return;
+    }
+
+    StatusSlot slot;
+    slot.index = idx;
+    slot._pad = 0;
+    slot.blk = blk;
+    write_status(RING_SLOTS_OFFSET + (idx % RING_SLOTS) * sizeof(StatusSlot),
+                 &slot, sizeof(slot), 0);
+
+    // Mirror events published since the last frame (usually none)
+    uint32_t ev_end = events::written();
+    uint32_t ev = s_events_published;
+    if (ev_end - ev > events::EVENT_SLOTS) ev = ev_end - events::EVENT_SLOTS;
+    for (events::Event e; ev < ev_end && events::get(ev, e); ev++)
+        write_status(EVENTS_OFFSET + (ev % events::EVENT_SLOTS) * sizeof(e), &e, sizeof(e), 0);
+    s_events_published = ev;
+    s_ring.event_index = ev;
+
+    s_ring.write_index = idx + 1;
+    s_ring.seq++;
+    StatusFileHead head;
+    head.latest = blk;
+    head.ring = s_ring;
+    if (s_file_open)
+        write_status(0, &head, sizeof(head), nn::fs::WRITE_OPTION_FLUSH);
+}
+
 void init() {
-    nn::fs::DeleteFile(STATUS_PATH);
-    nn::fs::CreateFile(STATUS_PATH, sizeof(StatusBlock));
-    // Verify it was created by trying to open it
-    nn::fs::FileHandle f;
-    if (nn::fs::OpenFile(&f, STATUS_PATH, nn::fs::MODE_WRITE) == 0) {
-        // Zero it out
-        StatusBlock blk;
-        std::memset(&blk, 0, sizeof(blk));
-        nn::fs::WriteOption opt = {.flags = nn::fs::WRITE_OPTION_FLUSH};
-        nn::fs::WriteFile(f, 0, &blk, sizeof(blk), opt);
-        nn::fs::CloseFile(f);
+    paths::make(s_path, sizeof(s_path), "status.bin");
+    nn::fs::DeleteFile(s_path);
+    nn::fs::CreateFile(s_path, STATUS_FILE_SIZE);
+
+    std::memset(&s_ring, 0, sizeof(s_ring));
+    std::memcpy(s_ring.magic, RING_MAGIC, sizeof(s_ring.magic));
+    s_ring.version = RING_VERSION;
+    s_ring.slot_count = RING_SLOTS;
+    s_ring.slot_size = sizeof(StatusSlot);
+    s_ring.block_size = sizeof(StatusBlock);
+    s_ring.slots_offset = RING_SLOTS_OFFSET;
+    s_ring.events_offset = EVENTS_OFFSET;
+
+    // Zero the whole file so readers never see garbage slots
+    if (open_status()) {
+        static uint8_t s_zero[STATUS_FILE_SIZE];
+        std::memcpy(s_zero + RING_HEADER_OFFSET, &s_ring, sizeof(s_ring));
+        write_status(0, s_zero, sizeof(s_zero), nn::fs::WRITE_OPTION_FLUSH);
     }
     playerChangeState_hook.installAtSym<"PlayerObject_changeState">();
+
+    events::subscribe(events::bit(events::Kind::PlayerSpawn) | events::bit(events::Kind::Goal) |
+                      events::bit(events::Kind::Death) | events::bit(events::Kind::SceneChange),
+                      on_event);
 }
 
 void update_from_input_poll() {
+    // Held in the lockstep gate is not stalled: the host is stepping frames
+    // and the last StatusBlock must stay the gated frame's. Polls aren't
+    // counted either, so the counter doesn't run ahead of the frame.
+    if (frame::gated()) return;
     s_input_poll_frame++;
     // If procFrame_ hasn't fired in 30+ input polls, it's stalled (editor/menu/loading)
     // Use input poll as fallback frame source
     if (s_input_poll_frame - s_last_procframe > 30) {
-        update(s_input_poll_frame);
+        PERF_SCOPE(status_update);
+        // world::current() is the game thread's (and frozen while it stalls)
+        const world::WorldSnapshot& w = world::resolve_poll(s_input_poll_frame);
+        if (s_updating.test_and_set(std::memory_order_acquire)) return;
+        update_locked(s_input_poll_frame, w);
+        s_updating.clear(std::memory_order_release);
     }
 }
 
 void update(uint32_t frame) {
+    PERF_SCOPE(status_update);
+    if (s_updating.test_and_set(std::memory_order_acquire)) return;
+    update_locked(frame, world::current());
+    s_updating.clear(std::memory_order_release);
+}
+
+static void update_locked(uint32_t frame, const world::WorldSnapshot& w) {
     s_last_procframe = frame;
     
     // Dump OpenFile log once after system is stable (frame 100)
@@ -90,48 +216,26 @@ void update(uint32_t frame) {
     StatusBlock blk;
     std::memset(&blk, 0, sizeof(blk));
     blk.frame = frame;
-    blk.game_phase = s_mode; // 0=unknown, 1=playing, 2=goal, 3=dead
     blk.input_poll_count = tas::input_poll_count();
-    blk.real_game_phase = game_phase::read_phase();
-
-    // Get base address for pointer chains
-    static uintptr_t s_base = 0;
-    if (s_base == 0) s_base = hk::ro::getMainModule()->range().start();
+    blk.input_cmd_seq = tas::input_cmd_seq();
+    blk.input_cmd_frame = tas::input_cmd_frame();
+    blk.log_dropped = log::dropped_records();
+    blk.timing = frame::timing();
+    blk.real_game_phase = w.phase;  // game_phase::read_phase(), from this snapshot
 
     // READ SCENE_MODE FIRST - determines if player data is valid
-    // GamePhaseManager: [[main+0x2C57D58]+0x30] = inner struct
-    blk.scene_mode = 0;
-    blk.is_playing = 0;
-    blk.game_style = 0;
-    for (int i = 0; i < 6; i++) blk.gpm_inner[i] = 0;
-    if (s_base != 0) {
-        uintptr_t* gpm = reinterpret_cast<uintptr_t*>(s_base + 0x2C57D58);
-        if (*gpm > 0x1000000ULL && *gpm < 0x3000000000ULL) {
-            uintptr_t* inner = reinterpret_cast<uintptr_t*>(*gpm + 0x30);
-            if (*inner > 0x1000000ULL && *inner < 0x3000000000ULL) {
-                blk.scene_mode = *reinterpret_cast<uint32_t*>(*inner + 0x14); // 1=editor, 5=play, 6=title
-                blk.is_playing = *reinterpret_cast<uint32_t*>(*inner + 0x10);
-                blk.game_style = *reinterpret_cast<uint32_t*>(*inner + 0x1C);
-                for (int i = 0; i < 6; i++) {
-                    blk.gpm_inner[i] = *reinterpret_cast<uint32_t*>(*inner + i * 4);
-                }
-            }
-        }
-    }
+    // GamePhaseManager chain is resolved by world::resolve() — the frame's
+    // snapshot, or the fallback's own
+    blk.scene_mode = w.scene_mode; // 1=editor, 5=play, 6=title
+    blk.is_playing = w.is_playing;
+    blk.game_style = w.game_style;
+    for (int i = 0; i < 6; i++) blk.gpm_inner[i] = w.gpm_inner[i];
     
-    // Track scene changes for instant navigation detection
-    static uint32_t s_prev_scene_mode = 0;
-    static uint32_t s_scene_change_count = 0;
-    if (blk.scene_mode != s_prev_scene_mode) {
-        s_scene_change_count++;
-        s_prev_scene_mode = blk.scene_mode;
-    }
-    blk.scene_change_count = s_scene_change_count;
+    load_profile::per_frame(frame, blk.scene_mode);
 
     // CRITICAL: Only trust player data when actually playing
-    // scene_mode 5 = editor test-play, scene_mode 7 = coursebot play
     // Clear player pointer when not in play mode to prevent stale data
-    if (blk.scene_mode != 5 && blk.scene_mode != 7) {
+    if (!is_play_scene(blk.scene_mode)) {
         s_player = 0;
     }
 
@@ -155,26 +259,32 @@ void update(uint32_t frame) {
     }
 
     // Guard: only read player fields when player pointer is valid AND in play mode
-    // scene_mode 5 = editor test-play, scene_mode 7 = coursebot play
-    if (s_player != 0 && (blk.scene_mode == 5 || blk.scene_mode == 7)) {
-        blk.player_state  = player::read<uint32_t>(s_player, player::off::cur_state);
-        blk.powerup_id    = player::read<uint32_t>(s_player, player::off::powerup_id);
-        blk.pos_x         = player::read<float>(s_player, player::off::pos_x);
-        blk.pos_y         = player::read<float>(s_player, player::off::pos_y);
-        blk.vel_x         = player::read<float>(s_player, player::off::vel_x);
-        blk.vel_y         = player::read<float>(s_player, player::off::vel_y);
-        blk.state_frames  = player::read<uint32_t>(s_player, player::off::state_frames);
-        blk.in_water      = player::read<uint8_t>(s_player, player::off::in_water);
-        blk.facing        = player::read<float>(s_player, 0x26C);
-        blk.gravity       = player::read<float>(s_player, 0x27C);
-        blk.buffered_action = player::read<uint32_t>(s_player, 0x4BC);
+    if (s_player != 0 && is_play_scene(blk.scene_mode)) {
+        using player::Field;
+        blk.player_state  = player::get<Field::cur_state>(s_player);
+        blk.powerup_id    = player::get<Field::powerup_id>(s_player);
+        blk.pos_x         = player::get<Field::pos_x>(s_player);
+        blk.pos_y         = player::get<Field::pos_y>(s_player);
+        blk.vel_x         = player::get<Field::vel_x>(s_player);
+        blk.vel_y         = player::get<Field::vel_y>(s_player);
+        blk.state_frames  = player::get<Field::state_frames>(s_player);
+        blk.in_water      = player::get<Field::in_water>(s_player);
+        blk.facing        = player::read<float>(s_player, player::off::facing);  // float view of the U32 field
+        blk.gravity       = player::get<Field::gravity>(s_player);
+        blk.buffered_action = uint32_t(player::get<Field::buffered_action>(s_player));
         blk.is_dead       = is_death_state(blk.player_state) ? 1 : 0;
         blk.is_goal       = is_goal_state(blk.player_state) ? 1 : 0;
         blk.has_player    = 1;
+        if (course_map::generation() != 0) {
+            int tx = course_map::to_tile(blk.pos_x), ty = course_map::to_tile(blk.pos_y);
+            course_map::MapObject near[NEAR_MAX];
+            blk.near_objects = uint16_t(course_map::near(0, tx, ty, NEAR_RADIUS, near, NEAR_MAX));
+            blk.player_cell  = course_map::cell(0, tx, ty);
+        }
         // Debug: player pointer for GDB
         blk.player_ptr    = s_player;
         // Debug: wearable detection candidates
-        blk.carried_obj   = player::read<uint64_t>(s_player, 0x2718);
+        blk.carried_obj   = player::get<Field::carried_object>(s_player);
         blk.carried_obj_2 = player::read<uint64_t>(s_player, 0x2A30);
         blk.debug_field_1 = player::read<uint32_t>(s_player, 0x22E4); // powerup_flags
         blk.debug_field_2 = player::read<uint32_t>(s_player, 0x2720);
@@ -194,31 +304,17 @@ void update(uint32_t frame) {
         }
     }
 
-    // Read course theme from noexes pointer chain:
-    // [[main+0x2A67B70]+0x28]+0x210 = theme byte (0=ground, 1=underground, etc.)
-    // Source: noexes-patches.md (well-known patch addresses)
-    blk.course_theme = 0xFF; // unknown
-    if (s_base != 0) {
-        // Follow pointer chain: main+0x2A67B70 → [+0x28] → theme at +0x210
-        uintptr_t* p1 = reinterpret_cast<uintptr_t*>(s_base + 0x2A67B70);
-        if (*p1 > 0x1000000ULL && *p1 < 0x3000000000ULL) {
-            uintptr_t* p2 = reinterpret_cast<uintptr_t*>(*p1 + 0x28);
-            if (*p2 > 0x1000000ULL && *p2 < 0x3000000000ULL) {
-                blk.course_theme = *reinterpret_cast<uint8_t*>(*p2 + 0x210);
-            }
-        }
-    }
+    // Course theme: [[main+0x2A67B70]+0x28]+0x210 (0=ground, 1=underground, etc.)
+    blk.course_theme = w.course_theme;
 
-    nn::fs::FileHandle f;
-    if (nn::fs::OpenFile(&f, STATUS_PATH, nn::fs::MODE_WRITE) != 0) {
-        // File missing — recreate it (can happen if deleted externally)
-        nn::fs::CreateFile(STATUS_PATH, sizeof(StatusBlock));
-        if (nn::fs::OpenFile(&f, STATUS_PATH, nn::fs::MODE_WRITE) != 0)
-            return;  // still can't open, give up this frame
-    }
-    nn::fs::WriteOption opt = {.flags = nn::fs::WRITE_OPTION_FLUSH};
-    nn::fs::WriteFile(f, 0, &blk, sizeof(blk), opt);
-    nn::fs::CloseFile(f);
+    // Scene / phase / player transitions are detected once, in the event bus
+    events::update({frame, blk.real_game_phase, blk.scene_mode,
+                    blk.has_player ? s_player : 0, blk.player_state});
+    blk.game_phase = s_mode;
+    blk.scene_change_count = events::scene_changes();
+
+    flight_recorder::record_status(blk);
+    publish(blk);
 }
 
 } // namespace status
@@ -1,7 +1,13 @@
 #include "smm2/tas.h"
+#include "smm2/boot_tables.h"
+#include "smm2/cfg.h"
 #include "smm2/frame.h"
 #include "smm2/status.h"
 #include "smm2/log.h"
+#include "smm2/paths.h"
+#include "smm2/perf.h"
+#include "smm2/player.h"
+#include "smm2/world.h"
 #include "nn/hid.h"
 #include "nn/fs.h"
 #include "hk/hook/Trampoline.h"
@@ -16,97 +22,162 @@ namespace tas {
 // ============================================================
 // Two modes of input injection:
 //
-// 1. SCRIPT MODE: reads tas.csv at boot, plays back keyframes
+// 1. SCRIPT MODE: streams keyframes from tas.bin during playback
 //    Good for reproducible test sequences.
 //
-// 2. LIVE MODE: polls sd:/smm2-hooks/input.bin every frame
-//    8 bytes: buttons(u64). Written by host, read by hook.
+// 2. LIVE MODE: consumes the host's command ring in input_cmd.bin
+//    (see tas.h). Frame-exact, nothing re-read while it is unchanged.
 //    Good for real-time remote control from WSL.
 //
-// If tas.csv exists → script mode. Otherwise → live mode.
+// 3. BATCH MODE: runs every script listed in batch.txt back to back,
+//    restarting the course itself between runs (see tas.h).
+//
+// batch.txt → batch mode, else tas.bin → script mode, else live mode.
+// Record mode (tas.cfg record=1) runs alongside any of them.
 // ============================================================
 
 // --- Script mode ---
-constexpr int MAX_KEYFRAMES = 2048;
-
-struct Keyframe {
-    uint32_t frame;
-    uint64_t buttons;
-    int32_t stick_lx;
-    int32_t stick_ly;
-};
+// s_window is a ring indexed by absolute keyframe number mod
+// WINDOW_KEYFRAMES. s_loaded is how many keyframes have been read from the
+// file, script_idx how many have been applied; a refill happens whenever
+// REFILL_KEYFRAMES slots are free. Reads are aligned to REFILL_KEYFRAMES so
+// a refill never wraps the ring.
 
-static Keyframe script[MAX_KEYFRAMES];
-static int script_len = 0;
-static int script_idx = 0;
+static TasKeyframe s_window[WINDOW_KEYFRAMES];
+static nn::fs::FileHandle s_script_file;
+static uint32_t script_len = 0;     // keyframe_count from the header
+static uint32_t s_loaded = 0;
+static uint32_t script_idx = 0;
+static uint32_t s_script_base = 0;  // keyframe frames are relative to this
 static bool script_active = false;
+static bool s_script_open = false;
+static bool s_exact = false;        // TAS_FLAG_EXACT: replace, don't OR
 
-static bool load_script() {
-    nn::fs::FileHandle f;
-    if (nn::fs::OpenFile(&f, "sd:/smm2-hooks/tas.csv", nn::fs::MODE_READ) != 0)
+static void close_script() {
+    if (!s_script_open) return;
+    nn::fs::CloseFile(s_script_file);
+    s_script_open = false;
+    script_len = s_loaded;   // nothing more to read
+}
+
+// Check the header only — keyframes are read lazily on the first poll
+static bool open_script(const char* path) {
+    if (nn::fs::OpenFile(&s_script_file, path, nn::fs::MODE_READ) != 0)
         return false;
 
-    char buf[65536];
+    TasHeader hdr;
     size_t bytes_read = 0;
-    nn::fs::ReadFile(&bytes_read, f, 0, buf, sizeof(buf) - 1);
-    nn::fs::CloseFile(f);
-    buf[bytes_read] = '\0';
+    nn::fs::ReadFile(&bytes_read, s_script_file, 0, &hdr, sizeof(hdr));
+    if (bytes_read != sizeof(hdr) ||
+        std::memcmp(hdr.magic, TAS_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.version != TAS_VERSION ||
+        hdr.keyframe_size != sizeof(TasKeyframe) ||
+        hdr.keyframe_count == 0) {
+        nn::fs::CloseFile(s_script_file);
+        return false;
+    }
 
-    script_len = 0;
-    char* line = buf;
+    script_len = hdr.keyframe_count;
+    s_exact = (hdr.flags & TAS_FLAG_EXACT) != 0;
+    s_script_open = true;
+    s_loaded = 0;
+    script_idx = 0;
+    return true;
+}
 
-    // Skip header
-    char* nl = std::strchr(line, '\n');
-    if (nl) line = nl + 1;
+static void refill_script() {
+    while (s_script_open && s_loaded < script_len && s_loaded - script_idx <= WINDOW_KEYFRAMES - REFILL_KEYFRAMES) {
+        uint32_t n = script_len - s_loaded;
+        if (n > REFILL_KEYFRAMES) n = REFILL_KEYFRAMES;
 
-    while (*line && script_len < MAX_KEYFRAMES) {
-        Keyframe& kf = script[script_len];
-        kf.frame = (uint32_t)std::strtoul(line, &line, 10);
-        if (*line == ',') line++;
-        kf.buttons = (uint64_t)std::strtoull(line, &line, 0);
-        if (*line == ',') line++;
-        kf.stick_lx = (int32_t)std::strtol(line, &line, 10);
-        if (*line == ',') line++;
-        kf.stick_ly = (int32_t)std::strtol(line, &line, 10);
-        while (*line && *line != '\n') line++;
-        if (*line == '\n') line++;
-        script_len++;
-    }
+        int64_t off = sizeof(TasHeader) + int64_t(s_loaded) * sizeof(TasKeyframe);
+        size_t bytes_read = 0;
+        nn::fs::ReadFile(&bytes_read, s_script_file, off,
+                         &s_window[s_loaded % WINDOW_KEYFRAMES], n * sizeof(TasKeyframe));
+        s_loaded += uint32_t(bytes_read / sizeof(TasKeyframe));
 
-    return script_len > 0;
+        // Short read: file is shorter than its header claims
+        if (bytes_read < n * sizeof(TasKeyframe)) {
+            close_script();
+            return;
+        }
+    }
+    if (s_loaded == script_len) close_script();
 }
 
 // --- Live mode ---
-struct LiveInput {
-    uint64_t buttons;
-    int32_t stick_lx;
-    int32_t stick_ly;
-};
+// s_cmds mirrors the file's slots; s_fetched is the last seq copied in,
+// s_applied the last seq applied. s_fetched - s_applied <= CMD_SLOTS.
+// s_injected is s_applied as of the last poll that returned states.
 
 static bool live_mode = false;
+static nn::fs::FileHandle s_cmd_file;
+static InputCmd s_cmds[CMD_SLOTS];
+static uint32_t s_fetched = 0;
+static uint32_t s_applied = 0;
+static uint32_t s_injected = 0;
+static uint32_t s_injected_frame = 0;
 
-static bool read_live_input(LiveInput& out) {
+static bool open_cmd_ring() {
+    char path[paths::MAX_PATH];
+    paths::make(path, sizeof(path), "input_cmd.bin");
+    if (nn::fs::OpenFile(&s_cmd_file, path, nn::fs::MODE_READ) == 0) {
+        // Start from the host's current position — commands left over from
+        // a previous boot are never replayed
+        InputCmdHeader hdr;
+        size_t bytes_read = 0;
+        nn::fs::ReadFile(&bytes_read, s_cmd_file, 0, &hdr, sizeof(hdr));
+        if (bytes_read == sizeof(hdr) && std::memcmp(hdr.magic, CMD_MAGIC, sizeof(hdr.magic)) == 0)
+            s_fetched = s_applied = hdr.write_seq;
+        return true;
+    }
+
+    // First boot: create an empty ring so the host can open it in place
+    nn::fs::CreateFile(path, sizeof(InputCmdHeader) + CMD_SLOTS * sizeof(InputCmd));
+    InputCmdHeader hdr = {};
+    std::memcpy(hdr.magic, CMD_MAGIC, sizeof(hdr.magic));
+    hdr.slot_count = CMD_SLOTS;
     nn::fs::FileHandle f;
-    if (nn::fs::OpenFile(&f, "sd:/smm2-hooks/input.bin", nn::fs::MODE_READ) != 0)
-        return false;
+    if (nn::fs::OpenFile(&f, path, nn::fs::MODE_WRITE) == 0) {
+        nn::fs::WriteFile(f, 0, &hdr, sizeof(hdr), {nn::fs::WRITE_OPTION_FLUSH});
+        nn::fs::CloseFile(f);
+    }
+    return nn::fs::OpenFile(&s_cmd_file, path, nn::fs::MODE_READ) == 0;
+}
 
-    uint8_t buf[16];
+// Copy newly published slots into s_cmds
+static void fetch_commands() {
+    InputCmdHeader hdr;
     size_t bytes_read = 0;
-    nn::fs::ReadFile(&bytes_read, f, 0, buf, sizeof(buf));
-    nn::fs::CloseFile(f);
-
-    if (bytes_read >= 8) {
-        std::memcpy(&out.buttons, buf, 8);
-        if (bytes_read >= 16) {
-            std::memcpy(&out.stick_lx, buf + 8, 4);
-            std::memcpy(&out.stick_ly, buf + 12, 4);
-        } else {
-            out.stick_lx = 0;
-            out.stick_ly = 0;
+    nn::fs::ReadFile(&bytes_read, s_cmd_file, 0, &hdr, sizeof(hdr));
+    if (bytes_read != sizeof(hdr) || std::memcmp(hdr.magic, CMD_MAGIC, sizeof(hdr.magic)) != 0)
+        return;
+
+    uint32_t w = hdr.write_seq;
+    if (w == s_fetched) return;
+    if (w < s_fetched) {
+        s_fetched = s_applied = w;
+        return;
+    }
+
+    while (s_fetched < w && s_fetched - s_applied < CMD_SLOTS) {
+        // Contiguous run of slots, never past the end of the ring
+        uint32_t first = s_fetched % CMD_SLOTS;
+        uint32_t n = w - s_fetched;
+        if (n > CMD_SLOTS - (s_fetched - s_applied)) n = CMD_SLOTS - (s_fetched - s_applied);
+        if (n > CMD_SLOTS - first) n = CMD_SLOTS - first;
+
+        int64_t off = sizeof(InputCmdHeader) + int64_t(first) * sizeof(InputCmd);
+        nn::fs::ReadFile(&bytes_read, s_cmd_file, off, &s_cmds[first], n * sizeof(InputCmd));
+        uint32_t got = uint32_t(bytes_read / sizeof(InputCmd));
+
+        for (uint32_t i = 0; i < got; i++) {
+            if (s_cmds[first + i].seq != s_fetched + 1)
+                return;   // host hasn't finished this slot — retry next poll
+            s_fetched++;
         }
-        return true;
+        if (got < n) return;
     }
-    return false;
 }
 
 // --- Shared state ---
@@ -114,20 +185,327 @@ static uint64_t cur_buttons = 0;
 static int32_t cur_lx = 0;
 static int32_t cur_ly = 0;
 static uint32_t s_input_poll_count = 0;  // increments each GetNpadStates call
+static InputState s_last_input = {};     // post-injection state of out[0]
+
+// --- tas.cfg ---
+static bool s_record_cfg = false;
+
+static void load_config() {
+    cfg::read("tas.cfg", [](char* line) {
+        if (std::strncmp(line, "record=", 7) == 0)
+            s_record_cfg = std::atoi(line + 7) != 0;
+    });
+}
+
+// --- Batch mode ---
+// Advanced once per input poll (polls run in every scene; procFrame_ only
+// in play, so scenes come from world::resolve_poll(), not current()):
+//   WaitSpawn  — play scene with a live player → open the next run's script
+//   Running    — script playing; watch for goal / death / timeout
+//   Returning  — wait for test play to drop back to the editor, tapping
+//                MINUS if it doesn't within RETURN_GRACE_POLLS
+//   Restarting — long-press MINUS in the editor (reset to start + play)
+//   Done       — manifest exhausted, input left alone
+
+constexpr uint32_t RETURN_GRACE_POLLS = 180;
+constexpr uint32_t MINUS_TAP_POLLS = 12;
+constexpr uint32_t RESTART_SETTLE_POLLS = 30;
+constexpr uint32_t RESTART_HOLD_POLLS = 90;    // long press, as automate.enter_play_reset
+constexpr uint32_t RESTART_RETRY_POLLS = 600;
+
+enum class BatchPhase : uint8_t {
+    Off,
+    WaitSpawn,
+    Running,
+    Returning,
+    Restarting,
+    Done,
+};
+
+static BatchPhase s_batch = BatchPhase::Off;
+static nn::fs::FileHandle s_manifest;
+static int64_t s_manifest_off = 0;
+static uint32_t s_line = 0;           // manifest line of the next run
+static uint32_t s_run_index = 0;      // manifest line of the current run
+static uint32_t s_run_timeout = 0;
+static uint32_t s_phase_polls = 0;
+static log::Logger s_results;
+
+static bool open_manifest() {
+    if (!paths::open_read(&s_manifest, "batch.txt"))
+        return false;
+
+    s_results.init("batch_results.bin", log::Mode::Async);
+    BatchResultsHeader hdr = {};
+    std::memcpy(hdr.magic, BATCH_MAGIC, sizeof(hdr.magic));
+    hdr.version = BATCH_VERSION;
+    hdr.record_size = sizeof(BatchResult);
+    s_results.begin_preamble();
+    s_results.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    s_results.end_preamble();
+    s_results.flush();
+    return true;
+}
+
+static void record_result(Outcome outcome, uintptr_t p, uint32_t frames) {
+    BatchResult r = {};
+    r.run_index = s_run_index;
+    r.outcome = uint32_t(outcome);
+    r.frames = frames;
+    r.start_frame = s_script_base;
+    r.keyframes = script_idx;
+    if (p) {
+        r.end_state = player::read<uint32_t>(p, player::off::cur_state);
+        r.end_x = player::read<float>(p, player::off::pos_x);
+        r.end_y = player::read<float>(p, player::off::pos_y);
+    }
+    s_results.write(reinterpret_cast<const char*>(&r), sizeof(r));
+    s_results.flush();
+}
+
+// Read manifest lines until one opens as a script. False at end of file.
+static bool next_run() {
+    char buf[160];
+    for (;;) {
+        size_t bytes_read = 0;
+        nn::fs::ReadFile(&bytes_read, s_manifest, s_manifest_off, buf, sizeof(buf) - 1);
+        if (bytes_read == 0) return false;
+        buf[bytes_read] = '\0';
+
+        char* eol = std::strchr(buf, '\n');
+        if (eol) *eol = '\0';
+        s_manifest_off += eol ? (eol - buf) + 1 : int64_t(bytes_read);
+        uint32_t line = s_line++;
+
+        char* name = buf;
+        while (*name == ' ' || *name == '\t') name++;
+        char* end = name;
+        while (*end && *end != ' ' && *end != '\t' && *end != '\r') end++;
+        if (end == name || *name == '#') continue;
+        char* rest = *end ? end + 1 : end;
+        *end = '\0';
+
+        uint32_t timeout = (uint32_t)std::strtoul(rest, nullptr, 10);
+        s_run_timeout = timeout ? timeout : BATCH_DEFAULT_TIMEOUT;
+        s_run_index = line;
+
+        char path[paths::MAX_PATH];
+        if (std::strncmp(name, "sd:", 3) == 0)
+            std::snprintf(path, sizeof(path), "%s", name);
+        else
+            paths::find(path, sizeof(path), name);
+        if (open_script(path)) return true;
+
+        script_idx = 0;
+        record_result(Outcome::ScriptError, 0, 0);
+    }
+}
+
+static void enter(BatchPhase phase) {
+    s_batch = phase;
+    s_phase_polls = 0;
+}
+
+static void finish_run(Outcome outcome, uintptr_t p) {
+    record_result(outcome, p, frame::current() - s_script_base);
+    close_script();
+    script_active = false;
+    cur_buttons = 0;
+    cur_lx = 0;
+    cur_ly = 0;
+    enter(BatchPhase::Returning);
+    // A timed-out run is still playing — don't wait for an automatic return
+    if (outcome == Outcome::Timeout) s_phase_polls = RETURN_GRACE_POLLS;
+}
+
+static void update_batch(const world::WorldSnapshot& w) {
+    uintptr_t p = status::player();
+    s_phase_polls++;
+
+    switch (s_batch) {
+    case BatchPhase::WaitSpawn: {
+        if (!status::is_play_scene(w.scene_mode) || p == 0) break;
+        uint32_t state = player::read<uint32_t>(p, player::off::cur_state);
+        if (status::is_death_state(state) || status::is_goal_state(state)) break;
+        if (!next_run()) {
+            nn::fs::CloseFile(s_manifest);
+            enter(BatchPhase::Done);
+            break;
+        }
+        s_script_base = frame::current();
+        script_active = true;
+        enter(BatchPhase::Running);
+        break;
+    }
+    case BatchPhase::Running: {
+        if (!status::is_play_scene(w.scene_mode)) {
+            finish_run(Outcome::Aborted, 0);
+            break;
+        }
+        if (s_phase_polls >= s_run_timeout) {
+            finish_run(Outcome::Timeout, p);
+            break;
+        }
+        if (p == 0) break;   // pointer briefly stale — check again next poll
+        uint32_t state = player::read<uint32_t>(p, player::off::cur_state);
+        if (status::is_goal_state(state))
+            finish_run(Outcome::Goal, p);
+        else if (status::is_death_state(state))
+            finish_run(Outcome::Death, p);
+        break;
+    }
+    case BatchPhase::Returning: {
+        if (w.scene_mode == status::SCENE_EDITOR) {
+            cur_buttons = 0;
+            enter(BatchPhase::Restarting);
+            break;
+        }
+        uint32_t t = s_phase_polls >= RETURN_GRACE_POLLS ? (s_phase_polls - RETURN_GRACE_POLLS) % RETURN_GRACE_POLLS : ~0u;
+        cur_buttons = t < MINUS_TAP_POLLS ? btn::MINUS : 0;
+        break;
+    }
+    case BatchPhase::Restarting: {
+        if (s_phase_polls > RESTART_SETTLE_POLLS + RESTART_HOLD_POLLS && status::is_play_scene(w.scene_mode)) {
+            cur_buttons = 0;
+            enter(BatchPhase::WaitSpawn);
+            break;
+        }
+        bool hold = s_phase_polls >= RESTART_SETTLE_POLLS &&
+                    s_phase_polls < RESTART_SETTLE_POLLS + RESTART_HOLD_POLLS;
+        cur_buttons = hold ? btn::MINUS : 0;
+        if (s_phase_polls >= RESTART_RETRY_POLLS) s_phase_polls = 0;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// --- Record mode ---
+// Runs on the poll thread only, like every other tas logger. s_rec_pend is
+// the keyframe for the frame being polled (the last poll of a frame wins);
+// once the frame moves on it is written if it differs from the last
+// keyframe written.
+
+static bool s_take = false;          // a take is being recorded
+static log::Logger s_rec;
+static uint32_t s_rec_seq = 0;       // next rec_NNN.bin to try
+static uint32_t s_rec_base = 0;      // keyframe frames are relative to this
+static TasKeyframe s_rec_pend = {};
+static TasKeyframe s_rec_last = {};
+static bool s_rec_started = false;   // s_rec_pend holds a poll
+static uint32_t s_rec_written = 0;
+static uint32_t s_rec_flushed = 0;   // frame of the last flush
+
+static int16_t clamp_stick(int32_t v) {
+    return int16_t(v < -32768 ? -32768 : v > 32767 ? 32767 : v);
+}
+
+// First free rec_NNN.bin — never one a batch replay may be reading
+static bool start_take(uint32_t base) {
+    char name[32], path[paths::MAX_PATH];
+    for (; s_rec_seq < REC_MAX_TAKES; s_rec_seq++) {
+        std::snprintf(name, sizeof(name), "rec_%03u.bin", s_rec_seq);
+        nn::fs::FileHandle f;
+        paths::make(path, sizeof(path), name);
+        if (nn::fs::OpenFile(&f, path, nn::fs::MODE_READ) != 0) break;
+        nn::fs::CloseFile(f);
+    }
+    if (s_rec_seq >= REC_MAX_TAKES) return false;
+    s_rec_seq++;
+
+    s_rec.init(name, log::Mode::Async);
+    TasHeader hdr = {};
+    std::memcpy(hdr.magic, TAS_MAGIC, sizeof(hdr.magic));
+    hdr.version = TAS_VERSION;
+    hdr.keyframe_size = sizeof(TasKeyframe);
+    hdr.keyframe_count = TAS_COUNT_STREAMED;
+    hdr.flags = TAS_FLAG_EXACT;
+    s_rec.begin_preamble();
+    s_rec.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    s_rec.end_preamble();
+    s_rec.flush();
+
+    s_rec_base = base;
+    s_rec_started = false;
+    s_rec_written = 0;
+    s_rec_flushed = 0;
+    s_take = true;
+    return true;
+}
+
+static void emit_pending() {
+    const TasKeyframe& a = s_rec_pend;
+    const TasKeyframe& b = s_rec_last;
+    if (!s_rec_started) return;
+    if (s_rec_written && a.buttons == b.buttons && a.stick_lx == b.stick_lx && a.stick_ly == b.stick_ly)
+        return;
+    s_rec.write(reinterpret_cast<const char*>(&s_rec_pend), sizeof(s_rec_pend));
+    s_rec_last = s_rec_pend;
+    s_rec_written++;
+}
+
+static void end_take() {
+    emit_pending();
+    s_rec.flush();
+    s_take = false;
+}
+
+// Start / end takes on the scene, as batch mode spots a spawn. w is the
+// poll thread's snapshot: current() stays frozen at the last play frame
+// once the player drops to the editor.
+static void update_recording(const world::WorldSnapshot& w) {
+    if (s_take) {
+        if (!status::is_play_scene(w.scene_mode)) end_take();
+        return;
+    }
+    uintptr_t p = status::player();
+    if (!status::is_play_scene(w.scene_mode) || p == 0) return;
+    uint32_t state = player::read<uint32_t>(p, player::off::cur_state);
+    if (status::is_death_state(state) || status::is_goal_state(state)) return;
+    // A batch run started this poll shares its base, so batch replays line up
+    start_take(s_batch == BatchPhase::Running ? s_script_base : frame::current());
+}
+
+static void record_input(const nn::hid::full_key_state& s) {
+    uint32_t f = frame::current() - s_rec_base;
+    if (s_rec_started && f != s_rec_pend.frame) {
+        emit_pending();
+        if (f - s_rec_flushed >= REC_FLUSH_FRAMES) {
+            s_rec.flush();
+            s_rec_flushed = f;
+        }
+    }
+    s_rec_pend.frame = f;
+    s_rec_pend.stick_lx = clamp_stick(s.sl_x);
+    s_rec_pend.stick_ly = clamp_stick(s.sl_y);
+    s_rec_pend.buttons = s.buttons;
+    s_rec_started = true;
+}
 
 // Common input update logic (called from any NpadStates variant hook)
 static void update_input() {
     s_input_poll_count++;
     // Fallback status update — fires in ALL scenes (editor, menu, loading)
     status::update_from_input_poll();
+    // Boot capture settles here in menus, where procFrame_ may not run
+    boot_tables::poll();
+
+    if (s_batch != BatchPhase::Off || s_record_cfg) {
+        const world::WorldSnapshot& w = world::resolve_poll(frame::current());
+        if (s_batch != BatchPhase::Off) update_batch(w);
+        if (s_record_cfg) update_recording(w);
+    }
 
     // Script mode: advance keyframes
-    if (script_active && script_len > 0) {
+    if (script_active) {
+        refill_script();
         uint32_t f = frame::current();
-        while (script_idx < script_len && script[script_idx].frame <= f) {
-            cur_buttons = script[script_idx].buttons;
-            cur_lx = script[script_idx].stick_lx;
-            cur_ly = script[script_idx].stick_ly;
+        while (script_idx < s_loaded && s_window[script_idx % WINDOW_KEYFRAMES].frame + s_script_base <= f) {
+            const TasKeyframe& kf = s_window[script_idx % WINDOW_KEYFRAMES];
+            cur_buttons = kf.buttons;
+            cur_lx = kf.stick_lx;
+            cur_ly = kf.stick_ly;
             script_idx++;
         }
         if (script_idx >= script_len && cur_buttons == 0) {
@@ -135,29 +513,52 @@ static void update_input() {
         }
     }
 
-    // Live mode: read input file every 2 frames
-    if (live_mode && (frame::current() % 2 == 0)) {
-        LiveInput inp;
-        if (read_live_input(inp)) {
-            cur_buttons = inp.buttons;
-            cur_lx = inp.stick_lx;
-            cur_ly = inp.stick_ly;
+    // Live mode: apply due commands from the ring
+    if (live_mode) {
+        fetch_commands();
+        uint32_t f = frame::current();
+        while (s_applied < s_fetched) {
+            const InputCmd& cmd = s_cmds[s_applied % CMD_SLOTS];
+            if (cmd.frame != CMD_FRAME_NEXT && cmd.frame > f) break;
+            cur_buttons = cmd.buttons;
+            cur_lx = cmd.stick_lx;
+            cur_ly = cmd.stick_ly;
+            s_applied++;
+            if (cmd.frame == CMD_FRAME_NEXT) break;
         }
     }
 }
 
 static void inject_buttons(nn::hid::full_key_state* out, int written) {
+    bool exact = script_active && s_exact;
     for (int i = 0; i < written; i++) {
+        if (exact) {
+            out[i].buttons = cur_buttons;
+            out[i].sl_x = cur_lx;
+            out[i].sl_y = cur_ly;
+            continue;
+        }
         out[i].buttons |= cur_buttons;
         if (cur_lx != 0) out[i].sl_x = cur_lx;
         if (cur_ly != 0) out[i].sl_y = cur_ly;
     }
+    if (written > 0) {
+        if (s_take) record_input(out[0]);
+        s_last_input.buttons = out[0].buttons;
+        s_last_input.stick_lx = out[0].sl_x;
+        s_last_input.stick_ly = out[0].sl_y;
+        if (s_injected != s_applied) {
+            s_injected = s_applied;
+            s_injected_frame = frame::current();
+        }
+    }
 }
 
 // Hook GetNpadStates(NpadFullKeyState*) — Pro Controller
 static HkTrampoline<int, nn::hid::full_key_state*, int, const uint32_t&> npad_fullkey_hook =
     hk::hook::trampoline([](nn::hid::full_key_state* out, int count, const uint32_t& id) -> int {
         int written = npad_fullkey_hook.orig(out, count, id);
+        PERF_SCOPE(tas_npad);
         update_input();
         inject_buttons(out, written);
         return written;
@@ -167,15 +568,29 @@ uint32_t input_poll_count() {
     return s_input_poll_count;
 }
 
+uint32_t input_cmd_seq() {
+    return s_injected;
+}
+
+uint32_t input_cmd_frame() {
+    return s_injected_frame;
+}
+
+InputState last_input() {
+    return s_last_input;
+}
+
 void init() {
-    if (load_script()) {
+    load_config();
+
+    char script[paths::MAX_PATH];
+    if (open_manifest()) {
+        s_batch = BatchPhase::WaitSpawn;
+    } else if (paths::find(script, sizeof(script), "tas.bin") && open_script(script)) {
         script_active = true;
-        script_idx = 0;
     } else {
-        // No script → try live mode
-        // Create input.bin if it doesn't exist
-        nn::fs::CreateFile("sd:/smm2-hooks/input.bin", 16);
-        live_mode = true;
+        // No script → live mode via the command ring
+        live_mode = open_cmd_ring();
     }
 
     npad_fullkey_hook.installAtSym<"_ZN2nn3hid13GetNpadStatesEPNS0_16NpadFullKeyStateEiRKj">();
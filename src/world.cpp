@@ -0,0 +1,81 @@
+#include "smm2/world.h"
+#include "smm2/perf.h"
+#include "hk/ro/RoUtil.h"
+
+namespace smm2 {
+namespace world {
+
+static uintptr_t s_base = 0;
+static WorldSnapshot s_world = {};
+static WorldSnapshot s_poll_world = {};   // npad poll thread's
+
+// Heap pointers on this title live in this window; anything else is a
+// stale or uninitialised global
+static bool plausible(uintptr_t p) {
+    return p > 0x1000000ULL && p < 0x3000000000ULL;
+}
+
+void init() {
+    s_base = hk::ro::getMainModule()->range().start();
+    s_world.phase = -1;
+    s_world.course_theme = 0xFF;
+}
+
+uintptr_t main_base() {
+    return s_base;
+}
+
+void resolve(uint32_t frame) {
+    WorldSnapshot w;
+    resolve(frame, w);
+    s_world = w;
+}
+
+void resolve(uint32_t frame, WorldSnapshot& out) {
+    PERF_SCOPE(world_resolve);
+    WorldSnapshot w = {};
+    w.frame = frame;
+    w.phase = -1;
+    w.course_theme = 0xFF;
+
+    if (s_base != 0) {
+        // GamePhaseManager: [[main+0x2C57D58]+0x30] = inner struct
+        uintptr_t gpm = *reinterpret_cast<uintptr_t*>(s_base + 0x2C57D58);
+        if (plausible(gpm)) {
+            uintptr_t inner = *reinterpret_cast<uintptr_t*>(gpm + 0x30);
+            if (plausible(inner)) {
+                w.gpm_valid = true;
+                w.phase = *reinterpret_cast<int32_t*>(inner + 0x1C);
+                for (int i = 0; i < 6; i++) {
+                    w.gpm_inner[i] = *reinterpret_cast<uint32_t*>(inner + i * 4);
+                }
+                w.is_playing = *reinterpret_cast<uint32_t*>(inner + 0x10);
+                w.scene_mode = *reinterpret_cast<uint32_t*>(inner + 0x14);
+                w.game_style = *reinterpret_cast<uint32_t*>(inner + 0x1C);
+            }
+        }
+
+        // Course theme (noexes-patches.md): main+0x2A67B70 → [+0x28] → theme at +0x210
+        uintptr_t p1 = *reinterpret_cast<uintptr_t*>(s_base + 0x2A67B70);
+        if (plausible(p1)) {
+            uintptr_t p2 = *reinterpret_cast<uintptr_t*>(p1 + 0x28);
+            if (plausible(p2)) {
+                w.course_theme = *reinterpret_cast<uint8_t*>(p2 + 0x210);
+            }
+        }
+    }
+
+    out = w;
+}
+
+const WorldSnapshot& current() {
+    return s_world;
+}
+
+const WorldSnapshot& resolve_poll(uint32_t frame) {
+    resolve(frame, s_poll_world);
+    return s_poll_world;
+}
+
+} // namespace world
+} // namespace smm2
@@ -1,4 +1,5 @@
-#include "smm2/log.h"
+#include "smm2/boot_tables.h"
+#include "smm2/perf.h"
 #include "hk/hook/Trampoline.h"
 
 // xlink2::EnumPropertyDefinition::EnumPropertyDefinition(const char*, int, sead::Heap*, bool)
@@ -6,46 +7,39 @@
 //
 // xlink2::EnumPropertyDefinition::entry(int, const char*)
 // sub_710059DDA0 — adds enum value, x0=this, w1=index, x2=name
+//
+// Values go into boot_tables (key = index, value = interned value name);
+// with a cached dump on SD the hooks aren't installed.
 
 namespace smm2 {
 namespace xlink2_enum {
 
-static log::Logger s_log;
-static bool s_inited = false;
-static const char* s_current_enum = nullptr;
+static uint16_t s_current_enum = boot_tables::NO_STRING;
 
 // Hook the constructor to capture enum type name
 static HkTrampoline<void, void*, const char*, int, void*, bool> ctor_hook =
     hk::hook::trampoline([](void* self, const char* name, int count, void* heap, bool b) {
-        if (!s_inited) {
-            s_log.init("xlink2_enums.csv");
-            s_log.write("enum_name,index,value_name\n", 27);
-            s_inited = true;
-        }
-        s_current_enum = name;
-        ctor_hook.orig(self, name, count, heap, b);
+        PERF_SCOPE(xlink2_ctor);
+        s_current_enum = boot_tables::intern(name ? name : "?");
+        PERF_ORIG(ctor_hook.orig(self, name, count, heap, b));
     });
 
 // Hook entry() to capture each enum value
 static HkTrampoline<void, void*, int, const char*> entry_hook =
     hk::hook::trampoline([](void* self, int index, const char* name) {
-        if (s_inited && name) {
-            const char* enum_name = s_current_enum ? s_current_enum : "?";
-            s_log.writef("%s,%d,%s\n", enum_name, index, name);
+        PERF_SCOPE(xlink2_entry);
+        if (name) {
+            uint16_t value = boot_tables::intern(name);
+            if (value != boot_tables::NO_STRING)
+                boot_tables::add(boot_tables::Table::XlinkEnums, s_current_enum, uint32_t(index), value);
         }
-        entry_hook.orig(self, index, name);
+        PERF_ORIG(entry_hook.orig(self, index, name));
     });
 
 void init() {
+    if (boot_tables::cached()) return;
     ctor_hook.installAtSym<"xlink2_EnumPropertyDefinition_ctor">();
     entry_hook.installAtSym<"xlink2_EnumPropertyDefinition_entry">();
-    s_log.init("xlink2_enums.csv");
-    s_log.write("enum_name,index,value_name\n", 27);
-    s_inited = true;
-}
-
-void flush() {
-    if (s_inited) s_log.flush();
 }
 
 } // namespace xlink2_enum
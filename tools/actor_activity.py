@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Decode actor_activity.bin, the per-frame actor activation profile.
+
+Frame records give, per frame, how many actors executed, how many were
+inside the activation bounds, in placeholder state, or had collision
+registered, and the time spent in Actor::execute. Class records give the
+same per actor class (main-relative vtable) every class_interval frames.
+See include/smm2/actor_activity.h for the layout.
+
+Usage:
+    python3 actor_activity.py actor_activity.bin                 # summary + per-class top list
+    python3 actor_activity.py actor_activity.bin --frames        # per-frame table
+    python3 actor_activity.py actor_activity.bin --classes names.csv --top 20
+
+names.csv maps vtables to names: "vtable,name" rows, vtable as hex.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+from collections import defaultdict
+
+MAGIC = b'SMAA'
+HEADER_FMT = '<4sHHII'                  # ActivityHeader, 16 bytes
+RECORD_FMT = '<BBxxIIIIIII'             # ActivityRecord, 32 bytes
+FRAME, CLASS = 0, 1
+FIELDS = ('frame', 'key', 'calls', 'active', 'placeholder', 'collision', 'calc_us')
+
+
+def read_activity(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    magic, version, record_size, tick_hz, interval = struct.unpack_from(HEADER_FMT, data, 0)
+    if magic != MAGIC:
+        raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+    hdr = {'version': version, 'tick_hz': tick_hz, 'class_interval': interval}
+    frames, classes = [], []
+    off = struct.calcsize(HEADER_FMT)
+    while off + record_size <= len(data):
+        kind, override, *vals = struct.unpack_from(RECORD_FMT, data, off)
+        rec = dict(zip(FIELDS, vals), bounds_override=override)
+        (frames if kind == FRAME else classes).append(rec)
+        off += record_size
+    return hdr, frames, classes
+
+
+def load_names(path):
+    if not path:
+        return {}
+    with open(path, newline='') as f:
+        return {int(row['vtable'], 16): row['name'] for row in csv.DictReader(f)}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode actor_activity.bin')
+    parser.add_argument('path', help='actor_activity.bin file')
+    parser.add_argument('--frames', action='store_true', help='print every frame record')
+    parser.add_argument('--classes', metavar='CSV', help='vtable,name map for class names')
+    parser.add_argument('--top', type=int, default=15, help='classes to list (by calc time)')
+    args = parser.parse_args()
+
+    hdr, frames, classes = read_activity(args.path)
+    names = load_names(args.classes)
+
+    if args.frames:
+        print('frame,classes,calls,active,placeholder,collision,calc_us,bounds_override')
+        for r in frames:
+            print(f"{r['frame']},{r['key']},{r['calls']},{r['active']},{r['placeholder']},"
+                  f"{r['collision']},{r['calc_us']},{r['bounds_override']}")
+        return 0
+
+    if not frames:
+        print('no frame records')
+        return 0
+    n = len(frames)
+    avg = {k: sum(r[k] for r in frames) / n for k in ('calls', 'active', 'placeholder', 'collision', 'calc_us')}
+    worst = max(frames, key=lambda r: r['calc_us'])
+    override = 'on' if frames[0]['bounds_override'] else 'off'
+    print(f"actor_activity.bin v{hdr['version']}: {n} frames, bounds override {override}")
+    print(f"  per frame: {avg['calls']:.1f} actors, {avg['active']:.1f} active, "
+          f"{avg['placeholder']:.1f} placeholder, {avg['collision']:.1f} collision, "
+          f"{avg['calc_us']:.0f} us")
+    print(f"  worst frame {worst['frame']}: {worst['calls']} actors, {worst['calc_us']} us")
+
+    totals = defaultdict(lambda: defaultdict(int))
+    for r in classes:
+        t = totals[r['key']]
+        for k in ('calls', 'active', 'placeholder', 'collision', 'calc_us'):
+            t[k] += r[k]
+    ranked = sorted(totals.items(), key=lambda kv: kv[1]['calc_us'], reverse=True)
+    print(f'  top {args.top} classes by calc time:')
+    for vtable, t in ranked[:args.top]:
+        name = names.get(vtable, f'vt_{vtable:08x}')
+        per_call = t['calc_us'] / t['calls'] if t['calls'] else 0
+        print(f"    {name:28s} {t['calls']:8d} calls {t['calc_us']:9d} us ({per_call:.2f}/call) "
+              f"active {t['active']} placeholder {t['placeholder']} collision {t['collision']}")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
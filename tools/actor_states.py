@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Decode actor_states.bin, the all-actor state transition stream.
+
+actor_registry links every StateMachine to the profile that created it and
+appends a 16-byte record per spawn / state change. Profile names come from
+boot_tables.bin (same boot or a cached copy for the same game version).
+See include/smm2/actor_registry.h for the layout.
+
+Usage:
+    python3 actor_states.py actor_states.bin                     # per-profile summary
+    python3 actor_states.py actor_states.bin --names boot_tables.bin --profile Kuribo
+    python3 actor_states.py actor_states.bin --actor 42          # one instance's changes
+
+As a module:
+    from actor_states import read_stream
+    hdr, records = read_stream('actor_states.bin')
+"""
+
+import argparse
+import struct
+import sys
+from collections import Counter, defaultdict
+
+MAGIC = b'SMAS'
+HEADER_FMT = '<4sHHII'                  # ActorStreamHeader, 16 bytes
+RECORD_FMT = '<IIHHHBx'                 # ActorRecord, 16 bytes
+NO_PROFILE = 0xFFFF
+
+SPAWN, CHANGE, RESET, EVICT = 0, 1, 2, 3   # RESET: v1 files only
+
+
+def read_stream(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    magic, version, record_size, game_version, _ = struct.unpack_from(HEADER_FMT, data, 0)
+    if magic != MAGIC:
+        raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+    hdr = {'version': version, 'record_size': record_size, 'game_version': game_version}
+    records = []
+    off = struct.calcsize(HEADER_FMT)
+    while off + record_size <= len(data):
+        frame, actor, profile, old, new, kind = struct.unpack_from(RECORD_FMT, data, off)
+        records.append({'frame': frame, 'actor': actor, 'profile': profile,
+                        'old': old, 'new': new, 'kind': kind})
+        off += record_size
+    return hdr, records
+
+
+def load_names(path):
+    if not path:
+        return None
+    from boot_tables import BootTables
+    return BootTables(path).strings
+
+
+def profile_name(names, pid):
+    if pid == NO_PROFILE:
+        return '(unlinked)'
+    if names and pid < len(names):
+        return names[pid]
+    return f'#{pid}'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode actor_states.bin')
+    parser.add_argument('path', help='actor_states.bin file')
+    parser.add_argument('--names', help='boot_tables.bin for profile names')
+    parser.add_argument('--profile', help='only this profile (name, or #id without --names)')
+    parser.add_argument('--actor', type=int, help='only this actor instance id')
+    args = parser.parse_args()
+
+    hdr, records = read_stream(args.path)
+    names = load_names(args.names)
+
+    def keep(r):
+        if args.actor is not None and r['actor'] != args.actor:
+            return False
+        if args.profile and profile_name(names, r['profile']) != args.profile:
+            return False
+        return True
+
+    if args.actor is not None or args.profile:
+        for r in filter(keep, records):
+            kind = {SPAWN: 'spawn', CHANGE: 'change', RESET: 'reset', EVICT: 'evict'}[r['kind']]
+            print(f"{r['frame']:8d} actor {r['actor']:6d} {profile_name(names, r['profile']):20s} "
+                  f"{kind:6s} {r['old']:4d} -> {r['new']:4d}")
+        return 0
+
+    spawns = Counter()
+    changes = Counter()
+    states = defaultdict(Counter)
+    resets = 0
+    evicted = 0
+    for r in records:
+        if r['kind'] == RESET:
+            resets += 1
+        elif r['kind'] == EVICT:
+            evicted += r['actor']
+        elif r['kind'] == SPAWN:
+            spawns[r['profile']] += 1
+        else:
+            changes[r['profile']] += 1
+            states[r['profile']][r['new']] += 1
+
+    print(f"actor_states.bin v{hdr['version']}: game {hdr['game_version']}, "
+          f"{len(records)} records, {resets} table resets, {evicted} actors evicted")
+    for pid, n in changes.most_common():
+        top = ', '.join(f'{s}:{c}' for s, c in states[pid].most_common(5))
+        print(f'  {profile_name(names, pid):24s} {spawns[pid]:5d} spawned {n:7d} changes  [{top}]')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -29,6 +29,10 @@ import sys
 import time
 import os
 import subprocess
+
+import input_cmd
+import lockstep
+
 try:
     from dotenv import load_dotenv
     _repo_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
@@ -64,7 +68,7 @@ else:
     if not SD_BASE:
         print("Error: RYUJINX_SD_PATH not set. Copy .env.example to .env and configure it.")
         sys.exit(1)
-INPUT_BIN = os.path.join(SD_BASE, "input.bin")
+INPUT_BIN = os.path.join(SD_BASE, "input_cmd.bin")
 SCREENSHOT_SCRIPT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "screenshot_ryujinx.ps1")
 
 def set_emulator(emu='eden'):
@@ -76,7 +80,7 @@ def set_emulator(emu='eden'):
     else:
         SD_BASE = os.environ.get("RYUJINX_SD_PATH", "")
         _use_eden = False
-    INPUT_BIN = os.path.join(SD_BASE, "input.bin")
+    INPUT_BIN = os.path.join(SD_BASE, "input_cmd.bin")
 SCREENSHOT_OUT = os.environ.get("SCREENSHOT_OUT", "/mnt/c/temp/smm2_debug/capture.png")
 WSL_DISTRO = os.environ.get("WSL_DISTRO", "Ubuntu")
 
@@ -102,10 +106,8 @@ BUTTONS = {
 
 
 def write_input(buttons=0, stick_lx=0, stick_ly=0):
-    """Write controller state to input.bin for the TAS plugin to read."""
-    data = struct.pack('<Qii', buttons, stick_lx, stick_ly)
-    with open(INPUT_BIN, 'wb') as f:
-        f.write(data)
+    """Queue controller state in input_cmd.bin for the TAS plugin to apply."""
+    return input_cmd.send(INPUT_BIN, buttons, stick_lx, stick_ly)
 
 
 def parse_buttons(button_str):
@@ -226,10 +228,11 @@ def read_status():
 
 def read_fields_csv():
     """Read latest line from fields.csv for game state."""
+    from logz import open_log
     path = os.path.join(SD_BASE, "fields.csv")
-    if not os.path.exists(path):
+    if not os.path.exists(path) and not os.path.exists(path + '.lz'):
         return None
-    with open(path, 'r') as f:
+    with open_log(path) as f:
         lines = f.readlines()
     if len(lines) < 2:
         return None
@@ -264,6 +267,31 @@ def wait_for_frame_advance(timeout_s=10, start_frame=None):
     return None
 
 
+_stepper = None
+
+
+def step_frames(n=1, timeout_s=5):
+    """Advance exactly n frames in lockstep (entering it on first use).
+    Deterministic replacement for wait_for_frame_advance() in bot loops.
+    Returns the status dict of the last frame, or None on timeout."""
+    global _stepper
+    if _stepper is None or _stepper.status_path != os.path.join(SD_BASE, "status.bin"):
+        _stepper = lockstep.Lockstep(SD_BASE)
+        if _stepper.enable() is None:
+            _stepper = None
+            return None
+    if _stepper.step(n, timeout_s) is None:
+        return None
+    return read_status()
+
+
+def end_lockstep():
+    """Let the game free-run again."""
+    global _stepper
+    lockstep.Lockstep(SD_BASE).disable()
+    _stepper = None
+
+
 def wait_for_has_player(timeout_s=10):
     """Wait until has_player becomes 1 in status.bin."""
     deadline = time.time() + timeout_s
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""Batch experiment runner — host side of the tas plugin's batch mode.
+
+Builds batch.txt (plus converted scripts) on the SD card, and reads the
+per-run results the plugin appends to batch_results.bin. See
+include/smm2/tas.h for both formats.
+
+Usage:
+    python3 batch.py SD_DIR make run_a.csv run_b.csv --timeout 1800
+    python3 batch.py SD_DIR results            # per-run table
+    python3 batch.py SD_DIR results --summary  # outcome counts
+
+As a module:
+    from batch import read_results
+    for r in read_results(sd): r['outcome'], r['frames'], r['script']
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+import tas_bin
+
+MAGIC = b'SMBR'
+HEADER_FMT = '<4sHH8x'            # BatchResultsHeader, 16 bytes
+RESULT_FMT = '<IIIIffII'          # BatchResult, 32 bytes
+OUTCOMES = {1: 'goal', 2: 'death', 3: 'timeout', 4: 'aborted', 5: 'script_error'}
+
+
+def make_batch(sd, scripts, timeout=None, subdir='batch'):
+    """Convert CSV/bin scripts into sd/subdir and write sd/batch.txt."""
+    os.makedirs(os.path.join(sd, subdir), exist_ok=True)
+    lines = []
+    for i, src in enumerate(scripts):
+        name = f'{subdir}/{i:04d}.bin'
+        dst = os.path.join(sd, name)
+        with open(src, 'rb') as f:
+            is_bin = f.read(4) == tas_bin.MAGIC
+        keyframes = tas_bin.read_bin(src) if is_bin else tas_bin.read_csv(src)
+        tas_bin.write_bin(dst, keyframes)
+        lines.append(f'{name} {timeout}' if timeout else name)
+    with open(os.path.join(sd, 'batch.txt'), 'w') as f:
+        f.write(f'# {len(scripts)} runs: ' + ' '.join(os.path.basename(s) for s in scripts) + '\n')
+        f.write('\n'.join(lines) + '\n')
+    return len(lines)
+
+
+def _manifest_names(sd):
+    """manifest line number → script name, as the plugin counts lines."""
+    path = os.path.join(sd, 'batch.txt')
+    if not os.path.exists(path):
+        return {}
+    names = {}
+    with open(path) as f:
+        for i, line in enumerate(f):
+            parts = line.split()
+            if parts and not parts[0].startswith('#'):
+                names[i] = parts[0]
+    return names
+
+
+def read_results(sd):
+    with open(os.path.join(sd, 'batch_results.bin'), 'rb') as f:
+        data = f.read()
+    magic, version, record_size = struct.unpack_from(HEADER_FMT, data, 0)
+    if magic != MAGIC:
+        raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+    names = _manifest_names(sd)
+    results = []
+    off = struct.calcsize(HEADER_FMT)
+    while off + record_size <= len(data):
+        (run, outcome, frames, end_state, x, y, keyframes,
+         start_frame) = struct.unpack_from(RESULT_FMT, data, off)
+        results.append({
+            'run': run, 'script': names.get(run, f'#{run}'),
+            'outcome': OUTCOMES.get(outcome, str(outcome)),
+            'frames': frames, 'end_state': end_state, 'x': x, 'y': y,
+            'keyframes': keyframes, 'start_frame': start_frame,
+        })
+        off += record_size
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description='tas plugin batch mode')
+    parser.add_argument('sd', help='smm2-hooks SD directory')
+    sub = parser.add_subparsers(dest='cmd', required=True)
+    mk = sub.add_parser('make', help='write batch.txt from scripts')
+    mk.add_argument('scripts', nargs='+', help='tas CSV or tas.bin files, in run order')
+    mk.add_argument('--timeout', type=int, help='per-run timeout in input polls (one per frame)')
+    res = sub.add_parser('results', help='decode batch_results.bin')
+    res.add_argument('--summary', action='store_true', help='outcome counts only')
+    args = parser.parse_args()
+
+    if args.cmd == 'make':
+        n = make_batch(args.sd, args.scripts, args.timeout)
+        print(f'{n} runs → {os.path.join(args.sd, "batch.txt")}')
+        return 0
+
+    results = read_results(args.sd)
+    if args.summary:
+        counts = {}
+        for r in results:
+            counts[r['outcome']] = counts.get(r['outcome'], 0) + 1
+        print(f'{len(results)} runs: ' + ', '.join(f'{k}={v}' for k, v in sorted(counts.items())))
+        return 0
+    print('run,script,outcome,frames,end_state,x,y,keyframes')
+    for r in results:
+        print(f"{r['run']},{r['script']},{r['outcome']},{r['frames']},{r['end_state']},"
+              f"{r['x']:.2f},{r['y']:.2f},{r['keyframes']}")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
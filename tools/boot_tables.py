@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Decode boot_tables.bin, the deduplicated boot registration capture.
+
+actor_profile and xlink2_enum intern every name they see at boot and keep
+one entry per (table, name, key); the result is dumped once the title
+screen settles. See include/smm2/boot_tables.h for the layout.
+
+Usage:
+    python3 boot_tables.py boot_tables.bin                 # summary
+    python3 boot_tables.py boot_tables.bin --table states  # rows of one table
+    python3 boot_tables.py boot_tables.bin --csv out/      # profiles.csv, actor_states.csv, xlink2_enums.csv
+
+As a module:
+    from boot_tables import BootTables
+    bt = BootTables('boot_tables.bin')
+    bt.rows('states')     # [(name, key, value), ...]
+"""
+
+import argparse
+import csv
+import os
+import struct
+import sys
+
+MAGIC = b'SMBT'
+HEADER_FMT = '<4sHHIIIIII'              # BootHeader, 32 bytes
+DESC_FMT = '<16sII8x'                   # BootTableDesc, 32 bytes
+ENTRY_FMT = '<BxHII'                    # BootEntry, 12 bytes
+
+# Old per-hook CSV names and headers, for --csv
+CSV_FILES = {
+    'profiles': ('profiles.csv', ['name', 'index', 'callback']),
+    'states': ('actor_states.csv', ['state_name', 'state_id']),
+    'xlink2_enums': ('xlink2_enums.csv', ['enum_name', 'index', 'value_name']),
+}
+
+
+class BootTables:
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            data = f.read()
+        (magic, self.version, table_count, self.game_version, string_count, pool_bytes,
+         entry_count, self.dropped, self.generation) = struct.unpack_from(HEADER_FMT, data, 0)
+        if magic != MAGIC:
+            raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+        off = struct.calcsize(HEADER_FMT)
+
+        self.tables = []
+        for _ in range(table_count):
+            name, count, calls = struct.unpack_from(DESC_FMT, data, off)
+            self.tables.append({'name': name.rstrip(b'\0').decode(), 'count': count, 'calls': calls})
+            off += struct.calcsize(DESC_FMT)
+
+        offsets = struct.unpack_from(f'<{string_count}I', data, off)
+        off += 4 * string_count
+        pool = data[off:off + pool_bytes]
+        off += pool_bytes
+        self.strings = [pool[o:pool.index(b'\0', o)].decode('utf-8', 'replace') for o in offsets]
+
+        self.entries = [struct.unpack_from(ENTRY_FMT, data, off + i * 12) for i in range(entry_count)]
+
+    def rows(self, table):
+        idx = next(i for i, t in enumerate(self.tables) if t['name'] == table)
+        return [(self.strings[n], k, v) for t, n, k, v in self.entries if t == idx]
+
+
+def csv_row(table, strings, name, key, value):
+    if table == 'profiles':
+        return [name, key, f'0x{value:x}']
+    if table == 'states':
+        return [name, key]
+    return [name, key, strings[value]]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode boot_tables.bin')
+    parser.add_argument('path', help='boot_tables.bin file')
+    parser.add_argument('--table', help='print the rows of one table')
+    parser.add_argument('--csv', metavar='DIR', help='write the per-table CSVs into DIR')
+    args = parser.parse_args()
+
+    bt = BootTables(args.path)
+    if args.table:
+        for name, key, value in bt.rows(args.table):
+            print(','.join(str(c) for c in csv_row(args.table, bt.strings, name, key, value)))
+        return 0
+    if args.csv:
+        os.makedirs(args.csv, exist_ok=True)
+        for t in bt.tables:
+            fname, header = CSV_FILES[t['name']]
+            with open(os.path.join(args.csv, fname), 'w', newline='') as f:
+                w = csv.writer(f)
+                w.writerow(header)
+                for name, key, value in bt.rows(t['name']):
+                    w.writerow(csv_row(t['name'], bt.strings, name, key, value))
+            print(f'{fname}: {t["count"]} rows')
+        return 0
+
+    print(f'boot_tables.bin v{bt.version}: game {bt.game_version}, dump {bt.generation}, '
+          f'{len(bt.strings)} strings, {bt.dropped} dropped')
+    for t in bt.tables:
+        ratio = t['calls'] / t['count'] if t['count'] else 0
+        print(f"  {t['name']:14s} {t['count']:6d} unique  {t['calls']:7d} calls  ({ratio:.1f}x)")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Decode the on-device course tile index course_map.bin.
+
+course_data's WriteFile hook rebuilds the index from the decrypted BCD
+whenever the game saves a course, so bots get the level layout without
+decrypting save files. See include/smm2/course_map.h for the layout.
+
+Usage:
+    python3 course_map.py course_map.bin                   # summary
+    python3 course_map.py course_map.bin --map             # ASCII map of the main area
+    python3 course_map.py course_map.bin --near 40 5 3     # objects within 3 tiles of (40, 5)
+    python3 course_map.py course_map.bin --area 1 --map    # sub area
+
+As a module:
+    from course_map import CourseMap
+    cm = CourseMap('course_map.bin')
+    cm.cell(0, x, y) & GROUND, cm.near(0, x, y, 3)
+    cm.near_player(status)            # status dict from smm2.Game.status()
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b'SMCM'
+HEADER_FMT = '<4sHHIHH'                 # MapHeader, 16 bytes
+AREA_FMT = '<8HBBHIII'                  # MapAreaHeader, 32 bytes
+OBJECT_FMT = '<HBBBBH'                  # MapObject, 8 bytes
+
+GROUND, OBJECT, TRACK, PIPE = 1, 2, 4, 8
+TILE_UNITS = 16                         # PlayerObject position units per tile
+
+
+class Area:
+    def __init__(self, data, fields):
+        (self.width, self.height, self.block_cols, self.block_rows,
+         self.object_count, self.ground_count, self.track_count, self.pipe_node_count,
+         self.theme, self.orientation, self.dropped,
+         cells_off, blocks_off, objects_off) = fields
+        self.cells = data[cells_off:cells_off + self.width * self.height]
+        nblocks = self.block_cols * self.block_rows
+        self.block_start = struct.unpack_from(f'<{nblocks + 1}H', data, blocks_off)
+        self.objects = []
+        for i in range(self.object_count):
+            t, x, y, w, h, slot = struct.unpack_from(OBJECT_FMT, data, objects_off + i * 8)
+            self.objects.append({'type': t, 'x': x, 'y': y, 'w': w, 'h': h, 'slot': slot})
+
+
+class CourseMap:
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            data = f.read()
+        magic, self.version, count, self.generation, self.block_tiles, _ = \
+            struct.unpack_from(HEADER_FMT, data, 0)
+        if magic != MAGIC:
+            raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+        off = struct.calcsize(HEADER_FMT)
+        self.areas = []
+        for _ in range(count):
+            self.areas.append(Area(data, struct.unpack_from(AREA_FMT, data, off)))
+            off += struct.calcsize(AREA_FMT)
+
+    def cell(self, area, x, y):
+        a = self.areas[area]
+        if 0 <= x < a.width and 0 <= y < a.height:
+            return a.cells[y * a.width + x]
+        return 0
+
+    def near(self, area, x, y, radius):
+        """Objects whose footprint origin is within radius tiles (square) of (x, y)."""
+        a = self.areas[area]
+        bt = self.block_tiles
+        out = []
+        for by in range(max(0, (y - radius) // bt), min(a.block_rows - 1, (y + radius) // bt) + 1):
+            for bx in range(max(0, (x - radius) // bt), min(a.block_cols - 1, (x + radius) // bt) + 1):
+                b = by * a.block_cols + bx
+                for o in a.objects[a.block_start[b]:a.block_start[b + 1]]:
+                    if abs(o['x'] - x) <= radius and abs(o['y'] - y) <= radius:
+                        out.append(o)
+        return out
+
+    def near_player(self, status, radius=3, area=0):
+        return self.near(area, int(status['x'] // TILE_UNITS), int(status['y'] // TILE_UNITS), radius)
+
+
+def object_name(t):
+    try:
+        from parse_course import ACTOR_NAMES
+        return ACTOR_NAMES.get(t, f'unk_{t}')
+    except ImportError:
+        return str(t)
+
+
+def render(area, out=sys.stdout):
+    for y in range(area.height - 1, -1, -1):
+        row = area.cells[y * area.width:(y + 1) * area.width]
+        line = ''.join('#' if c & GROUND else 'o' if c & OBJECT else '=' if c & TRACK
+                       else 'p' if c & PIPE else ' ' for c in row)
+        out.write(f'{y:3d}|{line}\n')
+    out.write('   +' + '-' * area.width + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode course_map.bin')
+    parser.add_argument('path', help='course_map.bin file')
+    parser.add_argument('--area', type=int, default=0, help='0 = main, 1 = sub')
+    parser.add_argument('--map', action='store_true', help='ASCII map of the area')
+    parser.add_argument('--near', nargs=3, type=int, metavar=('X', 'Y', 'R'),
+                        help='objects within R tiles of tile (X, Y)')
+    args = parser.parse_args()
+
+    cm = CourseMap(args.path)
+    if args.map:
+        render(cm.areas[args.area])
+        return 0
+    if args.near:
+        x, y, r = args.near
+        print(f'cell({x},{y}) = 0x{cm.cell(args.area, x, y):02x}')
+        for o in cm.near(args.area, x, y, r):
+            print(f"  {object_name(o['type']):20s} ({o['x']:3d},{o['y']:3d}) {o['w']}x{o['h']} slot={o['slot']}")
+        return 0
+
+    print(f'course_map.bin v{cm.version}: generation {cm.generation}')
+    for i, a in enumerate(cm.areas):
+        print(f'  area {i}: {a.width}x{a.height} tiles, theme={a.theme} orientation={a.orientation}, '
+              f'{a.object_count} objects, {a.ground_count} ground, {a.track_count} track, '
+              f'{a.pipe_node_count} pipe nodes, {a.dropped} dropped')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -25,6 +25,8 @@ import json
 import time
 import struct
 
+import input_cmd
+
 TASKLIST = "/mnt/c/Windows/System32/tasklist.exe"
 TASKKILL = "/mnt/c/Windows/System32/taskkill.exe"
 
@@ -550,7 +552,7 @@ def cmd_game_status(emu_name='eden', raw=False):
 
 
 def _write_input(buttons=0, stick_lx=0, stick_ly=0):
-    """Write controller state to input.bin (buttons + analog sticks).
+    """Queue controller state in input_cmd.bin (buttons + analog sticks).
     
     Analog stick range: -32768 to 32767. 3DW requires analog for movement.
     """
@@ -558,10 +560,7 @@ def _write_input(buttons=0, stick_lx=0, stick_ly=0):
     sd = info.get('sd_path', '')
     if not sd:
         return
-    path = os.path.join(sd, 'input.bin')
-    data = struct.pack('<Qii', buttons, stick_lx, stick_ly)
-    with open(path, 'wb') as f:
-        f.write(data)
+    input_cmd.send(os.path.join(sd, 'input_cmd.bin'), buttons, stick_lx, stick_ly)
 
 
 def _press(buttons, duration_ms=100):
@@ -605,7 +604,7 @@ def _boot_and_verify(emu_name, gdb=False):
     # Clear stale status.bin
     sd = info.get('sd_path', '')
     if sd:
-        for f in ['status.bin', 'input.bin']:
+        for f in ['status.bin', 'input_cmd.bin']:
             p = os.path.join(sd, f)
             if os.path.exists(p):
                 os.remove(p)
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""Decode flight recorder dumps (sd:/smm2-hooks/flight_NNN.bin).
+
+Layout (include/smm2/flight_recorder.h):
+    DumpHeader, StatusBlock[status_count], TraceRecord[trace_count]
+
+Usage:
+    python3 flight_bin.py flight_000.bin            # summary + per-frame player track
+    python3 flight_bin.py flight_000.bin --traces   # also list delegate calls
+    python3 flight_bin.py flight_000.bin --json
+"""
+
+import argparse
+import json
+import struct
+import sys
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).parent))
+
+from smm2 import _parse_block, STATE_NAMES
+from trace_bin import decode_record
+
+MAGIC = b'SMFR'
+HEADER_FMT = '<4sHHIIIIHHIII'   # DumpHeader, 40 bytes
+REASONS = {1: 'death', 2: 'goal', 4: 'manual'}
+
+
+def load(path):
+    d = Path(path).read_bytes()
+    (magic, version, header_size, reason, trigger_frame, status_count, trace_count,
+     block_size, record_size, pre, post, truncated) = struct.unpack_from(HEADER_FMT, d, 0)
+    if magic != MAGIC:
+        raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+
+    off = header_size
+    blocks = []
+    for _ in range(status_count):
+        blocks.append(_parse_block(d, off))
+        off += block_size
+    traces = []
+    for _ in range(trace_count):
+        if off + record_size > len(d):
+            break  # dump cut short
+        traces.append(decode_record(d, off))
+        off += record_size
+
+    return {
+        'version': version,
+        'reason': REASONS.get(reason, str(reason)),
+        'trigger_frame': trigger_frame,
+        'pre_frames': pre,
+        'post_frames': post,
+        'trace_truncated': bool(truncated),
+        'blocks': blocks,
+        'traces': traces,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode flight recorder dump')
+    parser.add_argument('path')
+    parser.add_argument('--traces', action='store_true', help='list delegate calls')
+    parser.add_argument('--json', action='store_true', help='dump everything as JSON')
+    args = parser.parse_args()
+
+    dump = load(args.path)
+    if args.json:
+        json.dump(dump, sys.stdout, indent=1)
+        return 0
+
+    blocks = dump['blocks']
+    print(f"{dump['reason']} at frame {dump['trigger_frame']}: "
+          f"{len(blocks)} frames, {len(dump['traces'])} delegate calls"
+          f"{' (trace ring wrapped)' if dump['trace_truncated'] else ''}")
+    for b in blocks:
+        mark = '>>' if b['frame'] == dump['trigger_frame'] else '  '
+        name = STATE_NAMES.get(b['state'], f"#{b['state']}")
+        print(f"{mark} {b['frame']:8d} {name:14s} sf={b['state_frames']:4d} "
+              f"pos=({b['x']:8.2f},{b['y']:8.2f}) vel=({b['vx']:6.2f},{b['vy']:6.2f})")
+    if args.traces:
+        for t in dump['traces']:
+            print(f"   {t['frame']:8d} {t['func']:36s} ret={t['ret']}")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
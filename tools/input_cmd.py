@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Host side of the tas plugin's input command ring (input_cmd.bin).
+
+Commands are appended with a sequence number and consumed by the hook
+exactly once, so short presses are never dropped and input can be queued
+frame-exact ahead of time. The hook echoes the last applied seq in
+StatusBlock.input_cmd_seq (status.bin +0x9C), which is used here for flow
+control and for waiting on a command. See include/smm2/tas.h.
+
+Usage:
+    python3 input_cmd.py SD_DIR A              # tap A on the next poll
+    python3 input_cmd.py SD_DIR RIGHT --frames 30
+
+As a module:
+    from input_cmd import InputQueue
+    q = InputQueue(os.path.join(sd, 'input_cmd.bin'))
+    seq = q.push(0x4000)                 # next poll
+    q.push(0x4001, frame=1200)           # at frame 1200
+    q.wait(seq)
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+MAGIC = b'SMIC'
+SLOTS = 64
+FRAME_NEXT = 0xFFFFFFFF
+HEADER_FMT = '<4sIII'        # InputCmdHeader: magic, write_seq, slot_count, _pad
+CMD_FMT = '<IIQii'           # InputCmd: seq, frame, buttons, stick_lx, stick_ly
+HEADER_SIZE = struct.calcsize(HEADER_FMT)
+CMD_SIZE = struct.calcsize(CMD_FMT)
+STATUS_CMD_SEQ_OFFSET = 0x9C  # StatusBlock.input_cmd_seq
+
+BUTTONS = {
+    'A': 0x01, 'B': 0x02, 'X': 0x04, 'Y': 0x08,
+    'LSTICK': 0x10, 'RSTICK': 0x20, 'L': 0x40, 'R': 0x80,
+    'ZL': 0x100, 'ZR': 0x200, 'PLUS': 0x400, 'MINUS': 0x800,
+    'LEFT': 0x1000, 'UP': 0x2000, 'RIGHT': 0x4000, 'DOWN': 0x8000,
+}
+
+
+def _retry(fn, attempts=5):
+    """Run fn, retrying on PermissionError (NTFS lock while the emulator reads)."""
+    for attempt in range(attempts):
+        try:
+            return fn()
+        except PermissionError:
+            if attempt == attempts - 1:
+                raise
+            time.sleep(0.01)
+
+
+class InputQueue:
+    """Appends InputCmds to input_cmd.bin."""
+
+    def __init__(self, path, status_path=None):
+        self.path = path
+        self.status_path = status_path or os.path.join(os.path.dirname(path), 'status.bin')
+        self.write_seq = _retry(self._open)
+
+    def _open(self):
+        data = b''
+        if os.path.exists(self.path):
+            with open(self.path, 'rb') as f:
+                data = f.read(HEADER_SIZE)
+        if len(data) == HEADER_SIZE and data[:4] == MAGIC:
+            return struct.unpack(HEADER_FMT, data)[1]
+        with open(self.path, 'wb') as f:
+            f.write(struct.pack(HEADER_FMT, MAGIC, 0, SLOTS, 0))
+            f.write(b'\0' * (SLOTS * CMD_SIZE))
+        return 0
+
+    def applied(self):
+        """Last seq the hook applied, or None if status.bin is unreadable."""
+        try:
+            with open(self.status_path, 'rb') as f:
+                f.seek(STATUS_CMD_SEQ_OFFSET)
+                d = f.read(4)
+        except OSError:
+            return None
+        return struct.unpack('<I', d)[0] if len(d) == 4 else None
+
+    def push(self, buttons=0, lx=0, ly=0, frame=None, timeout=2.0):
+        """Queue one command. frame=None applies it on the next poll. Returns its seq."""
+        if not os.path.exists(self.path):
+            self.write_seq = _retry(self._open)  # file removed (fresh session)
+        seq = self.write_seq + 1
+        deadline = time.time() + timeout
+        while True:
+            done = self.applied()
+            if done is None or done > self.write_seq or seq - done <= SLOTS:
+                break  # no ack available (or hook resynced) — don't block
+            if time.time() > deadline:
+                raise TimeoutError(f'input ring full: seq {seq}, hook at {done}')
+            time.sleep(0.002)
+
+        cmd = struct.pack(CMD_FMT, seq, FRAME_NEXT if frame is None else frame,
+                          buttons, lx, ly)
+
+        def write():
+            with open(self.path, 'r+b') as f:
+                f.seek(HEADER_SIZE + ((seq - 1) % SLOTS) * CMD_SIZE)
+                f.write(cmd)
+                f.flush()
+                f.seek(0)
+                f.write(struct.pack(HEADER_FMT, MAGIC, seq, SLOTS, 0))
+        _retry(write)
+        self.write_seq = seq
+        return seq
+
+    def wait(self, seq, timeout=2.0):
+        """Block until the hook has applied seq. Returns False on timeout."""
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            done = self.applied()
+            if done is not None and done >= seq:
+                return True
+            time.sleep(0.002)
+        return False
+
+    def press_frames(self, buttons, frames=1, lx=0, ly=0):
+        """Hold for exactly `frames` polls then release. Returns the release seq."""
+        for _ in range(frames):
+            self.push(buttons, lx, ly)
+        return self.push(0)
+
+
+_queues = {}
+
+
+def queue_for(path):
+    """Per-path cached InputQueue, so scripts keep one seq counter per file."""
+    if path not in _queues:
+        _queues[path] = InputQueue(path)
+    return _queues[path]
+
+
+def send(path, buttons=0, lx=0, ly=0, frame=None):
+    """One-shot push — drop-in for the old 'overwrite input.bin' writers."""
+    return queue_for(path).push(buttons, lx, ly, frame)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Queue input for the tas plugin')
+    parser.add_argument('sd', help='smm2-hooks SD directory (contains status.bin)')
+    parser.add_argument('buttons', help="button names joined by '+', e.g. RIGHT+A, or a bitmask")
+    parser.add_argument('--frames', type=int, default=1, help='polls to hold before release')
+    parser.add_argument('--at', type=int, help='target frame for the press instead of next poll')
+    args = parser.parse_args()
+
+    try:
+        mask = int(args.buttons, 0)
+    except ValueError:
+        mask = 0
+        for name in args.buttons.upper().split('+'):
+            mask |= BUTTONS[name.strip()]
+
+    q = InputQueue(os.path.join(args.sd, 'input_cmd.bin'))
+    if args.at is not None:
+        q.push(mask, frame=args.at)
+        seq = q.push(0, frame=args.at + args.frames)
+    else:
+        seq = q.press_frames(mask, args.frames)
+    print(f'queued through seq {seq}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
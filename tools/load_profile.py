@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Summarize load_profile's loads.csv / load_files.csv.
+
+Each load window starts with file activity after a quiet period and ends
+once no file has been touched for SETTLE_FRAMES. scene_from/scene_to are
+StatusBlock scene_mode values (1=editor, 5=play, 6=title, 7=coursebot).
+See include/smm2/load_profile.h.
+
+Usage:
+    python3 load_profile.py sd/smm2-hooks/            # every window, top 10 files each
+    python3 load_profile.py sd/smm2-hooks/ --top 30 --window 4
+    python3 load_profile.py sd/smm2-hooks/ --by-path  # aggregate repeated opens of a path
+"""
+
+import argparse
+import csv
+import os
+import sys
+from collections import defaultdict
+
+SCENES = {0: 'loading', 1: 'editor', 5: 'play', 6: 'title', 7: 'coursebot'}
+
+
+def read_csv(path):
+    with open(path, newline='') as f:
+        return [{k: (v if k == 'path' else int(v)) for k, v in row.items()}
+                for row in csv.DictReader(f)]
+
+
+def scene(v):
+    return SCENES.get(v, str(v))
+
+
+def file_cost(r):
+    return r['open_us'] + r['read_us'] + r['close_us']
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Summarize load_profile output')
+    parser.add_argument('dir', help='directory holding loads.csv and load_files.csv')
+    parser.add_argument('--top', type=int, default=10, help='files to list per window')
+    parser.add_argument('--window', type=int, help='only this window')
+    parser.add_argument('--by-path', action='store_true', help='merge opens of the same path')
+    args = parser.parse_args()
+
+    windows = read_csv(os.path.join(args.dir, 'loads.csv'))
+    files = defaultdict(list)
+    files_csv = os.path.join(args.dir, 'load_files.csv')
+    if os.path.exists(files_csv):
+        for r in read_csv(files_csv):
+            files[r['window']].append(r)
+
+    for w in windows:
+        if args.window is not None and w['window'] != args.window:
+            continue
+        frames = w['settle_frame'] - w['start_frame']
+        io_ms = (w['open_us'] + w['read_us'] + w['close_us']) / 1000
+        print(f"window {w['window']}: {scene(w['scene_from'])} -> {scene(w['scene_to'])}, "
+              f"frames {w['start_frame']}..{w['settle_frame']} ({frames}), {w['files']} files, "
+              f"{w['bytes'] / 1024:.0f} KiB, io {io_ms:.1f} ms "
+              f"(open {w['open_us'] / 1000:.1f} / read {w['read_us'] / 1000:.1f} / "
+              f"close {w['close_us'] / 1000:.1f})"
+              + (f", {w['dropped']} dropped" if w['dropped'] else ''))
+
+        rows = files.get(w['window'], [])
+        if args.by_path:
+            merged = {}
+            for r in rows:
+                m = merged.setdefault(r['path'], dict(r, opens=0))
+                if m['opens']:
+                    for k in ('reads', 'bytes', 'open_us', 'read_us', 'close_us'):
+                        m[k] += r[k]
+                m['opens'] += 1
+            rows = list(merged.values())
+        for r in sorted(rows, key=file_cost, reverse=True)[:args.top]:
+            opens = f" x{r['opens']}" if args.by_path and r['opens'] > 1 else ''
+            print(f"  {file_cost(r) / 1000:8.2f} ms  {r['bytes'] / 1024:8.0f} KiB  "
+                  f"{r['reads']:5d} reads  {r['path']}{opens}")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
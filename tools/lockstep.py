@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Host side of lockstep frame advance (step.bin).
+
+The procFrame_ hook publishes each frame's StatusBlock and then blocks
+while frame >= run_until. Writing run_until = F + N releases N frames;
+the game has finished them when status.bin shows frame F + N.
+See include/smm2/frame.h.
+
+Usage:
+    python3 lockstep.py SD_DIR on          # enter lockstep, print the blocked frame
+    python3 lockstep.py SD_DIR step 10     # release 10 frames
+    python3 lockstep.py SD_DIR off
+
+As a module:
+    from lockstep import Lockstep
+    ls = Lockstep(sd)
+    f = ls.enable()
+    f = ls.step(1)
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+MAGIC = b'SMST'
+CONTROL_FMT = '<4sIII'         # StepControl: magic, enabled, run_until, timeout_ms
+DEFAULT_TIMEOUT_MS = 5000      # hook lets a frame through if we go quiet this long
+
+
+def _read_frame(status_path):
+    try:
+        with open(status_path, 'rb') as f:
+            d = f.read(4)
+    except OSError:
+        return None
+    return struct.unpack('<I', d)[0] if len(d) == 4 else None
+
+
+class Lockstep:
+    """Drives step.bin and watches StatusBlock.frame in status.bin."""
+
+    def __init__(self, sd, timeout_ms=DEFAULT_TIMEOUT_MS):
+        self.path = os.path.join(sd, 'step.bin')
+        self.status_path = os.path.join(sd, 'status.bin')
+        self.timeout_ms = timeout_ms
+        self.frame = None   # last frame the hook is known to be blocked at
+
+    def _write(self, enabled, run_until):
+        data = struct.pack(CONTROL_FMT, MAGIC, 1 if enabled else 0, run_until, self.timeout_ms)
+        for attempt in range(5):
+            try:
+                with open(self.path, 'r+b' if os.path.exists(self.path) else 'wb') as f:
+                    f.write(data)
+                return
+            except PermissionError:
+                time.sleep(0.01)  # NTFS lock while the emulator reads
+        raise PermissionError(self.path)
+
+    def enable(self, settle_s=0.1, timeout=5.0):
+        """Enter lockstep. Returns the frame the game stopped at, or None."""
+        self._write(True, 0)
+        # The hook re-checks step.bin every STEP_POLL_FRAMES while disabled;
+        # it is blocked once the published frame stops moving.
+        deadline = time.time() + timeout
+        last = _read_frame(self.status_path)
+        while time.time() < deadline:
+            time.sleep(settle_s)
+            cur = _read_frame(self.status_path)
+            if cur is not None and cur == last:
+                self.frame = cur
+                return cur
+            last = cur
+        return None
+
+    def disable(self):
+        self._write(False, 0)
+        self.frame = None
+
+    def step(self, n=1, timeout=5.0):
+        """Release n frames and wait for them. Returns the new blocked frame, or None."""
+        if self.frame is None:
+            raise RuntimeError('not in lockstep — call enable() first')
+        target = self.frame + n
+        self._write(True, target)
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            cur = _read_frame(self.status_path)
+            if cur is not None and cur >= target:
+                self.frame = cur
+                return cur
+            time.sleep(0.0005)
+        return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Lockstep frame advance control')
+    parser.add_argument('sd', help='smm2-hooks SD directory (contains status.bin)')
+    parser.add_argument('cmd', choices=['on', 'off', 'step'])
+    parser.add_argument('n', nargs='?', type=int, default=1, help='frames to release for step')
+    args = parser.parse_args()
+
+    ls = Lockstep(args.sd)
+    if args.cmd == 'off':
+        ls.disable()
+        return 0
+    frame = ls.enable()
+    if frame is None:
+        print('game did not stop (not in a procFrame_ scene?)')
+        return 1
+    if args.cmd == 'step':
+        frame = ls.step(args.n)
+    print(frame)
+    return 0 if frame is not None else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
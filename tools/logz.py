@@ -0,0 +1,291 @@
+#!/usr/bin/env python3
+"""Streaming decompressor for compressed Logger output (<name>.lz).
+
+Loggers listed in sd:/smm2-hooks/log.cfg (compress=trace.csv,fields.csv)
+write an SMLZ container instead of the plain file: an 8-byte header, then
+one block per buffer flush, each an LZ4 block or stored raw. See
+include/smm2/lz.h for the layout.
+
+Loggers listed under segment= instead write fixed-size segments
+<file>.0 .. <file>.N-1, reused in rotation, plus a <file>.seg manifest
+naming the live ones (include/smm2/log.h, SegmentManifest). Each segment
+is self-contained — its own SMLZ header when compressed, and the Logger's
+first write (the CSV header) replayed at its start.
+
+Usage:
+    python3 logz.py fields.csv.lz > fields.csv
+    python3 logz.py states.csv.lz -o states.csv
+    python3 logz.py trace.csv.lz --stats          # ratio, block count
+    python3 logz.py --join trace.csv.lz.seg -o trace.csv   # segments, in order
+
+As a module:
+    from logz import open_log
+    with open_log('fields.csv') as f:              # .lz or plain, whichever exists
+        for line in f: ...
+    for chunk in iter_blocks(open('trace.csv.lz', 'rb')): ...
+
+Uses the lz4 package's block decoder if it is installed, else pure Python.
+A truncated final block (game still writing, or killed) is ignored.
+"""
+
+import argparse
+import io
+import os
+import struct
+import sys
+
+MAGIC = b'SMLZ'
+FILE_HEADER_FMT = '<4sHH'        # FileHeader: magic, version, block_max
+BLOCK_HEADER_FMT = '<II'         # BlockHeader: raw_len, stored_len
+STORED_RAW = 0x80000000
+FILE_HEADER_SIZE = struct.calcsize(FILE_HEADER_FMT)
+BLOCK_HEADER_SIZE = struct.calcsize(BLOCK_HEADER_FMT)
+
+SEG_MAGIC = b'SMSG'
+# SegmentManifest: magic, version, segments, segment_size, first, current,
+# current_len, preamble_len, _pad, then len[MAX_SEGMENTS]
+SEG_HEADER_FMT = '<4sHHIIIIII'
+SEG_HEADER_SIZE = struct.calcsize(SEG_HEADER_FMT)
+MAX_SEGMENTS = 64
+PREAMBLE_OVERFLOW = 0xFFFFFFFF   # header didn't fit PREAMBLE_MAX; never replayed
+
+try:
+    import lz4.block as _lz4
+except ImportError:
+    _lz4 = None
+
+
+def lz4_block_decompress(src, raw_len):
+    """Decode one LZ4 block (lz4 doc/lz4_Block_format.md) to raw_len bytes."""
+    if _lz4 is not None:
+        return _lz4.decompress(src, uncompressed_size=raw_len)
+    out = bytearray()
+    i, n = 0, len(src)
+    while i < n:
+        token = src[i]
+        i += 1
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                b = src[i]
+                i += 1
+                lit += b
+                if b != 255:
+                    break
+        out += src[i:i + lit]
+        i += lit
+        if i >= n:
+            break  # last sequence is literals only
+        off = src[i] | (src[i + 1] << 8)
+        i += 2
+        mlen = token & 15
+        if mlen == 15:
+            while True:
+                b = src[i]
+                i += 1
+                mlen += b
+                if b != 255:
+                    break
+        mlen += 4
+        if off == 0 or off > len(out):
+            raise ValueError(f'bad match offset {off} at output {len(out)}')
+        start = len(out) - off
+        if mlen <= off:
+            out += out[start:start + mlen]
+        else:
+            for k in range(mlen):  # overlapping copy
+                out.append(out[start + k])
+    if len(out) != raw_len:
+        raise ValueError(f'block decoded to {len(out)} bytes, header says {raw_len}')
+    return bytes(out)
+
+
+def read_header(f):
+    """Read and check the FileHeader. Returns (version, block_max)."""
+    data = f.read(FILE_HEADER_SIZE)
+    if len(data) < FILE_HEADER_SIZE:
+        raise ValueError('too short for an SMLZ header')
+    magic, version, block_max = struct.unpack(FILE_HEADER_FMT, data)
+    if magic != MAGIC:
+        raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+    return version, block_max
+
+
+def iter_blocks(f, stats=None):
+    """Yield the decompressed bytes of each block of an open .lz file."""
+    read_header(f)
+    while True:
+        hdr = f.read(BLOCK_HEADER_SIZE)
+        if len(hdr) < BLOCK_HEADER_SIZE:
+            return
+        raw_len, stored = struct.unpack(BLOCK_HEADER_FMT, hdr)
+        size = stored & ~STORED_RAW
+        payload = f.read(size)
+        if len(payload) < size:
+            return  # truncated tail
+        data = payload if stored & STORED_RAW else lz4_block_decompress(payload, raw_len)
+        if stats is not None:
+            stats['blocks'] = stats.get('blocks', 0) + 1
+            stats['raw'] = stats.get('raw', 0) + raw_len
+            stats['stored'] = stats.get('stored', 0) + BLOCK_HEADER_SIZE + size
+            stats['uncompressed_blocks'] = stats.get('uncompressed_blocks', 0) + bool(stored & STORED_RAW)
+        yield data
+
+
+def read_manifest(path):
+    """Parse a <file>.seg manifest. Returns a dict, or raises ValueError."""
+    with open(path, 'rb') as f:
+        data = f.read(SEG_HEADER_SIZE + 4 * MAX_SEGMENTS)
+    if len(data) < SEG_HEADER_SIZE + 4 * MAX_SEGMENTS:
+        raise ValueError(f'{path}: too short for a segment manifest')
+    (magic, version, segments, segment_size, first, current, current_len,
+     preamble_len, _) = struct.unpack_from(SEG_HEADER_FMT, data)
+    if magic != SEG_MAGIC:
+        raise ValueError(f'{path}: bad magic {magic!r}, expected {SEG_MAGIC!r}')
+    return {
+        'version': version, 'segments': segments, 'segment_size': segment_size,
+        'first': first, 'current': current, 'current_len': current_len,
+        'preamble_len': preamble_len,
+        'len': list(struct.unpack_from(f'<{MAX_SEGMENTS}I', data, SEG_HEADER_SIZE)),
+    }
+
+
+def _decode(data, stats=None):
+    """Chunks of one file's (or segment's) bytes, decompressed if SMLZ."""
+    if data[:4] != MAGIC:
+        yield data
+        return
+    yield from iter_blocks(io.BytesIO(data), stats)
+
+
+def iter_segments(path, stats=None):
+    """Yield the joined contents of a segmented log, oldest live segment
+    first. `path` is the .seg manifest. Segments after the first drop their
+    replayed preamble, so the result reads like one file. A log whose
+    header overflowed the preamble buffer only has it in segment 0, so once
+    that has been overwritten the rest can't be decoded and this raises."""
+    m = read_manifest(path)
+    base = path[:-len('.seg')]
+    n = m['segments']
+    preamble = m['preamble_len']
+    if preamble == PREAMBLE_OVERFLOW:
+        if m['first'] > 0:
+            raise ValueError(f'{path}: header overflowed PREAMBLE_MAX and segment 0 '
+                             f'is gone (first live segment {m["first"]})')
+        preamble = 0
+    for seg in range(m['first'], m['current'] + 1):
+        slot = seg % n
+        length = m['current_len'] if seg == m['current'] else m['len'][slot]
+        try:
+            with open(f'{base}.{slot}', 'rb') as f:
+                data = f.read(length)
+        except FileNotFoundError:
+            continue
+        skip = preamble if seg != m['first'] else 0
+        for chunk in _decode(data, stats):
+            if skip:
+                cut = min(skip, len(chunk))
+                chunk, skip = chunk[cut:], skip - cut
+            if chunk:
+                yield chunk
+
+
+def _chunks(path, stats=None):
+    if path.endswith('.seg'):
+        return iter_segments(path, stats)
+    with open(path, 'rb') as f:
+        return _decode(f.read(), stats)
+
+
+def read_bytes(path):
+    """Whole decompressed contents of a .lz file, a .seg manifest's
+    segments, or a plain file as-is."""
+    return b''.join(_chunks(path))
+
+
+class _BlockReader(io.RawIOBase):
+    """Read-only stream over decompressed chunks."""
+
+    def __init__(self, f, chunks):
+        self._f = f
+        self._blocks = chunks
+        self._buf = b''
+
+    def readable(self):
+        return True
+
+    def readinto(self, b):
+        while not self._buf:
+            try:
+                self._buf = next(self._blocks)
+            except StopIteration:
+                return 0
+        n = min(len(b), len(self._buf))
+        b[:n] = self._buf[:n]
+        self._buf = self._buf[n:]
+        return n
+
+    def close(self):
+        if self._f is not None:
+            self._f.close()
+        super().close()
+
+
+def open_log(path, mode='r', encoding='utf-8'):
+    """Open a Logger file transparently: `path` may name the plain file or
+    the .lz one, segmented or not. Whichever exists is the current one (the
+    Logger deletes the other forms at init); .lz and segments win ties."""
+    if path.endswith('.seg'):
+        path = path[:-4]
+    lz_path = path if path.endswith('.lz') else path + '.lz'
+    plain = path[:-3] if path.endswith('.lz') else path
+    candidates = (lz_path + '.seg', lz_path, plain + '.seg', plain)
+    target = next((p for p in candidates if os.path.exists(p)), plain)
+    if target.endswith('.seg'):
+        raw = io.BufferedReader(_BlockReader(None, iter_segments(target)))
+        return raw if 'b' in mode else io.TextIOWrapper(raw, encoding=encoding, newline='')
+    f = open(target, 'rb')
+    if f.read(4) == MAGIC:
+        f.seek(0)
+        raw = io.BufferedReader(_BlockReader(f, iter_blocks(f)))
+    else:
+        f.seek(0)
+        raw = f
+    return raw if 'b' in mode else io.TextIOWrapper(raw, encoding=encoding, newline='')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decompress a Logger .lz file')
+    parser.add_argument('path', help='<name>.lz file, or a <file>.seg manifest with --join')
+    parser.add_argument('-o', '--output', help='write here instead of stdout')
+    parser.add_argument('--stats', action='store_true', help='print the compression ratio only')
+    parser.add_argument('--join', action='store_true',
+                        help='path is a .seg manifest: join its live segments in order')
+    args = parser.parse_args()
+
+    path = args.path
+    if args.join and not path.endswith('.seg'):
+        path += '.seg'
+    stats = {}
+    chunks = _chunks(path, stats)
+    if args.stats:
+        for _ in chunks:
+            pass
+        headers = FILE_HEADER_SIZE if not path.endswith('.seg') else 0
+        raw, stored = stats.get('raw', 0), stats.get('stored', 0) + headers
+        print(f"{args.path}: {stats.get('blocks', 0)} blocks "
+              f"({stats.get('uncompressed_blocks', 0)} stored raw), {raw} -> {stored} bytes, "
+              f"ratio {raw / stored if stored else 0:.2f}")
+        return 0
+    out = open(args.output, 'wb') if args.output else sys.stdout.buffer
+    try:
+        for data in chunks:
+            out.write(data)
+    finally:
+        if args.output:
+            out.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -16,8 +16,9 @@ SD = os.environ.get('RYUJINX_SD_PATH', '')
 def load_fields(path=None):
     if path is None:
         path = os.path.join(SD, 'smm2-hooks', 'fields.csv')
+    from logz import open_log
     rows = []
-    with open(path, 'r', errors='replace') as f:
+    with open_log(path) as f:
         reader = csv.DictReader(f)
         for row in reader:
             try:
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""Decode the per-hook overhead profile perf.bin.
+
+The file is self-describing: a PerfHeader, the probe name table, then one
+sample every PERF_INTERVAL frames holding per-probe (calls, ticks) deltas.
+Ticks are time spent inside the hook outside orig(), in cntvct_el0 units
+(tick_hz from the header). See include/smm2/perf.h for the layout.
+
+Usage:
+    python3 perf_bin.py perf.bin              # per-probe summary over the whole file
+    python3 perf_bin.py perf.bin --csv        # one row per sample × probe
+    python3 perf_bin.py perf.bin --last 10    # summary of the last 10 samples only
+
+As a module:
+    from perf_bin import PerfFile
+    pf = PerfFile('perf.bin')
+    for s in pf:
+        s['frame'], s['frames'], s['probes']['status_update']  # (calls, ticks)
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b'SMPF'
+HEADER_FMT = '<4sHHII'       # PerfHeader, 16 bytes
+PROBE_FMT = '<24s24s'        # PerfProbeDesc, 48 bytes
+SAMPLE_HDR_FMT = '<II'       # PerfSampleHeader, 8 bytes
+COUNTER_FMT = '<IIQ'         # PerfCounterSample, 16 bytes
+
+FRAME_BUDGET_US = 1e6 / 60
+
+
+class PerfFile:
+    """Iterate samples of a perf.bin file."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        self._parse_header()
+
+    def _parse_header(self):
+        d = self.data
+        if len(d) < struct.calcsize(HEADER_FMT):
+            raise ValueError('file too short for PerfHeader')
+        magic, self.version, count, self.tick_hz, self.sample_size = \
+            struct.unpack_from(HEADER_FMT, d, 0)
+        if magic != MAGIC:
+            raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+
+        off = struct.calcsize(HEADER_FMT)
+        self.probes = []
+        for _ in range(count):
+            name, plugin = struct.unpack_from(PROBE_FMT, d, off)
+            self.probes.append((name.rstrip(b'\0').decode(), plugin.rstrip(b'\0').decode()))
+            off += struct.calcsize(PROBE_FMT)
+        self.header_size = off
+
+        expected = struct.calcsize(SAMPLE_HDR_FMT) + count * struct.calcsize(COUNTER_FMT)
+        if self.sample_size != expected:
+            raise ValueError(f'sample_size {self.sample_size} != expected {expected}')
+
+    def ticks_to_us(self, ticks):
+        return ticks * 1e6 / self.tick_hz if self.tick_hz else 0.0
+
+    def __len__(self):
+        return (len(self.data) - self.header_size) // self.sample_size
+
+    def __iter__(self):
+        end = len(self.data) - self.sample_size
+        off = self.header_size
+        while off <= end:
+            frame, frames = struct.unpack_from(SAMPLE_HDR_FMT, self.data, off)
+            probes = {}
+            coff = off + struct.calcsize(SAMPLE_HDR_FMT)
+            for name, _ in self.probes:
+                calls, _, ticks = struct.unpack_from(COUNTER_FMT, self.data, coff)
+                probes[name] = (calls, ticks)
+                coff += struct.calcsize(COUNTER_FMT)
+            yield {'frame': frame, 'frames': frames, 'probes': probes}
+            off += self.sample_size
+
+
+def write_csv(pf, out):
+    out.write('frame,frames,probe,plugin,calls,ticks,us\n')
+    plugins = dict(pf.probes)
+    for s in pf:
+        for name, (calls, ticks) in s['probes'].items():
+            out.write(f"{s['frame']},{s['frames']},{name},{plugins[name]},{calls},{ticks},"
+                      f"{pf.ticks_to_us(ticks):.1f}\n")
+
+
+def summary(pf, last=None):
+    samples = list(pf)
+    if last:
+        samples = samples[-last:]
+    frames = sum(s['frames'] for s in samples)
+    print(f'perf.bin v{pf.version}: {len(samples)} samples, {frames} frames, '
+          f'{pf.tick_hz} Hz ticks')
+    if frames == 0:
+        return
+
+    rows = []
+    for name, plugin in pf.probes:
+        calls = sum(s['probes'][name][0] for s in samples)
+        ticks = sum(s['probes'][name][1] for s in samples)
+        rows.append((name, plugin, calls, pf.ticks_to_us(ticks)))
+
+    seconds = frames / 60
+    print(f"  {'probe':24s} {'plugin':18s} {'calls/s':>10s} {'us/call':>9s} "
+          f"{'us/frame':>9s} {'budget':>7s}")
+    for name, plugin, calls, us in sorted(rows, key=lambda r: -r[3]):
+        per_call = us / calls if calls else 0.0
+        per_frame = us / frames
+        print(f'  {name:24s} {plugin:18s} {calls / seconds:10.1f} {per_call:9.2f} '
+              f'{per_frame:9.2f} {100 * per_frame / FRAME_BUDGET_US:6.2f}%')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode per-hook overhead profile perf.bin')
+    parser.add_argument('path', help='perf.bin file')
+    parser.add_argument('--csv', action='store_true', help='dump every sample as CSV')
+    parser.add_argument('--last', type=int, help='only summarize the last N samples')
+    args = parser.parse_args()
+
+    pf = PerfFile(args.path)
+    if args.csv:
+        write_csv(pf, sys.stdout)
+    else:
+        summary(pf, args.last)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -14,9 +14,11 @@ import struct, time, sys, os, argparse
 from pathlib import Path
 from dotenv import load_dotenv
 
+import input_cmd
+
 load_dotenv(Path(__file__).parent.parent / '.env')
 SD = os.environ.get('RYUJINX_SD_PATH', '')
-INPUT = os.path.join(SD, 'smm2-hooks', 'input.bin')
+INPUT = os.path.join(SD, 'smm2-hooks', 'input_cmd.bin')
 STATUS = os.path.join(SD, 'smm2-hooks', 'status.bin')
 
 # Button constants
@@ -29,8 +31,7 @@ B     = 0x02
 MINUS = 0x800
 
 def write_input(buttons=0, lx=0, ly=0):
-    with open(INPUT, 'wb') as f:
-        f.write(struct.pack('<Qii', buttons, lx, ly))
+    input_cmd.send(INPUT, buttons, lx, ly)
 
 def read_status():
     with open(STATUS, 'rb') as f:
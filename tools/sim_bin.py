@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+"""Decode sim_trace's columnar sim.bin.
+
+The file is a SimHeader and column table, then independent chunks of up
+to chunk_frames frames. Each column in a chunk is a run of zigzag varints,
+one per frame, holding the delta of the raw 32-bit value from the previous
+frame (starting from 0 at each chunk). See include/smm2/sim_trace.h.
+
+Usage:
+    python3 sim_bin.py sim.bin              # CSV to stdout
+    python3 sim_bin.py sim.bin -o sim.csv
+    python3 sim_bin.py sim.bin --summary
+
+As a module:
+    from sim_bin import SimFile
+    for row in SimFile('sim.bin'):
+        row['frame'], row['cur_state'], row['vel_x']
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b'SMSM'
+CHUNK_MAGIC = b'SMCK'
+HEADER_FMT = '<4sHHII'           # SimHeader, 16 bytes
+COLUMN_FMT = '<15sB'             # SimColumnDesc, 16 bytes
+CHUNK_FMT = '<4sIII'             # SimChunkHeader, 16 bytes
+
+# ColumnType → struct code used to reinterpret the 32-bit pattern
+TYPE_CODES = {1: 'I', 2: 'i', 3: 'f'}
+
+
+def read_varint(data, off):
+    v = shift = 0
+    while True:
+        b = data[off]
+        off += 1
+        v |= (b & 0x7F) << shift
+        if b < 0x80:
+            return v, off
+        shift += 7
+
+
+class SimFile:
+    """Iterate per-frame rows of a sim.bin file."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        self._parse_header()
+
+    def _parse_header(self):
+        d = self.data
+        if len(d) < struct.calcsize(HEADER_FMT):
+            raise ValueError('file too short for SimHeader')
+        magic, self.version, column_count, self.chunk_frames, _ = struct.unpack_from(HEADER_FMT, d, 0)
+        if magic != MAGIC:
+            raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+
+        off = struct.calcsize(HEADER_FMT)
+        self.columns = []
+        for _ in range(column_count):
+            name, ctype = struct.unpack_from(COLUMN_FMT, d, off)
+            self.columns.append((name.rstrip(b'\0').decode(), TYPE_CODES[ctype]))
+            off += struct.calcsize(COLUMN_FMT)
+        self.data_offset = off
+
+    def column_names(self):
+        return [name for name, _ in self.columns]
+
+    def chunks(self):
+        """Yield (frame_count, {column: [values]}) per complete chunk."""
+        d = self.data
+        hdr_size = struct.calcsize(CHUNK_FMT)
+        off = self.data_offset
+        while off + hdr_size <= len(d):
+            magic, count, payload, _ = struct.unpack_from(CHUNK_FMT, d, off)
+            if magic != CHUNK_MAGIC:
+                raise ValueError(f'bad chunk magic {magic!r} at {off:#x}')
+            pos = off + hdr_size
+            end = pos + payload
+            if end > len(d):
+                return  # partial chunk at the tail (writer still running)
+            cols = {}
+            for name, code in self.columns:
+                prev = 0
+                raw = []
+                for _ in range(count):
+                    zz, pos = read_varint(d, pos)
+                    prev = (prev + ((zz >> 1) ^ -(zz & 1))) & 0xFFFFFFFF
+                    raw.append(prev)
+                packed = struct.pack(f'<{count}I', *raw)
+                cols[name] = list(struct.unpack(f'<{count}{code}', packed))
+            if pos != end:
+                raise ValueError(f'chunk at {off:#x}: decoded {pos - off - hdr_size} of {payload} bytes')
+            yield count, cols
+            off = end
+
+    def __iter__(self):
+        names = self.column_names()
+        for count, cols in self.chunks():
+            for i in range(count):
+                yield {n: cols[n][i] for n in names}
+
+
+def fmt_value(v):
+    return f'{v:.4f}' if isinstance(v, float) else str(v)
+
+
+def write_csv(sim, out):
+    names = sim.column_names()
+    out.write(','.join(names) + '\n')
+    for row in sim:
+        out.write(','.join(fmt_value(row[n]) for n in names) + '\n')
+
+
+def summary(sim):
+    chunks = frames = 0
+    first = last = None
+    for count, cols in sim.chunks():
+        chunks += 1
+        frames += count
+        if first is None:
+            first = cols['frame'][0]
+        last = cols['frame'][-1]
+    payload = len(sim.data) - sim.data_offset
+    print(f'sim.bin v{sim.version}: {frames} frames in {chunks} chunks, '
+          f'{len(sim.columns)} columns, {payload} B payload')
+    if frames:
+        raw = frames * len(sim.columns) * 4
+        print(f'  frames {first}..{last}, {payload / frames:.1f} B/frame '
+              f'({raw / max(payload, 1):.1f}x vs raw)')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode sim_trace sim.bin')
+    parser.add_argument('path', help='sim.bin file')
+    parser.add_argument('-o', '--output', help='CSV output path (default: stdout)')
+    parser.add_argument('--summary', action='store_true', help='print frame count and compression ratio')
+    args = parser.parse_args()
+
+    sim = SimFile(args.path)
+    if args.summary:
+        summary(sim)
+        return 0
+    if args.output:
+        with open(args.output, 'w') as f:
+            write_csv(sim, f)
+    else:
+        write_csv(sim, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
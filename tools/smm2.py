@@ -10,6 +10,11 @@ Usage:
     g.walk_to(200)   # walk right/left until x ≈ 200
     g.recover()      # from any state → play mode
     g.fresh()        # kill, boot, navigate to play
+
+Parallel instances (instance.cfg, include/smm2/paths.h):
+    Game('eden', instance='i2')          # or SMM2_INSTANCE=i2
+    instances(sd)                         # → ['i0', 'i1', ...] with a status.bin
+    release_instance(sd, 'i2')            # free an id=auto slot before relaunch
 """
 
 import struct
@@ -18,9 +23,15 @@ import time
 import subprocess
 from pathlib import Path
 
+from input_cmd import InputQueue
+from lockstep import Lockstep
+
 # Max age in seconds before status.bin is considered stale
 STATUS_MAX_AGE = 5.0
 
+# paths.cpp: id=auto claims ROOT/<id>/instance.lock
+INSTANCE_LOCK = 'instance.lock'
+
 # Button constants (nn::hid::NpadFullKeyState)
 BTN = {
     'A': 0x01, 'B': 0x02, 'X': 0x04, 'Y': 0x08,
@@ -61,10 +72,119 @@ DEATH_STATES = {9, 10, 113, 114}
 GOAL_STATES = {122, 124}
 
 
+# status.bin layout — must match include/smm2/status.h
+STATUS_BLOCK_SIZE = 0xC8
+RING_MAGIC = b'SMSR'
+RING_HEADER_OFFSET = 0xC8
+RING_HEADER_SIZE = 32
+SLOT_BLOCK_OFFSET = 8
+EVENT_SLOTS = 64
+EVENT_FMT = '<IIB3xii'                  # events::Event, 20 bytes
+
+# events::Kind, in order
+EVENT_KINDS = ['phase', 'scene', 'load_begin', 'load_end',
+               'spawn', 'despawn', 'goal', 'death']
+
+
+def _parse_ring_header(d):
+    """Parse StatusRingHeader. Returns None for a legacy single-block file."""
+    if len(d) < RING_HEADER_OFFSET + RING_HEADER_SIZE:
+        return None
+    if d[RING_HEADER_OFFSET:RING_HEADER_OFFSET + 4] != RING_MAGIC:
+        return None
+    seq, write_index, version, slot_count, slot_size, block_size, slots_offset, \
+        event_index, events_offset = struct.unpack_from('<IIHHHHIII', d, RING_HEADER_OFFSET + 4)
+    if len(d) < slots_offset + slot_count * slot_size:
+        return None
+    if version < 2:
+        event_index = events_offset = 0  # no event ring before v2
+    return {
+        'seq': seq, 'write_index': write_index, 'version': version,
+        'slot_count': slot_count, 'slot_size': slot_size,
+        'block_size': block_size, 'slots_offset': slots_offset,
+        'event_index': event_index, 'events_offset': events_offset,
+    }
+
+
+def _parse_block(d, base=0):
+    """Parse one StatusBlock starting at base."""
+    d = d[base:base + STATUS_BLOCK_SIZE]
+    return {
+        'frame':       struct.unpack_from('<I', d, 0x00)[0],
+        'game_phase':  struct.unpack_from('<I', d, 0x04)[0],
+        'state':       struct.unpack_from('<I', d, 0x08)[0],
+        'powerup':     struct.unpack_from('<I', d, 0x0C)[0],
+        'x':           struct.unpack_from('<f', d, 0x10)[0],
+        'y':           struct.unpack_from('<f', d, 0x14)[0],
+        'vx':          struct.unpack_from('<f', d, 0x18)[0],
+        'vy':          struct.unpack_from('<f', d, 0x1C)[0],
+        'state_frames': struct.unpack_from('<I', d, 0x20)[0],
+        'in_water':    d[0x24],
+        'is_dead':     d[0x25],
+        'is_goal':     d[0x26],
+        'has_player':  d[0x27],
+        'facing':      struct.unpack_from('<f', d, 0x28)[0],
+        'gravity':     struct.unpack_from('<f', d, 0x2C)[0],
+        'buffered':    struct.unpack_from('<I', d, 0x30)[0],
+        'polls':       struct.unpack_from('<I', d, 0x34)[0],
+        'real_phase':  struct.unpack_from('<i', d, 0x38)[0],
+        'theme':       d[0x3C],
+        'style':       struct.unpack_from('<I', d, 0x40)[0],
+        'scene_mode':  struct.unpack_from('<I', d, 0x44)[0],
+        'is_playing':  struct.unpack_from('<I', d, 0x48)[0],
+        'near_objects': struct.unpack_from('<H', d, 0x64)[0] if len(d) >= 0x68 else 0,
+        'player_cell': d[0x66] if len(d) >= 0x68 else 0,
+        'scene_change_count': struct.unpack_from('<I', d, 0x8C)[0] if len(d) >= 0x90 else 0,
+        # Collision data (from decomp discovery)
+        'collision_index': struct.unpack_from('<i', d, 0x90)[0] if len(d) >= 0xA0 else -1,
+        'collision_normal': d[0x94] if len(d) >= 0xA0 else 0,
+        'collision_slope': struct.unpack_from('<i', d, 0x98)[0] if len(d) >= 0xA0 else 0,
+        'input_cmd_seq': struct.unpack_from('<I', d, 0x9C)[0] if len(d) >= 0xA0 else 0,
+        'input_cmd_frame': struct.unpack_from('<I', d, 0xC0)[0] if len(d) >= 0xC8 else 0,
+        'log_dropped': struct.unpack_from('<I', d, 0xC4)[0] if len(d) >= 0xC8 else 0,
+        # Frame timing (frame::FrameTiming), microseconds
+        **_parse_timing(d),
+    }
+
+
+TIMING_FIELDS = ('interval_us', 'orig_us', 'callback_us', 'peak_interval_us',
+                 'over_1_frame', 'over_2_frames', 'last_hitch_frame')
+
+
+def _parse_timing(d):
+    if len(d) < 0xC0:
+        return {name: 0 for name in TIMING_FIELDS}
+    return dict(zip(TIMING_FIELDS, struct.unpack_from('<7I', d, 0xA0)))
+
+
+def instance_dir(sd, instance=None):
+    """Channel directory of an instance, sd itself without one."""
+    return os.path.join(sd, instance) if instance else sd
+
+
+def instances(sd):
+    """IDs of the instance directories under sd that hold a status.bin."""
+    try:
+        names = sorted(os.listdir(sd))
+    except FileNotFoundError:
+        return []
+    return [n for n in names if os.path.isfile(os.path.join(sd, n, 'status.bin'))]
+
+
+def release_instance(sd, instance):
+    """Drop an id=auto claim so the next boot can take the slot. Only do
+    this once that instance's emulator has exited."""
+    try:
+        os.remove(os.path.join(sd, instance, INSTANCE_LOCK))
+        return True
+    except FileNotFoundError:
+        return False
+
+
 class Game:
     """High-level SMM2 game controller."""
 
-    def __init__(self, emu='eden'):
+    def __init__(self, emu='eden', instance=None):
         self.emu = emu
         # Load .env
         env_path = Path(__file__).parent.parent / '.env'
@@ -83,8 +203,14 @@ class Game:
         if not self.sd:
             raise ValueError(f"SD path not configured for {emu}. Set {'EDEN' if emu == 'eden' else 'RYUJINX'}_SD_PATH in .env")
 
+        self.root = self.sd
+        self.instance = instance or os.environ.get('SMM2_INSTANCE') or None
+        self.sd = instance_dir(self.root, self.instance)
+
         self.status_path = os.path.join(self.sd, 'status.bin')
-        self.input_path = os.path.join(self.sd, 'input.bin')
+        self.input_path = os.path.join(self.sd, 'input_cmd.bin')
+        self.input = InputQueue(self.input_path, self.status_path)
+        self.stepper = Lockstep(self.sd)
 
     # ── Process Detection ───────────────────────────────────
 
@@ -135,35 +261,111 @@ class Game:
         if len(d) < 100:
             return None
 
-        return {
-            'frame':       struct.unpack_from('<I', d, 0x00)[0],
-            'game_phase':  struct.unpack_from('<I', d, 0x04)[0],
-            'state':       struct.unpack_from('<I', d, 0x08)[0],
-            'powerup':     struct.unpack_from('<I', d, 0x0C)[0],
-            'x':           struct.unpack_from('<f', d, 0x10)[0],
-            'y':           struct.unpack_from('<f', d, 0x14)[0],
-            'vx':          struct.unpack_from('<f', d, 0x18)[0],
-            'vy':          struct.unpack_from('<f', d, 0x1C)[0],
-            'state_frames': struct.unpack_from('<I', d, 0x20)[0],
-            'in_water':    d[0x24],
-            'is_dead':     d[0x25],
-            'is_goal':     d[0x26],
-            'has_player':  d[0x27],
-            'facing':      struct.unpack_from('<f', d, 0x28)[0],
-            'gravity':     struct.unpack_from('<f', d, 0x2C)[0],
-            'buffered':    struct.unpack_from('<I', d, 0x30)[0],
-            'polls':       struct.unpack_from('<I', d, 0x34)[0],
-            'real_phase':  struct.unpack_from('<i', d, 0x38)[0],
-            'theme':       d[0x3C],
-            'style':       struct.unpack_from('<I', d, 0x40)[0],
-            'scene_mode':  struct.unpack_from('<I', d, 0x44)[0],
-            'is_playing':  struct.unpack_from('<I', d, 0x48)[0],
-            'scene_change_count': struct.unpack_from('<I', d, 0x8C)[0] if len(d) >= 0x90 else 0,
-            # Collision data (from decomp discovery)
-            'collision_index': struct.unpack_from('<i', d, 0x90)[0] if len(d) >= 0xA0 else -1,
-            'collision_normal': d[0x94] if len(d) >= 0xA0 else 0,
-            'collision_slope': struct.unpack_from('<i', d, 0x98)[0] if len(d) >= 0xA0 else 0,
-        }
+        return _parse_block(d)
+
+    def frames(self, since=None, retries=3):
+        """Read every StatusBlock published since a previous call.
+
+        status.bin carries a seqlock ring of the last RING_SLOTS blocks after
+        the latest block. Pass the returned index back in as `since` to get
+        exactly the frames that happened in between — no drops, no torn reads.
+
+        Returns (blocks, next_index). blocks is oldest-first. If more than
+        RING_SLOTS frames passed since `since`, the oldest ones are gone and
+        the list starts at the oldest slot still in the ring.
+        """
+        for _ in range(retries):
+            try:
+                with open(self.status_path, 'rb') as f:
+                    d = f.read()
+                    f.seek(RING_HEADER_OFFSET)
+                    hdr2 = f.read(RING_HEADER_SIZE)
+            except (FileNotFoundError, PermissionError):
+                time.sleep(0.005)
+                continue
+            ring = _parse_ring_header(d)
+            if ring is None:
+                return [], since or 0
+            if ring['seq'] & 1:
+                continue  # writer mid-update
+            widx = ring['write_index']
+            start = widx - ring['slot_count'] if since is None else since
+            start = max(start, widx - ring['slot_count'], 0)
+            blocks = []
+            for idx in range(start, widx):
+                off = ring['slots_offset'] + (idx % ring['slot_count']) * ring['slot_size']
+                if struct.unpack_from('<I', d, off)[0] != idx:
+                    break  # slot overwritten during read — retry
+                blocks.append(_parse_block(d, off + SLOT_BLOCK_OFFSET))
+            else:
+                seq2 = struct.unpack_from('<I', hdr2, 4)[0] if len(hdr2) >= 8 else -1
+                if seq2 == ring['seq']:
+                    return blocks, widx
+        return [], since or 0
+
+    def events(self, since=None, retries=3):
+        """Read scene / phase / player events published since a previous call.
+
+        Same seqlock protocol as frames(), over the event ring that follows
+        the status slots (see include/smm2/events.h). Each event is a dict
+        with index, frame, kind (an EVENT_KINDS name), from and to.
+
+        Returns (events, next_index). With since=None only next_index is
+        meaningful — pass it back to wait for events from now on.
+        """
+        for _ in range(retries):
+            try:
+                with open(self.status_path, 'rb') as f:
+                    d = f.read()
+                    f.seek(RING_HEADER_OFFSET)
+                    hdr2 = f.read(RING_HEADER_SIZE)
+            except (FileNotFoundError, PermissionError):
+                time.sleep(0.005)
+                continue
+            ring = _parse_ring_header(d)
+            if ring is None or not ring['events_offset']:
+                return [], since or 0
+            if ring['seq'] & 1:
+                continue  # writer mid-update
+            eidx = ring['event_index']
+            start = eidx if since is None else max(since, eidx - EVENT_SLOTS, 0)
+            size = struct.calcsize(EVENT_FMT)
+            out = []
+            for idx in range(start, eidx):
+                off = ring['events_offset'] + (idx % EVENT_SLOTS) * size
+                if off + size > len(d):
+                    break
+                index, frame, kind, frm, to = struct.unpack_from(EVENT_FMT, d, off)
+                if index != idx:
+                    break  # slot overwritten during read — retry
+                out.append({'index': index, 'frame': frame,
+                            'kind': EVENT_KINDS[kind] if kind < len(EVENT_KINDS) else kind,
+                            'from': frm, 'to': to})
+            else:
+                seq2 = struct.unpack_from('<I', hdr2, 4)[0] if len(hdr2) >= 8 else -1
+                if seq2 == ring['seq']:
+                    return out, eidx
+        return [], since or 0
+
+    def wait_event(self, kinds, since=None, timeout=10, poll_interval=0.02):
+        """Wait for the next event whose kind is in `kinds` (name or list).
+
+        Returns (event, next_index), or (None, next_index) on timeout. Pass
+        `since` from a previous events() / wait_event() call so an event that
+        fired in between isn't missed.
+        """
+        if isinstance(kinds, str):
+            kinds = {kinds}
+        _, idx = self.events(since) if since is None else ([], since)
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            evs, nxt = self.events(idx)
+            for e in evs:
+                if e['kind'] in kinds:
+                    return e, e['index'] + 1
+            idx = nxt
+            time.sleep(poll_interval)
+        return None, idx
 
     def scene(self):
         """Current screen: 'editor', 'play', 'coursebot', 'title', 'loading', or 'unknown'."""
@@ -207,16 +409,9 @@ class Game:
 
     # ── Input ───────────────────────────────────────────────
 
-    def _write_input(self, buttons=0, lx=0, ly=0):
-        """Write raw input to input.bin. Retries on permission error (NTFS lock)."""
-        data = struct.pack('<Qii', buttons, lx, ly)
-        for attempt in range(5):
-            try:
-                with open(self.input_path, 'wb') as f:
-                    f.write(data)
-                return
-            except PermissionError:
-                time.sleep(0.01)  # 10ms retry
+    def _write_input(self, buttons=0, lx=0, ly=0, frame=None):
+        """Queue one input command (next poll, or at `frame`). Returns its seq."""
+        return self.input.push(buttons, lx, ly, frame)
 
     def _parse_buttons(self, buttons):
         """Parse button string or int to bitmask."""
@@ -232,12 +427,27 @@ class Game:
         return mask
 
     def press(self, buttons, ms=100):
-        """Press button(s) for duration then release. Accepts 'A', 'L+R', 0x4000, etc."""
+        """Press button(s) for duration then release. Accepts 'A', 'L+R', 0x4000, etc.
+
+        The press is guaranteed to reach at least one poll — the release is
+        only queued once the hook has applied it.
+        """
         mask = self._parse_buttons(buttons)
-        self._write_input(mask)
+        self.input.wait(self._write_input(mask))
         time.sleep(ms / 1000)
         self._write_input(0)
 
+    def press_frames(self, buttons, frames=1, lx=0, ly=0, wait=True):
+        """Hold button(s) for exactly `frames` input polls, then release."""
+        seq = self.input.press_frames(self._parse_buttons(buttons), frames, lx, ly)
+        if wait:
+            self.input.wait(seq, timeout=2.0 + frames / 30)
+        return seq
+
+    def queue_input(self, buttons, frame, lx=0, ly=0):
+        """Set input from `frame` (procFrame_ counter, StatusBlock.frame) onwards."""
+        return self._write_input(self._parse_buttons(buttons), lx, ly, frame)
+
     def hold(self, buttons, ms=1000):
         """Hold button(s) for duration then release."""
         self.press(buttons, ms)
@@ -252,6 +462,25 @@ class Game:
         """Release all inputs."""
         self._write_input(0)
 
+    # ── Lockstep ────────────────────────────────────────────
+
+    def lockstep(self, enable=True):
+        """Enter/leave lockstep frame advance. Returns the blocked frame (or None)."""
+        if enable:
+            return self.stepper.enable()
+        self.stepper.disable()
+        return None
+
+    def step(self, n=1, timeout=5.0):
+        """Release n frames in lockstep and return the last one's status.
+
+        Queue input first (press_frames(..., wait=False) / queue_input) —
+        commands are consumed as the released frames poll.
+        """
+        if self.stepper.step(n, timeout) is None:
+            return None
+        return self.status(allow_stale=True)
+
     # ── Movement ────────────────────────────────────────────
 
     def walk_to(self, target_x, timeout=10, use_analog=False):
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""Convert TAS scripts between CSV and the streamed tas.bin format.
+
+tas.bin is what the tas plugin reads: a TasHeader, then 16-byte
+TasKeyframe records sorted by frame. See include/smm2/tas.h. Recorded
+takes (tas.cfg record=1, rec_NNN.bin) use the same format, streamed
+(keyframes to end of file) and flagged exact.
+
+Usage:
+    python3 tas_bin.py tas.csv -o tas.bin       # CSV → binary
+    python3 tas_bin.py tas.bin                  # binary → CSV on stdout
+    python3 tas_bin.py --diff rec_000.bin rec_001.bin   # first frame they differ
+
+As a module:
+    from tas_bin import write_bin
+    write_bin('tas.bin', [(0, 0x4000, 0, 0), (100, 0x4001, 0, 0)])
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b'SMTS'
+VERSION = 1
+HEADER_FMT = '<4sHHII'     # TasHeader, 16 bytes
+KEYFRAME_FMT = '<IhhQ'     # TasKeyframe: frame, stick_lx, stick_ly, buttons
+COUNT_STREAMED = 0xFFFFFFFF
+FLAG_EXACT = 1
+
+
+def clamp_stick(v):
+    return max(-32768, min(32767, v))
+
+
+def read_csv(path):
+    """Parse frame,buttons,stick_lx,stick_ly rows (header line optional)."""
+    keyframes = []
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith('#') or line.startswith('frame'):
+                continue
+            parts = [p.strip() for p in line.split(',')]
+            frame = int(parts[0])
+            buttons = int(parts[1], 0) if len(parts) > 1 else 0
+            lx = int(parts[2]) if len(parts) > 2 else 0
+            ly = int(parts[3]) if len(parts) > 3 else 0
+            keyframes.append((frame, buttons, clamp_stick(lx), clamp_stick(ly)))
+    keyframes.sort(key=lambda kf: kf[0])
+    return keyframes
+
+
+def write_bin(path, keyframes, flags=0):
+    with open(path, 'wb') as f:
+        f.write(struct.pack(HEADER_FMT, MAGIC, VERSION, struct.calcsize(KEYFRAME_FMT),
+                            len(keyframes), flags))
+        for frame, buttons, lx, ly in keyframes:
+            f.write(struct.pack(KEYFRAME_FMT, frame, lx, ly, buttons))
+
+
+def read_header(path):
+    """(keyframe_count, flags) of a tas.bin."""
+    with open(path, 'rb') as f:
+        data = f.read(struct.calcsize(HEADER_FMT))
+    magic, _, _, count, flags = struct.unpack(HEADER_FMT, data)
+    if magic != MAGIC:
+        raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+    return count, flags
+
+
+def read_bin(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    magic, version, kf_size, count, _ = struct.unpack_from(HEADER_FMT, data, 0)
+    if magic != MAGIC:
+        raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+    if kf_size != struct.calcsize(KEYFRAME_FMT):
+        raise ValueError(f'keyframe_size {kf_size}, expected {struct.calcsize(KEYFRAME_FMT)}')
+    off = struct.calcsize(HEADER_FMT)
+    available = (len(data) - off) // kf_size   # a take still being written may end mid-record
+    count = available if count == COUNT_STREAMED else min(count, available)
+    keyframes = []
+    for _ in range(count):
+        frame, lx, ly, buttons = struct.unpack_from(KEYFRAME_FMT, data, off)
+        keyframes.append((frame, buttons, lx, ly))
+        off += kf_size
+    return keyframes
+
+
+def first_difference(a, b):
+    """(frame, state_a, state_b) at the first frame the two keyframe lists
+    hold different input, None if they never do."""
+    frames = sorted({kf[0] for kf in a} | {kf[0] for kf in b})
+    ia = ib = 0
+    sa = sb = (0, 0, 0)
+    for frame in frames:
+        while ia < len(a) and a[ia][0] <= frame:
+            sa = a[ia][1:]
+            ia += 1
+        while ib < len(b) and b[ib][0] <= frame:
+            sb = b[ib][1:]
+            ib += 1
+        if sa != sb:
+            return frame, sa, sb
+    return None
+
+
+def diff(path_a, path_b):
+    a, b = read_bin(path_a), read_bin(path_b)
+    # Compare over the common span: a take of the replay runs as long as its scene did
+    end = min(a[-1][0] if a else 0, b[-1][0] if b else 0)
+    d = first_difference([kf for kf in a if kf[0] <= end], [kf for kf in b if kf[0] <= end])
+    if d is None:
+        print(f'identical through frame {end} ({len(a)} / {len(b)} keyframes)')
+        return 0
+    frame, (ba, lxa, lya), (bb, lxb, lyb) = d
+    print(f'differ at frame {frame}: {path_a} {ba:#x},{lxa},{lya}  {path_b} {bb:#x},{lxb},{lyb}')
+    return 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert TAS scripts to/from tas.bin')
+    parser.add_argument('path', help='tas.csv or tas.bin')
+    parser.add_argument('other', nargs='?', help='second tas.bin for --diff')
+    parser.add_argument('-o', '--output', help='output path (default: stdout CSV for .bin input)')
+    parser.add_argument('--diff', action='store_true', help='compare two tas.bin / rec_NNN.bin files')
+    parser.add_argument('--exact', action='store_true', help='CSV → binary: replace input, don\'t OR it')
+    args = parser.parse_args()
+
+    if args.diff:
+        if not args.other:
+            parser.error('--diff needs two files')
+        return diff(args.path, args.other)
+
+    with open(args.path, 'rb') as f:
+        is_bin = f.read(4) == MAGIC
+
+    if is_bin:
+        keyframes = read_bin(args.path)
+        out = open(args.output, 'w') if args.output else sys.stdout
+        out.write('frame,buttons,stick_lx,stick_ly\n')
+        for frame, buttons, lx, ly in keyframes:
+            out.write(f'{frame},{buttons:#x},{lx},{ly}\n')
+        if args.output:
+            out.close()
+        return 0
+
+    if not args.output:
+        parser.error('-o is required when converting CSV to tas.bin')
+    keyframes = read_csv(args.path)
+    write_bin(args.output, keyframes, FLAG_EXACT if args.exact else 0)
+    print(f'{len(keyframes)} keyframes → {args.output}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+"""Decode func_trace's binary trace.bin.
+
+The file is self-describing: a TraceHeader, then the PlayerSnapshot field
+table and the func_id → delegate name table, then fixed-size records.
+See include/smm2/func_trace.h for the layout.
+
+Usage:
+    python3 trace_bin.py trace.bin              # CSV to stdout (same columns as trace.csv)
+    python3 trace_bin.py trace.bin -o trace.csv
+    python3 trace_bin.py trace.bin --func delegate_Walk --summary
+
+As a module:
+    from trace_bin import TraceFile
+    for rec in TraceFile('trace.bin'):
+        rec['func'], rec['ret'], rec['in']['pos_x'], rec['out']['vel_y']
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b'SMTR'
+HEADER_FMT = '<4sHHHHHHHHI'      # TraceHeader, 24 bytes
+FIELD_FMT = '<24sHBB'            # TraceFieldDesc, 28 bytes
+FUNC_FMT = '<H38s'               # TraceFuncDesc, 40 bytes
+RECORD_PREFIX_FMT = '<IHHiI'     # frame, func_id, _pad, ret, _pad2
+
+# FieldType → struct code
+TYPE_CODES = {0: 'B', 1: 'I', 2: 'i', 3: 'f', 4: 'Q'}
+
+# PlayerSnapshot v1 layout (name, offset, struct code) — for streams that
+# carry TraceRecords without the schema tables (e.g. flight_NNN.bin)
+DEFAULT_FIELDS = [
+    ('pos_x', 0x00, 'f'), ('pos_y', 0x04, 'f'), ('pos_z', 0x08, 'f'),
+    ('vel_x', 0x0C, 'f'), ('vel_y', 0x10, 'f'),
+    ('cur_state', 0x14, 'I'), ('state_frames', 0x18, 'I'), ('powerup_id', 0x1C, 'I'),
+    ('facing', 0x20, 'I'), ('target_speed', 0x24, 'f'), ('gravity', 0x28, 'f'),
+    ('friction', 0x2C, 'f'), ('accel', 0x30, 'f'),
+    ('in_water', 0x34, 'B'), ('style_features', 0x35, 'B'),
+    ('game_style_flags', 0x36, 'B'), ('field_490', 0x37, 'B'),
+    ('field_484', 0x38, 'I'), ('field_488', 0x3C, 'I'), ('buffered_action', 0x40, 'i'),
+    ('carried_object', 0x48, 'Q'), ('frame_counter', 0x50, 'I'),
+]
+
+# func_id (delegate slot) → name, mirrors FUNC_TRACE_DELEGATES in src/func_trace.cpp
+DEFAULT_FUNCS = {
+    1: 'delegate_Walk', 4: 'delegate_Landing', 5: 'delegate_Crouch', 6: 'delegate_CrouchEnd',
+    7: 'delegate_CrouchJump', 8: 'delegate_CrouchJumpEnd', 9: 'delegate_CrouchSwim',
+    10: 'delegate_CrouchSwimEnd', 12: 'delegate_CrouchSwimWalk', 13: 'delegate_Rolling',
+    15: 'delegate_BroadJumpLand', 16: 'delegate_StartFall', 17: 'delegate_WorldShortTurn',
+    18: 'delegate_Turn', 19: 'delegate_HipAttack', 20: 'delegate_HipAttackEnd',
+    21: 'delegate_Slip', 22: 'delegate_RollSlip', 23: 'delegate_WallSlide',
+    24: 'delegate_WallJump', 26: 'delegate_WallClimbSlide', 27: 'delegate_WallClimbFall',
+    28: 'delegate_WallClimbTopJump', 29: 'delegate_WallClimbTopCrouchJump',
+    30: 'delegate_ClimbAttack', 31: 'delegate_ClimbAttackSwim', 32: 'delegate_ClimbJumpAttack',
+    33: 'delegate_ClimbSlidingAttack', 35: 'delegate_ClimbBodyAttack',
+    36: 'delegate_ClimbBodyAttackLand', 37: 'delegate_WallHit', 39: 'delegate_Drag',
+    41: 'delegate_SideJumpDai', 42: 'delegate_PlayerJumpDai', 43: 'delegate_Swim',
+    44: 'delegate_CrouchSwimJump', 45: 'delegate_Fire', 46: 'delegate_FireSwim',
+    47: 'delegate_Throw', 48: 'delegate_FrogWalk', 49: 'delegate_FrogSwim',
+    51: 'delegate_Flying', 52: 'delegate_FlyingSlowFall', 53: 'delegate_FlyingWallStick',
+    54: 'delegate_LiftUp', 55: 'delegate_LiftUpSnowBall', 56: 'delegate_LiftUpCloud',
+    57: 'delegate_LiftUpBomb', 58: 'delegate_CarryPlayer',
+}
+
+SNAPSHOT_SIZE = 0x58
+RECORD_SIZE = 16 + 2 * SNAPSHOT_SIZE
+
+
+def decode_record(data, off, fields=DEFAULT_FIELDS, in_offset=16, out_offset=16 + SNAPSHOT_SIZE,
+                  funcs=None):
+    """Decode one TraceRecord at off."""
+    frame, func_id, _, ret, _ = struct.unpack_from(RECORD_PREFIX_FMT, data, off)
+
+    def snap(base):
+        return {name: struct.unpack_from('<' + code, data, base + foff)[0]
+                for name, foff, code in fields}
+
+    return {
+        'frame': frame,
+        'func_id': func_id,
+        'func': (funcs or DEFAULT_FUNCS).get(func_id, f'#{func_id}'),
+        'ret': ret,
+        'in': snap(off + in_offset),
+        'out': snap(off + out_offset),
+    }
+
+
+class TraceFile:
+    """Iterate records of a trace.bin file."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        self._parse_header()
+
+    def _parse_header(self):
+        d = self.data
+        if len(d) < struct.calcsize(HEADER_FMT):
+            raise ValueError('file too short for TraceHeader')
+        (magic, self.version, self.header_size, self.record_size,
+         self.snapshot_size, self.in_offset, self.out_offset,
+         field_count, func_count, _) = struct.unpack_from(HEADER_FMT, d, 0)
+        if magic != MAGIC:
+            raise ValueError(f'bad magic {magic!r}, expected {MAGIC!r}')
+
+        off = struct.calcsize(HEADER_FMT)
+        self.fields = []
+        for _ in range(field_count):
+            name, foff, ftype, fsize = struct.unpack_from(FIELD_FMT, d, off)
+            self.fields.append((name.rstrip(b'\0').decode(), foff, TYPE_CODES[ftype]))
+            off += struct.calcsize(FIELD_FMT)
+
+        self.funcs = {}
+        for _ in range(func_count):
+            fid, name = struct.unpack_from(FUNC_FMT, d, off)
+            self.funcs[fid] = name.rstrip(b'\0').decode()
+            off += struct.calcsize(FUNC_FMT)
+
+        if off != self.header_size:
+            raise ValueError(f'header_size {self.header_size} != parsed {off}')
+
+    def field_names(self):
+        return [name for name, _, _ in self.fields]
+
+    def __len__(self):
+        return (len(self.data) - self.header_size) // self.record_size
+
+    def __iter__(self):
+        end = len(self.data) - self.record_size
+        off = self.header_size
+        while off <= end:
+            yield decode_record(self.data, off, self.fields, self.in_offset,
+                                self.out_offset, self.funcs)
+            off += self.record_size
+
+
+def fmt_value(v):
+    return f'{v:.4f}' if isinstance(v, float) else str(v)
+
+
+def write_csv(trace, out, func=None):
+    names = trace.field_names()
+    cols = ['frame', 'func', 'return'] + [f'in_{n}' for n in names] + [f'out_{n}' for n in names]
+    out.write(','.join(cols) + '\n')
+    for rec in trace:
+        if func and rec['func'] != func:
+            continue
+        row = [str(rec['frame']), rec['func'], str(rec['ret'])]
+        row += [fmt_value(rec['in'][n]) for n in names]
+        row += [fmt_value(rec['out'][n]) for n in names]
+        out.write(','.join(row) + '\n')
+
+
+def summary(trace, func=None):
+    counts = {}
+    for rec in trace:
+        if func and rec['func'] != func:
+            continue
+        c = counts.setdefault(rec['func'], [0, 0])
+        c[0] += 1
+        c[1] += 1 if rec['ret'] else 0
+    print(f'trace.bin v{trace.version}: {len(trace)} records, {trace.record_size} B each')
+    for name, (n, taken) in sorted(counts.items(), key=lambda kv: -kv[1][0]):
+        print(f'  {name:36s} {n:8d} calls  {taken:8d} returned 1')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode func_trace trace.bin')
+    parser.add_argument('path', help='trace.bin file')
+    parser.add_argument('-o', '--output', help='CSV output path (default: stdout)')
+    parser.add_argument('--func', help='only records for this delegate name')
+    parser.add_argument('--summary', action='store_true', help='print per-delegate call counts')
+    args = parser.parse_args()
+
+    trace = TraceFile(args.path)
+    if args.summary:
+        summary(trace, args.func)
+        return 0
+    if args.output:
+        with open(args.output, 'w') as f:
+            write_csv(trace, f, args.func)
+    else:
+        write_csv(trace, sys.stdout, args.func)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())